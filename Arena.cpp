@@ -11,27 +11,64 @@
 #endif
 
 Arena arena_make() {
+	return arena_make(ARENA_DEFAULT_BUFFER_SIZE);
+}
+
+Arena arena_make(size_t size) {
 	Arena arena = {};
-	arena_init(&arena, ARENA_DEFAULT_BUFFER_SIZE);
+	arena_init(&arena, size);
 	return arena;
 }
 
-void arena_init(Arena* arena, size_t size) {
-	arena->buffer = (uint8_t*)malloc(size);
-	assert(arena->buffer != NULL);
+static void arena_push_block(Arena* arena, size_t size) {
+	ArenaBlock* block = (ArenaBlock*)malloc(sizeof(ArenaBlock) + size);
+	assert(block != NULL);
+	block->previous = arena->block;
+	block->length = size;
+
+	arena->block = block;
+	arena->buffer = (uint8_t*)(block + 1);
 	arena->length = size;
 	arena->prev_offset = 0;
 	arena->curr_offset = 0;
 }
 
+void arena_init(Arena* arena, size_t size) {
+	arena->block = NULL;
+	arena_push_block(arena, size);
+}
+
 void arena_free(Arena *arena) {
-	free(arena->buffer);
+	ArenaBlock* block = arena->block;
+	while (block != NULL) {
+		ArenaBlock* previous = block->previous;
+		free(block);
+		block = previous;
+	}
+	arena->block = NULL;
 	arena->buffer = NULL;
 	arena->length = 0;
 	arena->prev_offset = 0;
 	arena->curr_offset = 0;
 }
 
+ArenaMark arena_mark(const Arena* arena) {
+	return ArenaMark{ arena->block, arena->curr_offset };
+}
+
+void arena_reset(Arena* arena, ArenaMark mark) {
+	while (arena->block != mark.block) {
+		assert(arena->block != NULL && "The mark isn't from this arena.");
+		ArenaBlock* previous = arena->block->previous;
+		free(arena->block);
+		arena->block = previous;
+	}
+	arena->buffer = (uint8_t*)(arena->block + 1);
+	arena->length = arena->block->length;
+	arena->prev_offset = mark.curr_offset;
+	arena->curr_offset = mark.curr_offset;
+}
+
 static inline bool is_power_of_two(uintptr_t x) {
 	return (x & (x - 1)) == 0;
 }
@@ -51,18 +88,20 @@ static uintptr_t align_forward(uintptr_t ptr, size_t align) {
 }
 
 void* arena_alloc_align(Arena *arena, size_t size, size_t align) {
+	assert(arena->block != NULL);
+
 	uintptr_t curr_ptr = (uintptr_t)arena->buffer + (uintptr_t)arena->curr_offset;
 	uintptr_t offset = align_forward(curr_ptr, align);
 	offset -= (uintptr_t)arena->buffer;
 
 	if (offset + size > arena->length) {
-		do {
-			arena->length *= 2;
-		} while (offset + size > arena->length);
+		size_t length = arena->length * 2;
+		if (length > ARENA_MAX_BLOCK_SIZE) length = ARENA_MAX_BLOCK_SIZE;
+		if (length < size + align) length = size + align;
+		arena_push_block(arena, length);
 
-		uint8_t *new_buffer = (uint8_t*)realloc(arena->buffer, arena->length);
-		assert(new_buffer != NULL);
-		arena->buffer = new_buffer;
+		curr_ptr = (uintptr_t)arena->buffer;
+		offset = align_forward(curr_ptr, align) - curr_ptr;
 	}
 
 	void* ptr = &arena->buffer[offset];
@@ -77,4 +116,3 @@ void* arena_alloc_align(Arena *arena, size_t size, size_t align) {
 void* arena_alloc(Arena* arena, size_t size) {
 	return arena_alloc_align(arena, size, ARENA_DEFAULT_ALIGNMENT);
 }
-
@@ -2,26 +2,93 @@
 
 // Basic arena implementation. Heavily inspired by:
 // https://www.gingerbill.org/article/2019/02/08/memory-allocation-strategies-002/
+//
+// When the current block is full a new one is chained in front of it, instead of
+// growing the block in place, so pointers into the arena stay valid until it's freed.
 
 #include <memory.h>
 #include <stdint.h>
+#include <assert.h>
+#include <new>
+#include <utility>
+#include <vector>
+#include <type_traits>
 
 #define ARENA_DEFAULT_BUFFER_SIZE 1024
 #define ARENA_DEFAULT_ALIGNMENT (2 * sizeof(void*))
+#define ARENA_MAX_BLOCK_SIZE (16 * 1024 * 1024)
+
+struct ArenaBlock {
+	ArenaBlock *previous;
+	size_t length;
+	// The memory of the block comes right after this header.
+};
 
 struct Arena {
 	uint8_t *buffer;
 	size_t length;
 	size_t curr_offset;
 	size_t prev_offset;
+	ArenaBlock *block;
+};
+
+// Position in an arena, what's allocated after it can be freed without freeing the arena.
+struct ArenaMark {
+	ArenaBlock* block;
+	size_t curr_offset;
 };
 
 Arena arena_make();
+Arena arena_make(size_t size);
 void arena_init(Arena *arena, size_t size);
 void arena_free(Arena *arena);
 void* arena_alloc_align(Arena* arena, size_t size, size_t align);
 void* arena_alloc(Arena* arena, size_t size);
+ArenaMark arena_mark(const Arena* arena);
+void arena_reset(Arena* arena, ArenaMark mark);
 
 #define arena_push_type(arena, T) (T*)arena_alloc(arena, sizeof(T))
 #define arena_push_cstring(arena, len) (char*)arena_alloc(arena, len * sizeof(char))
 
+// Constructs a T in the arena. Its destructor never runs, the memory is released with the arena.
+template<typename T, typename... Args>
+T* arena_new(Arena* arena, Args&&... args) {
+	static_assert(std::is_trivially_destructible_v<T>, "Arena objects can't own memory outside of the arena.");
+	void* memory = arena_alloc_align(arena, sizeof(T), alignof(T));
+	return new (memory) T{ std::forward<Args>(args)... };
+}
+
+// Array that lives in an arena, it's a view and copying it doesn't copy the items.
+template<typename T>
+struct ArenaArray {
+	T* items = nullptr;
+	uint32_t count = 0;
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	T* begin() const { return items; }
+	T* end() const { return items + count; }
+	T& back() const { assert(count > 0); return items[count - 1]; }
+	T& at(size_t index) const { assert(index < count); return items[index]; }
+	T& operator[](size_t index) const { assert(index < count); return items[index]; }
+};
+
+template<typename T>
+ArenaArray<T> arena_push_array(Arena* arena, const T* items, size_t count) {
+	static_assert(std::is_trivially_destructible_v<T>, "Arena objects can't own memory outside of the arena.");
+	ArenaArray<T> result = {};
+	if (count == 0) return result;
+
+	assert(count <= UINT32_MAX);
+	result.items = (T*)arena_alloc_align(arena, count * sizeof(T), alignof(T));
+	for (size_t i = 0; i < count; i++) {
+		new (&result.items[i]) T(items[i]);
+	}
+	result.count = (uint32_t)count;
+	return result;
+}
+
+template<typename T>
+ArenaArray<T> arena_push_array(Arena* arena, const std::vector<T>& items) {
+	return arena_push_array(arena, items.data(), items.size());
+}
@@ -0,0 +1,69 @@
+#include "Ast.h"
+
+#if defined(_DEBUG) && (defined(_WIN32) || defined(_WIN64))
+	#include <stdlib.h>
+	#include <crtdbg.h>
+#endif
+
+Ast ast_make() {
+	Ast ast = {};
+	ast.arena = arena_make(AST_ARENA_BLOCK_SIZE);
+	return ast;
+}
+
+void ast_free(Ast* ast) {
+	arena_free(&ast->arena);
+	for (AstPool& pool : ast->exprs) pool = {};
+	for (AstPool& pool : ast->stmts) pool = {};
+	ast->spans = {};
+}
+
+size_t ast_node_count(const Ast* ast) {
+	size_t count = 0;
+	for (const AstPool& pool : ast->exprs) count += pool.count;
+	for (const AstPool& pool : ast->stmts) count += pool.count;
+	return count;
+}
+
+AstMark ast_mark(const Ast* ast) {
+	AstMark mark = {};
+	mark.arena = arena_mark(&ast->arena);
+	for (size_t i = 0; i < EXPR_TYPE_COUNT; i++) mark.exprs[i] = ast->exprs[i].count;
+	for (size_t i = 0; i < STMT_TYPE_COUNT; i++) mark.stmts[i] = ast->stmts[i].count;
+	mark.spans = ast->spans.count;
+	return mark;
+}
+
+bool ast_mark_equal(const AstMark& a, const AstMark& b) {
+	if (a.arena.block != b.arena.block || a.arena.curr_offset != b.arena.curr_offset) return false;
+	for (size_t i = 0; i < EXPR_TYPE_COUNT; i++) {
+		if (a.exprs[i] != b.exprs[i]) return false;
+	}
+	for (size_t i = 0; i < STMT_TYPE_COUNT; i++) {
+		if (a.stmts[i] != b.stmts[i]) return false;
+	}
+	return a.spans == b.spans;
+}
+
+// A chunk is allocated when the first node that goes in it is added, so the chunks needed by
+// the nodes before the mark were all allocated before it.
+static void ast_pool_reset(AstPool* pool, uint32_t count) {
+	assert(count <= pool->count);
+	pool->count = count;
+	pool->chunks.resize((count + AST_POOL_CHUNK_MASK) >> AST_POOL_CHUNK_SHIFT);
+}
+
+void ast_reset(Ast* ast, const AstMark& mark) {
+	for (size_t i = 0; i < EXPR_TYPE_COUNT; i++) ast_pool_reset(&ast->exprs[i], mark.exprs[i]);
+	for (size_t i = 0; i < STMT_TYPE_COUNT; i++) ast_pool_reset(&ast->stmts[i], mark.stmts[i]);
+	ast_pool_reset(&ast->spans, mark.spans);
+	arena_reset(&ast->arena, mark.arena);
+}
+
+size_t ast_memory_bytes(const Ast* ast) {
+	size_t bytes = 0;
+	for (ArenaBlock* block = ast->arena.block; block != NULL; block = block->previous) {
+		bytes += (block == ast->arena.block) ? ast->arena.curr_offset : block->length;
+	}
+	return bytes;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+// Flat storage of the syntax tree. Every kind of node has its own pool, and nodes point to
+// their children with the 32-bit ids described in Expr.h instead of pointers.
+//
+// A pool is a list of fixed size chunks allocated from the arena of the Ast. Chunks never move,
+// so a pointer to a node stays valid until the Ast is freed, and nodes of the same kind that were
+// parsed one after the other sit next to each other in memory.
+//
+// Source locations are kept aside in a pool of spans, nodes only store the id of theirs.
+
+#include <stdint.h>
+#include <assert.h>
+#include <new>
+#include <utility>
+#include <vector>
+#include <type_traits>
+
+#include "Arena.h"
+#include "Expr.h"
+#include "Stmt.h"
+
+#define AST_POOL_CHUNK_SHIFT 8
+#define AST_POOL_CHUNK_SIZE (1u << AST_POOL_CHUNK_SHIFT)
+#define AST_POOL_CHUNK_MASK (AST_POOL_CHUNK_SIZE - 1)
+
+// Size of the first block of the arena, where the chunks and the lists of the nodes go.
+#define AST_ARENA_BLOCK_SIZE (64 * 1024)
+
+struct AstPool {
+	std::vector<uint8_t*> chunks;
+	uint32_t count = 0;
+};
+
+struct Ast {
+	Arena arena = {};
+	AstPool exprs[EXPR_TYPE_COUNT];
+	AstPool stmts[STMT_TYPE_COUNT];
+	AstPool spans;
+};
+
+// Size of every pool and position in the arena at some point, see ast_reset.
+struct AstMark {
+	ArenaMark arena;
+	uint32_t exprs[EXPR_TYPE_COUNT];
+	uint32_t stmts[STMT_TYPE_COUNT];
+	uint32_t spans;
+};
+
+Ast ast_make();
+void ast_free(Ast* ast);
+size_t ast_node_count(const Ast* ast);
+// Bytes taken by the nodes, the lists they own and their spans.
+size_t ast_memory_bytes(const Ast* ast);
+AstMark ast_mark(const Ast* ast);
+bool ast_mark_equal(const AstMark& a, const AstMark& b);
+// Drops every node and list added after the mark. Nothing that's kept can refer to them,
+// their ids are given to the next nodes.
+void ast_reset(Ast* ast, const AstMark& mark);
+
+inline AstPool& ast_pool(Ast* ast, ExprType type) { return ast->exprs[(size_t)type]; }
+inline AstPool& ast_pool(Ast* ast, StmtType type) { return ast->stmts[(size_t)type]; }
+inline const AstPool& ast_pool(const Ast* ast, ExprType type) { return ast->exprs[(size_t)type]; }
+inline const AstPool& ast_pool(const Ast* ast, StmtType type) { return ast->stmts[(size_t)type]; }
+
+// Room for one more item of type T at the end of the pool.
+template<typename T>
+T* ast_pool_push(Ast* ast, AstPool& pool) {
+	uint32_t index = pool.count;
+	if ((index & AST_POOL_CHUNK_MASK) == 0) {
+		void* chunk = arena_alloc_align(&ast->arena, sizeof(T) * AST_POOL_CHUNK_SIZE, alignof(T));
+		pool.chunks.push_back((uint8_t*)chunk);
+	}
+	pool.count++;
+	return (T*)pool.chunks[index >> AST_POOL_CHUNK_SHIFT] + (index & AST_POOL_CHUNK_MASK);
+}
+
+// Constructs a node at the end of the pool of its kind and returns its id.
+template<typename T, typename... Args>
+uint32_t ast_new(Ast* ast, Args&&... args) {
+	static_assert(std::is_trivially_destructible_v<T>, "Nodes can't own memory outside of the Ast.");
+	AstPool& pool = ast_pool(ast, T::kind);
+	uint32_t index = pool.count;
+	assert(index <= AST_INDEX_MASK && "Too many nodes of the same kind.");
+
+	new (ast_pool_push<T>(ast, pool)) T{ std::forward<Args>(args)... };
+	return ((uint32_t)T::kind << AST_KIND_SHIFT) | index;
+}
+
+inline SpanId ast_new_span(Ast* ast, const Token& token) {
+	SpanId id = ast->spans.count;
+	*ast_pool_push<SourceSpan>(ast, ast->spans) = SourceSpan{ token.line, token.column };
+	return id;
+}
+
+inline const SourceSpan& ast_span(const Ast* ast, SpanId id) {
+	assert(id < ast->spans.count);
+	return ((const SourceSpan*)ast->spans.chunks[id >> AST_POOL_CHUNK_SHIFT])[id & AST_POOL_CHUNK_MASK];
+}
+
+// Looks up a node by id, the kind in the id must be the kind of T.
+template<typename T>
+T* ast_get(const Ast* ast, uint32_t id) {
+	assert((id >> AST_KIND_SHIFT) == (uint32_t)T::kind && "Node id of a different kind.");
+	const AstPool& pool = ast_pool(ast, T::kind);
+	uint32_t index = id & AST_INDEX_MASK;
+	assert(index < pool.count);
+	return (T*)pool.chunks[index >> AST_POOL_CHUNK_SHIFT] + (index & AST_POOL_CHUNK_MASK);
+}
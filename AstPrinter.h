@@ -1,114 +1,261 @@
 #pragma once
 
-#include "Expr.h"
+#include "Ast.h"
 #include <stdio.h>
 #include <stdarg.h>
+#include <string_view>
 
 struct AstPrinter {
 
-	static void parenthesize(const char *name, ...) {
+	// The list of expressions ends with EXPR_NONE.
+	static void parenthesize(const Ast* ast, std::string_view name, ...) {
 		va_list ap;
 		va_start(ap, name);
-		printf("(%s", name);
-		for (Expr* expr = va_arg(ap, Expr*); expr != NULL; expr = va_arg(ap, Expr*)) {
+		printf("(%.*s", (int)name.size(), name.data());
+		for (ExprId expr = va_arg(ap, ExprId); expr != EXPR_NONE; expr = va_arg(ap, ExprId)) {
 			printf(" ");
-			print(expr);
+			print(ast, expr);
 		}
 		printf(")");
 		va_end(ap);
 	}
 
-	static void println(const char *message, Expr *expr) {
+	static void println(const char *message, const Ast* ast, ExprId expr) {
 		printf(message);
-		print(expr);
+		print(ast, expr);
 		printf("\n");
 	}
 
-	static void print(Expr *_expr) {
-		if (_expr == nullptr) {
+	static void print(const Ast* ast, ExprId id) {
+		if (id == EXPR_NONE) {
 			printf("(invalid|empty)");
 			return;
 		}
-		switch (_expr->get_type()) {
+		switch (expr_type(id)) {
 			case ExprType::assign: {
-				Expr_Assign* expr = dynamic_cast<Expr_Assign*>(_expr);
+				Expr_Assign* expr = ast_get<Expr_Assign>(ast, id);
 				printf("(assign ");
-				print((Expr*)expr->lhs);
+				print(ast, expr->lhs);
 				printf(" = ");
-				print((Expr*)expr->rhs);
+				print(ast, expr->rhs);
 				printf(")");
 			} break;
 
 			case ExprType::binary: {
-				Expr_Binary* expr = dynamic_cast<Expr_Binary*>(_expr);
-				parenthesize(expr->_operator.lexeme, expr->left, expr->right, NULL);
+				Expr_Binary* expr = ast_get<Expr_Binary>(ast, id);
+				parenthesize(ast, get_token_type_lexeme(expr->_operator), expr->left, expr->right, EXPR_NONE);
 			} break;
 
 			case ExprType::call: {
-				Expr_Call* expr = dynamic_cast<Expr_Call*>(_expr);
+				Expr_Call* expr = ast_get<Expr_Call>(ast, id);
 				printf("(call ");
-				print((Expr*)expr->callee);
-				for (int i = 0; i < expr->arguments->size(); i++) {
+				print(ast, expr->callee);
+				for (int i = 0; i < expr->arguments.size(); i++) {
 					printf(" ");
-					print((Expr*)expr->arguments->at(i).expr);
-					if (i != expr->arguments->size() - 1) {
+					print(ast, expr->arguments.at(i).expr);
+					if (i != expr->arguments.size() - 1) {
 						printf(", ");
 					}
 				}
 				printf(")");
 			} break;
 
+			case ExprType::cast: {
+				Expr_Cast* expr = ast_get<Expr_Cast>(ast, id);
+				printf("(cast %s ", java_type_cstring(expr->type));
+				print(ast, expr->right);
+				printf(")");
+			} break;
+
 			case ExprType::get: {
-				Expr_Get* expr = dynamic_cast<Expr_Get*>(_expr);
+				Expr_Get* expr = ast_get<Expr_Get>(ast, id);
 				printf("(get ");
-				print((Expr*)expr->object);
-				printf(".%s)", expr->name.c_str());
+				print(ast, expr->object);
+				printf(".%s)", symbol_table.name(expr->name).c_str());
 			} break;
 
 			case ExprType::grouping: {
-				Expr_Grouping* expr = dynamic_cast<Expr_Grouping*>(_expr);
-				parenthesize("group", expr->expression, NULL);
+				Expr_Grouping* expr = ast_get<Expr_Grouping>(ast, id);
+				parenthesize(ast, "group", expr->expression, EXPR_NONE);
+			} break;
+
+			case ExprType::increment: {
+				Expr_Increment* expr = ast_get<Expr_Increment>(ast, id);
+				printf("(%s %s)", expr->is_positive ? "++" : "--", symbol_table.name(expr->name).c_str());
 			} break;
 
 			case ExprType::literal: {
-				Expr_Literal* expr = dynamic_cast<Expr_Literal*>(_expr);
+				Expr_Literal* expr = ast_get<Expr_Literal>(ast, id);
 				java_object_print(expr->literal);
 			} break;
 
 			case ExprType::logical: {
-				Expr_Logical* expr = dynamic_cast<Expr_Logical*>(_expr);
-				parenthesize(expr->_operator.lexeme, expr->left, expr->right, NULL);
+				Expr_Logical* expr = ast_get<Expr_Logical>(ast, id);
+				parenthesize(ast, get_token_type_lexeme(expr->_operator), expr->left, expr->right, EXPR_NONE);
 			} break;
 
 			case ExprType::set: {
-				Expr_Set* expr = dynamic_cast<Expr_Set*>(_expr);
+				Expr_Set* expr = ast_get<Expr_Set>(ast, id);
 				printf("(set ");
-				print((Expr*)expr->lhs);
+				print(ast, expr->lhs);
 				printf(" = ");
-				print((Expr*)expr->value);
+				print(ast, expr->value);
 				printf(")");
 			} break;
 
+			case ExprType::self: {
+				printf("(this)");
+			} break;
+
 			case ExprType::ternary: {
-				Expr_Ternary* expr = dynamic_cast<Expr_Ternary*>(_expr);
+				Expr_Ternary* expr = ast_get<Expr_Ternary>(ast, id);
 				printf("(ternary ");
-				print((Expr *)expr->condition);
+				print(ast, expr->condition);
 				printf(" ? ");
-				print((Expr *)expr->then);
+				print(ast, expr->then);
 				printf(" : ");
-				print((Expr *)expr->otherwise);
+				print(ast, expr->otherwise);
 				printf(")");
 			} break;
 
 			case ExprType::unary: {
-				Expr_Unary* expr = dynamic_cast<Expr_Unary*>(_expr);
-				parenthesize(expr->_operator.lexeme, expr->right, NULL);
+				Expr_Unary* expr = ast_get<Expr_Unary>(ast, id);
+				parenthesize(ast, get_token_type_lexeme(expr->_operator), expr->right, EXPR_NONE);
 			} break;
 
 			case ExprType::variable: {
-				Expr_Variable* expr = dynamic_cast<Expr_Variable*>(_expr);
+				Expr_Variable* expr = ast_get<Expr_Variable>(ast, id);
 				printf(expr->is_function ? "(fn " : "(var ");
-				printf("%s)", expr->name.c_str());
+				printf("%s)", symbol_table.name(expr->name).c_str());
+			} break;
+		}
+	}
+
+	// One statement per line, the ones nested in blocks, bodies and branches are indented under
+	// the statement that holds them.
+	static void print_statements(const Ast* ast, StmtList statements, int depth = 0) {
+		for (StmtId statement : statements) {
+			print_statement(ast, statement, depth);
+		}
+	}
+
+	static void print_indent(int depth) {
+		for (int i = 0; i < depth; i++) printf("  ");
+	}
+
+	static void print_statement(const Ast* ast, StmtId id, int depth) {
+		print_indent(depth);
+		switch (stmt_type(id)) {
+			case StmtType::Break: {
+				printf("(break)\n");
+			} break;
+
+			case StmtType::Continue: {
+				printf("(continue)\n");
+			} break;
+
+			case StmtType::Block: {
+				Stmt_Block* stmt = ast_get<Stmt_Block>(ast, id);
+				printf("(block\n");
+				print_statements(ast, stmt->statements, depth + 1);
+				print_indent(depth);
+				printf(")\n");
+			} break;
+
+			case StmtType::Class: {
+				Stmt_Class* stmt = ast_get<Stmt_Class>(ast, id);
+				printf("(%sclass %s\n", stmt->is_abstract ? "abstract " : "", symbol_table.name(stmt->name).c_str());
+				print_statements(ast, stmt->attributes, depth + 1);
+				print_statements(ast, stmt->methods, depth + 1);
+				print_indent(depth);
+				printf(")\n");
+			} break;
+
+			case StmtType::Expression: {
+				Stmt_Expression* stmt = ast_get<Stmt_Expression>(ast, id);
+				print(ast, stmt->expression);
+				printf("\n");
+			} break;
+
+			case StmtType::Function: {
+				Stmt_Function* stmt = ast_get<Stmt_Function>(ast, id);
+				printf("(%s%sfun %s %s(", stmt->is_inlinable ? "" : "@NoInline ", stmt->is_static ? "static " : "", java_type_cstring(stmt->return_type), symbol_table.name(stmt->name).c_str());
+				for (size_t i = 0; i < stmt->params.size(); i++) {
+					const Parameter& param = stmt->params.at(i);
+					printf("%s%.*s %s", i == 0 ? "" : ", ", (int)param.first.name.size(), param.first.name.data(), symbol_table.name(param.second).c_str());
+				}
+				if (!stmt->is_body_parsed) {
+					printf(") <body not parsed>)\n");
+					break;
+				}
+				printf(")\n");
+				print_statements(ast, stmt->body, depth + 1);
+				print_indent(depth);
+				printf(")\n");
+			} break;
+
+			case StmtType::If: {
+				Stmt_If* stmt = ast_get<Stmt_If>(ast, id);
+				printf("(if ");
+				print(ast, stmt->condition);
+				printf("\n");
+				print_statement(ast, stmt->then_branch, depth + 1);
+				for (const Else_If& else_if : stmt->else_ifs) {
+					print_indent(depth);
+					printf(" else if ");
+					print(ast, else_if.condition);
+					printf("\n");
+					print_statement(ast, else_if.then_branch, depth + 1);
+				}
+				if (stmt->else_branch != STMT_NONE) {
+					print_indent(depth);
+					printf(" else\n");
+					print_statement(ast, stmt->else_branch, depth + 1);
+				}
+				print_indent(depth);
+				printf(")\n");
+			} break;
+
+			case StmtType::Print: {
+				Stmt_Print* stmt = ast_get<Stmt_Print>(ast, id);
+				printf(stmt->has_newline ? "(println " : "(print ");
+				print(ast, stmt->expression);
+				printf(")\n");
+			} break;
+
+			case StmtType::Return: {
+				Stmt_Return* stmt = ast_get<Stmt_Return>(ast, id);
+				if (stmt->value == EXPR_NONE) {
+					printf("(return)\n");
+					break;
+				}
+				printf("(return ");
+				print(ast, stmt->value);
+				printf(")\n");
+			} break;
+
+			case StmtType::Var: {
+				Stmt_Var* stmt = ast_get<Stmt_Var>(ast, id);
+				std::string type_name = (stmt->type_name != SYMBOL_NONE) ? symbol_table.name(stmt->type_name) : get_token_type_lexeme(stmt->type);
+				printf("(%s%s%s", stmt->is_static ? "static " : "", stmt->is_final ? "final " : "", type_name.c_str());
+				for (size_t i = 0; i < stmt->names.size(); i++) {
+					printf("%s %s", i == 0 ? "" : ",", symbol_table.name(stmt->names.at(i).symbol).c_str());
+					if (stmt->initializers.at(i) != EXPR_NONE) {
+						printf(" = ");
+						print(ast, stmt->initializers.at(i));
+					}
+				}
+				printf(")\n");
+			} break;
+
+			case StmtType::While: {
+				Stmt_While* stmt = ast_get<Stmt_While>(ast, id);
+				printf("(while ");
+				print(ast, stmt->condition);
+				printf("\n");
+				print_statement(ast, stmt->body, depth + 1);
+				print_indent(depth);
+				printf(")\n");
 			} break;
 		}
 	}
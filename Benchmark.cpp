@@ -0,0 +1,327 @@
+#if defined(_WIN32) || defined(_WIN64)
+	#include <windows.h>
+	#include <psapi.h>
+	#ifdef _DEBUG
+		#include <stdlib.h>
+		#include <crtdbg.h>
+	#endif
+#else
+	#include <sys/resource.h>
+#endif
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "LexerSimd.h"
+
+#define BENCHMARK_DEFAULT_SIZE (4 * 1024 * 1024)
+#define BENCHMARK_DEFAULT_ITERATIONS 5
+#define BENCHMARK_DEFAULT_DEPTH 8
+#define BENCHMARK_DEFAULT_SEED 1
+
+struct BenchmarkOptions {
+	uint64_t size = BENCHMARK_DEFAULT_SIZE;
+	const char* shape = "all";
+	uint32_t iterations = BENCHMARK_DEFAULT_ITERATIONS;
+	uint32_t depth = BENCHMARK_DEFAULT_DEPTH;
+	uint32_t seed = BENCHMARK_DEFAULT_SEED;
+};
+
+struct BenchmarkPhase {
+	double seconds;
+	uint64_t peak_rss;
+};
+
+typedef void (*CorpusGenerator)(std::string& out, std::mt19937& rng, const BenchmarkOptions& options);
+
+static uint64_t peak_rss_bytes() {
+#if defined(_WIN32) || defined(_WIN64)
+	PROCESS_MEMORY_COUNTERS counters = {};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+	return (uint64_t)counters.PeakWorkingSetSize;
+#else
+	#if defined(__linux__)
+		// VmHWM is the peak that reset_peak_rss clears, ru_maxrss can't be reset.
+		FILE* status = fopen("/proc/self/status", "r");
+		if (status != NULL) {
+			char line[256];
+			unsigned long long kilobytes = 0;
+			bool found = false;
+			while (!found && fgets(line, sizeof(line), status) != NULL) {
+				found = sscanf(line, "VmHWM: %llu kB", &kilobytes) == 1;
+			}
+			fclose(status);
+			if (found) return (uint64_t)kilobytes * 1024;
+		}
+	#endif
+	struct rusage usage = {};
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+	#ifdef __APPLE__
+		return (uint64_t)usage.ru_maxrss;
+	#else
+		return (uint64_t)usage.ru_maxrss * 1024;
+	#endif
+#endif
+}
+
+// Only Linux can reset the peak, elsewhere every phase reports the peak of the process so far.
+static void reset_peak_rss() {
+#if defined(__linux__)
+	FILE* handle = fopen("/proc/self/clear_refs", "w");
+	if (handle == NULL) return;
+	fputs("5", handle);
+	fclose(handle);
+#endif
+}
+
+static const char* words[] = {
+	"alpha", "beta", "gamma", "delta", "value", "index", "count", "total", "result", "buffer",
+	"name", "table", "entry", "offset", "length", "width", "height", "color", "state", "token",
+};
+#define WORD_COUNT (sizeof(words) / sizeof(words[0]))
+
+static void append_format(std::string& out, const char* fmt, ...) {
+	char buffer[512];
+	va_list args;
+	va_start(args, fmt);
+	int len = vsnprintf(buffer, sizeof(buffer), fmt, args);
+	va_end(args);
+	assert(len >= 0 && len < (int)sizeof(buffer));
+	out.append(buffer, len);
+}
+
+static void append_expression(std::string& out, std::mt19937& rng, uint32_t depth, uint32_t variables) {
+	static const char* operators[] = { "+", "-", "*", "/", "%", "<<", ">>", "&", "|", "^" };
+
+	if (depth == 0) {
+		if (variables > 0 && rng() % 2 == 0) append_format(out, "e%u", rng() % variables);
+		else append_format(out, "%u", rng() % 1000 + 1);
+		return;
+	}
+	switch (rng() % 8) {
+		case 0: {
+			out.append("- "); // The space keeps two negations from being scanned as a decrement.
+			append_expression(out, rng, depth - 1, variables);
+		} break;
+		case 1: {
+			out.append("(");
+			append_expression(out, rng, depth - 1, variables);
+			out.append(" < ");
+			append_expression(out, rng, depth - 1, variables);
+			out.append(" ? ");
+			append_expression(out, rng, depth - 1, variables);
+			out.append(" : ");
+			append_expression(out, rng, depth - 1, variables);
+			out.append(")");
+		} break;
+		default: {
+			out.append("(");
+			append_expression(out, rng, depth - 1, variables);
+			append_format(out, " %s ", operators[rng() % (sizeof(operators) / sizeof(operators[0]))]);
+			append_expression(out, rng, depth - 1, variables);
+			out.append(")");
+		} break;
+	}
+}
+
+static void generate_expressions(std::string& out, std::mt19937& rng, const BenchmarkOptions& options) {
+	for (uint32_t i = 0; out.size() < options.size; i++) {
+		append_format(out, "int e%u = ", i);
+		append_expression(out, rng, options.depth, i);
+		out.append(";\n");
+	}
+}
+
+static void generate_classes(std::string& out, std::mt19937& rng, const BenchmarkOptions& options) {
+	for (uint32_t i = 0; out.size() < options.size; i++) {
+		append_format(out, "class Shape%u {\n", i);
+		append_format(out, "\tpublic int x, y;\n");
+		append_format(out, "\tprivate int %s_%u = %u;\n", words[rng() % WORD_COUNT], i, rng() % 100);
+		append_format(out, "\tstatic final double SCALE = %u.%u;\n", rng() % 10, rng() % 1000);
+		append_format(out, "\tpublic __init__(int x, int y) { this.x = x; this.y = y; }\n");
+		append_format(out, "\tpublic int area() { return this.x * this.y; }\n");
+		append_format(out, "\tpublic int %s(int k) { if (k > this.x) return k - this.y; return this.x + k; }\n", words[rng() % WORD_COUNT]);
+		append_format(out, "\tstatic int twice(int v) { return v * 2; }\n");
+		append_format(out, "}\n");
+		append_format(out, "Shape%u s%u = Shape%u(%u, %u);\n", i, i, i, rng() % 100, rng() % 100);
+		append_format(out, "soutln(s%u.area() + Shape%u.twice(%u));\n", i, i, rng() % 100);
+	}
+}
+
+static void generate_strings(std::string& out, std::mt19937& rng, const BenchmarkOptions& options) {
+	for (uint32_t i = 0; out.size() < options.size; i++) {
+		append_format(out, "String s%u = \"", i);
+		uint32_t count = rng() % 24 + 4;
+		for (uint32_t j = 0; j < count; j++) {
+			if (j > 0) out.append(" ");
+			if (rng() % 16 == 0) out.append("\\\"");
+			out.append(words[rng() % WORD_COUNT]);
+		}
+		out.append("\";\n");
+	}
+}
+
+static void generate_comments(std::string& out, std::mt19937& rng, const BenchmarkOptions& options) {
+	for (uint32_t i = 0; out.size() < options.size; i++) {
+		switch (rng() % 3) {
+			case 0: {
+				append_format(out, "// The %s of the %s is kept in c%u.\n", words[rng() % WORD_COUNT], words[rng() % WORD_COUNT], i);
+			} break;
+			case 1: {
+				append_format(out, "/*\n * Updates the %s of every %s.\n", words[rng() % WORD_COUNT], words[rng() % WORD_COUNT]);
+				append_format(out, " * /* The %s is reset first. */\n */\n", words[rng() % WORD_COUNT]);
+			} break;
+			default: {
+				append_format(out, "/* %s */ ", words[rng() % WORD_COUNT]);
+			} break;
+		}
+		append_format(out, "int c%u = %u;\n", i, rng() % 10000);
+	}
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool benchmark_lexer(const std::string& source, uint32_t iterations, uint64_t* tokens, BenchmarkPhase* phase) {
+	reset_peak_rss();
+	phase->seconds = 0;
+	for (uint32_t i = 0; i < iterations; i++) {
+		auto start = std::chrono::steady_clock::now();
+		Lexer lexer(source.data(), source.size());
+		*tokens = lexer.scan().size();
+		double seconds = seconds_since(start);
+		if (i == 0 || seconds < phase->seconds) phase->seconds = seconds;
+		if (JavaError::had_error) return false;
+	}
+	phase->peak_rss = peak_rss_bytes();
+	return true;
+}
+
+static bool benchmark_lex_parse(const std::string& source, uint32_t iterations, uint64_t* nodes, uint64_t* ast_bytes, BenchmarkPhase* phase) {
+	reset_peak_rss();
+	phase->seconds = 0;
+	for (uint32_t i = 0; i < iterations; i++) {
+		auto start = std::chrono::steady_clock::now();
+		Lexer lexer(source.data(), source.size());
+		Parser parser(lexer);
+		parser.parse_statements();
+		double seconds = seconds_since(start);
+		if (i == 0 || seconds < phase->seconds) phase->seconds = seconds;
+		if (JavaError::had_error) return false;
+
+		if (i + 1 == iterations) {
+			*nodes = ast_node_count(parser.ast);
+			*ast_bytes = ast_memory_bytes(parser.ast);
+			phase->peak_rss = peak_rss_bytes();
+		}
+	}
+	return true;
+}
+
+static bool parse_option(int argc, char** argv, int* i, uint64_t* value) {
+	if (*i + 1 >= argc) return false;
+	char* end = nullptr;
+	*value = strtoull(argv[*i + 1], &end, 10);
+	*i += 1;
+	return end != argv[*i] && *end == '\0';
+}
+
+int run_benchmark(int argc, char** argv) {
+	BenchmarkOptions options = {};
+	for (int i = 0; i < argc; i++) {
+		uint64_t value = 0;
+		bool ok = true;
+		if (strcmp(argv[i], "--size") == 0) {
+			ok = parse_option(argc, argv, &i, &value) && value > 0;
+			options.size = value;
+		}
+		else if (strcmp(argv[i], "--iterations") == 0) {
+			ok = parse_option(argc, argv, &i, &value) && value > 0;
+			options.iterations = (uint32_t)value;
+		}
+		else if (strcmp(argv[i], "--depth") == 0) {
+			ok = parse_option(argc, argv, &i, &value) && value > 0 && value <= 64;
+			options.depth = (uint32_t)value;
+		}
+		else if (strcmp(argv[i], "--seed") == 0) {
+			ok = parse_option(argc, argv, &i, &value);
+			options.seed = (uint32_t)value;
+		}
+		else if (strcmp(argv[i], "--shape") == 0 && i + 1 < argc) {
+			options.shape = argv[++i];
+		}
+		else {
+			ok = false;
+		}
+		if (!ok) {
+			fprintf(stderr, "Invalid benchmark option '%s'.\n", argv[i]);
+			return 1;
+		}
+	}
+
+	struct { const char* name; CorpusGenerator generate; } shapes[] = {
+		{ "expressions", generate_expressions },
+		{ "classes", generate_classes },
+		{ "strings", generate_strings },
+		{ "comments", generate_comments },
+	};
+	bool all = strcmp(options.shape, "all") == 0;
+	bool found = all;
+	for (const auto& shape : shapes) found |= strcmp(options.shape, shape.name) == 0;
+	if (!found) {
+		fprintf(stderr, "Unknown corpus shape '%s'.\n", options.shape);
+		return 1;
+	}
+
+	printf("{\n");
+	printf("\t\"simd_backend\": \"%s\",\n", simd_backend_name());
+	printf("\t\"iterations\": %u,\n", options.iterations);
+	printf("\t\"seed\": %u,\n", options.seed);
+	printf("\t\"corpora\": [");
+
+	bool first = true;
+	for (const auto& shape : shapes) {
+		if (!all && strcmp(options.shape, shape.name) != 0) continue;
+
+		std::mt19937 rng(options.seed);
+		std::string source;
+		source.reserve(options.size + 1024);
+		shape.generate(source, rng, options);
+
+		uint64_t tokens = 0, nodes = 0, ast_bytes = 0;
+		BenchmarkPhase lex = {}, lex_parse = {};
+		if (!benchmark_lexer(source, options.iterations, &tokens, &lex) ||
+			!benchmark_lex_parse(source, options.iterations, &nodes, &ast_bytes, &lex_parse))
+		{
+			fprintf(stderr, "The generated '%s' corpus has errors.\n", shape.name);
+			return 1;
+		}
+
+		double bytes = (double)source.size();
+		printf("%s\n\t\t{\n", first ? "" : ",");
+		printf("\t\t\t\"shape\": \"%s\",\n", shape.name);
+		printf("\t\t\t\"bytes\": %llu,\n", (unsigned long long)source.size());
+		printf("\t\t\t\"tokens\": %llu,\n", (unsigned long long)tokens);
+		printf("\t\t\t\"ast_nodes\": %llu,\n", (unsigned long long)nodes);
+		printf("\t\t\t\"ast_bytes\": %llu,\n", (unsigned long long)ast_bytes);
+		printf("\t\t\t\"lex\": { \"seconds\": %.6f, \"bytes_per_sec\": %.0f, \"tokens_per_sec\": %.0f, \"peak_rss_bytes\": %llu },\n",
+			lex.seconds, bytes / lex.seconds, tokens / lex.seconds, (unsigned long long)lex.peak_rss);
+		printf("\t\t\t\"lex_parse\": { \"seconds\": %.6f, \"bytes_per_sec\": %.0f, \"tokens_per_sec\": %.0f, \"ast_nodes_per_sec\": %.0f, \"peak_rss_bytes\": %llu }\n",
+			lex_parse.seconds, bytes / lex_parse.seconds, tokens / lex_parse.seconds, nodes / lex_parse.seconds, (unsigned long long)lex_parse.peak_rss);
+		printf("\t\t}");
+		first = false;
+	}
+	printf("\n\t]\n}\n");
+	return 0;
+}
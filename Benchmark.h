@@ -0,0 +1,20 @@
+#pragma once
+
+// Front-end benchmark, run with `javaclone --bench [options]`.
+// Generates synthetic sources of a given size and shape, then times Lexer::scan on its own and
+// Parser::parse_statements with the Lexer it pulls from, and prints the results as JSON.
+//
+// Options:
+//   --size <bytes>      Size of every generated corpus, 4 MiB by default.
+//   --shape <name>      expressions, classes, strings, comments or all (the default).
+//   --iterations <n>    Runs of each phase, the fastest one is reported. 5 by default.
+//   --depth <n>         Nesting depth of the generated expressions, 8 by default.
+//   --seed <n>          Seed of the generator, so corpora can be reproduced.
+//
+// The parser pulls its tokens from a Lexer as it goes, so the second phase is reported as
+// lex_parse and includes scanning. It can be faster than lex, which stores every token.
+// ast_bytes is the memory taken by the nodes of one parse of the corpus.
+// Peak RSS is the peak of the whole process when the phase finishes. Every corpus is
+// scanned before it's parsed, so the number reported for the lexer doesn't include the AST.
+
+int run_benchmark(int argc, char** argv);
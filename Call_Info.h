@@ -1,9 +1,10 @@
 #pragma once
 
 #include "JavaObject.h"
+#include "SourceSpan.h"
 
 struct ArgumentInfo {
 	JavaObject object;
-	uint32_t line, column;
+	SpanId span;
 };
 
@@ -12,6 +12,18 @@
 	#define DBG_new new
 #endif
 
+static void assign_variable(JavaVariable& variable, Symbol name, const SourceSpan& span, JavaObject value, bool force) {
+	if (variable.is_final && !force) {
+		const std::string& text = symbol_table.name(name);
+		throw JAVA_RUNTIME_ERROR_AT_VA(text, span, "Variable '%s' is final.", text.c_str());
+	}
+
+	auto casted = try_cast(symbol_table.name(name), span.line, span.column, variable.object.type, value);
+	variable.is_uninitialized = false;
+	variable.object = casted.first;
+	variable.object.is_null = casted.second;
+}
+
 Environment::Environment() {
 	values = JavaScope();
 }
@@ -20,40 +32,68 @@ Environment::Environment(Environment* p_enclosing): enclosing(p_enclosing) {
 	values = JavaScope();
 }
 
-void Environment::define(Stmt_Var* stmt, const Token& name, Expr* initializer, JavaType expected_type, JavaObject value) {
+Environment::Environment(Environment* p_enclosing, uint32_t slot_count): slots(slot_count), enclosing(p_enclosing) {
+	values = JavaScope();
+}
+
+void Environment::define(const Stmt_Var* stmt, const VarName& name, const SourceSpan& span, ExprId initializer, JavaType expected_type, JavaObject value) {
 	assert(stmt != nullptr);
-	JavaVariable variable = { value, stmt->visibility, stmt->is_static, stmt->is_final, initializer == nullptr };
-	define(name, expected_type, variable);
+	JavaVariable variable = { value, stmt->visibility, stmt->is_static, stmt->is_final, initializer == EXPR_NONE };
+	if (name.slot != LOCAL_SLOT_NONE) {
+		define_slot(name.slot, name.symbol, span, expected_type, variable);
+		return;
+	}
+	define(name.symbol, span, expected_type, variable);
 }
 
-void Environment::define(std::string name, uint32_t line, uint32_t column, JavaType expected_type, JavaVariable variable) {
+void Environment::define_slot(uint16_t slot, Symbol name, const SourceSpan& span, JavaType expected_type, JavaVariable variable) {
+	assert(slot < slots.size() && "The resolver gave the scope fewer slots than its locals.");
 	if (variable.object.type == JavaType::_void) {
-		throw JAVA_RUNTIME_ERR_VA(name, line, column, "Can't define '%s' as void.", name.c_str());
+		const std::string& text = symbol_table.name(name);
+		throw JAVA_RUNTIME_ERROR_AT_VA(text, span, "Can't define '%s' as void.", text.c_str());
 	}
-	if (values.contains(name)) {
-		throw JAVA_RUNTIME_ERR_VA(name, line, column, "Variable '%s' is already defined in this scope.", name.c_str());
+	if (slots[slot].object.type != JavaType::none) {
+		const std::string& text = symbol_table.name(name);
+		throw JAVA_RUNTIME_ERROR_AT_VA(text, span, "Variable '%s' is already defined in this scope.", text.c_str());
 	}
 	JavaVariable defaultvar = variable;
 	defaultvar.object.type = expected_type;
-	values[name] = defaultvar;
-	assign(name, line, column, variable.object, true);
+	slots[slot] = defaultvar;
+	assign_variable(slots[slot], name, span, variable.object, true);
 }
 
-void Environment::define(Token name, JavaType expected_type, JavaVariable variable) {
-	define(name.lexeme, name.line, name.column, expected_type, variable);
+void Environment::define(Symbol name, uint32_t line, uint32_t column, JavaType expected_type, JavaVariable variable) {
+	define(name, SourceSpan{ line, column }, expected_type, variable);
+}
+
+void Environment::define(Symbol name, const SourceSpan& span, JavaType expected_type, JavaVariable variable) {
+	if (variable.object.type == JavaType::_void) {
+		const std::string& text = symbol_table.name(name);
+		throw JAVA_RUNTIME_ERROR_AT_VA(text, span, "Can't define '%s' as void.", text.c_str());
+	}
+	if (values.contains(name)) {
+		const std::string& text = symbol_table.name(name);
+		throw JAVA_RUNTIME_ERROR_AT_VA(text, span, "Variable '%s' is already defined in this scope.", text.c_str());
+	}
+	JavaVariable defaultvar = variable;
+	defaultvar.object.type = expected_type;
+	values[name] = defaultvar;
+	assign(name, span, variable.object, true);
 }
 
 void Environment::define_native_function(
 		const std::string& name,
 		std::function<int()> arity_fn,
 		std::function<JavaObject(void*, uint32_t, uint32_t, std::vector<ArgumentInfo>)> call_fn,
-		std::function<std::string()> to_string_fn)
+		std::function<std::string()> to_string_fn,
+		bool is_pure,
+		JavaType result_type)
 {
-	values[name] = JavaVariable{
+	values[symbol_table.intern(name)] = JavaVariable{
 		JavaObject{
 			JavaType::Function,
 			JavaValue{
-				.function = DBG_new JavaNativeFunction { arity_fn, call_fn, to_string_fn }
+				.function = DBG_new JavaNativeFunction { arity_fn, call_fn, to_string_fn, is_pure, result_type }
 			},
 		},
 		Visibility::Public,
@@ -63,81 +103,90 @@ void Environment::define_native_function(
 	};
 }
 
-void Environment::assign(Token name, JavaObject value) {
-	assign(name.lexeme, name.line, name.column, value, false);
+void Environment::assign(Symbol name, const SourceSpan& span, JavaObject value) {
+	assign(name, span, value, false);
 }
 
-void Environment::assign(Token name, JavaObject value, bool force) {
-	assign(name.lexeme, name.line, name.column, value, force);
-}
-
-void Environment::assign(const std::string& name, uint32_t line, uint32_t column, JavaObject value) {
-	assign(name, line, column, value, false);
-}
-
-void Environment::assign(const std::string& name, uint32_t line, uint32_t column, JavaObject value, bool force) {
+void Environment::assign(Symbol name, const SourceSpan& span, JavaObject value, bool force) {
 	if (value.type == JavaType::_void) {
-		throw JAVA_RUNTIME_ERR_VA(name, line, column, "Can't assign void to '%s'.", name.c_str());
+		const std::string& text = symbol_table.name(name);
+		throw JAVA_RUNTIME_ERROR_AT_VA(text, span, "Can't assign void to '%s'.", text.c_str());
+	}
+	auto found = values.find(name);
+	if (found != values.end()) {
+		assign_variable(found->second, name, span, value, force);
+		return;
 	}
-	if (values.contains(name)) {
-		JavaVariable variable = values.at(name);
-		variable.is_uninitialized = false;
 
-		if (variable.is_final && !force) {
-			throw JAVA_RUNTIME_ERR_VA(name, line, column, "Variable '%s' is final.", name.c_str());
-		}
+	if (enclosing != nullptr) {
+		enclosing->assign(name, span, value);
+		return;
+	}
 
-		auto casted = try_cast(name, line, column, variable.object.type, value);
-		variable.object = casted.first;
-		variable.object.is_null = casted.second;
-		values[name] = variable;
+	const std::string& text = symbol_table.name(name);
+	throw JAVA_RUNTIME_ERROR_AT_VA(text, span, "Undefined variable '%s'.", text.c_str());
+}
+
+// A slot that wasn't defined yet behaves like a name missing from this scope.
+void Environment::assign(Symbol name, LocalRef local, const SourceSpan& span, JavaObject value) {
+	if (local.depth == LOCAL_DEPTH_NONE) {
+		assign(name, span, value);
 		return;
 	}
 
-	if (enclosing != nullptr) {
-		enclosing->assign(name, line, column, value);
+	Environment* environment = this;
+	for (uint16_t i = 0; i < local.depth; i++) environment = environment->enclosing;
+	JavaVariable& variable = environment->slots[local.slot];
+	if (variable.object.type == JavaType::none) {
+		assign(name, span, value);
 		return;
 	}
 
-	throw JAVA_RUNTIME_ERR_VA(name, line, column, "Undefined variable '%s'.", name.c_str());
+	if (value.type == JavaType::_void) {
+		const std::string& text = symbol_table.name(name);
+		throw JAVA_RUNTIME_ERROR_AT_VA(text, span, "Can't assign void to '%s'.", text.c_str());
+	}
+	assign_variable(variable, name, span, value, false);
 }
 
 bool Environment::scope_has(const Token &name) {
-	std::string copied(name.lexeme);
-	return values.contains(copied);
+	return values.contains(name.symbol);
 }
 
 JavaVariable Environment::scope_get(const Token &name) {
-	std::string copied(name.lexeme);
-	return values.at(copied);
+	return values.at(name.symbol);
 }
 
 void Environment::scope_set(const Token& name, JavaVariable variable) {
-	std::string copied(name.lexeme);
-	values[copied] = variable;
+	values[name.symbol] = variable;
 }
 
-void* Environment::get_function_ptr(const std::string& name) {
+void* Environment::get_function_ptr(Symbol name) {
 	JavaObject object = values.at(name).object;
 	assert(object.type == JavaType::Function);
 	return object.value.function;
 }
 
-JavaObject Environment::get(const Token &name) {
-	return get(name.lexeme, name.line, name.column);
+JavaObject Environment::get_slot_slow(Symbol name, LocalRef local, const SourceSpan& span) {
+	Environment* environment = this;
+	for (uint16_t i = 0; i < local.depth; i++) environment = environment->enclosing;
+	if (environment->slots[local.slot].object.type == JavaType::none) {
+		return get(name, span);
+	}
+	throw JAVA_RUNTIME_ERROR_AT(symbol_table.name(name), span, "Variable is uninitialized.");
 }
 
-JavaObject Environment::get(const std::string& name, uint32_t line, uint32_t column) {
-	if (values.contains(name)) {
-		JavaVariable var = values.at(name);
-		if (var.is_uninitialized) {
-			throw JAVA_RUNTIME_ERR(name, line, column, "Variable is uninitialized.");
+JavaObject Environment::get(Symbol name, const SourceSpan& span) {
+	for (Environment* environment = this; environment != nullptr; environment = environment->enclosing) {
+		auto found = environment->values.find(name);
+		if (found == environment->values.end()) continue;
+
+		if (found->second.is_uninitialized) {
+			throw JAVA_RUNTIME_ERROR_AT(symbol_table.name(name), span, "Variable is uninitialized.");
 		}
-		return var.object;
+		return found->second.object;
 	}
 
-	if (enclosing != nullptr) return enclosing->get(name, line, column);
-
-	throw JAVA_RUNTIME_ERR_VA(name, line, column, "Undefined variable %s.", name.c_str());
+	const std::string& text = symbol_table.name(name);
+	throw JAVA_RUNTIME_ERROR_AT_VA(text, span, "Undefined variable %s.", text.c_str());
 }
-
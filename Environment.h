@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <functional>
 #include <unordered_map>
 
@@ -18,31 +19,54 @@ struct JavaVariable {
 	bool is_uninitialized;
 };
 
-typedef std::unordered_map<std::string, JavaVariable> JavaScope;
+typedef std::unordered_map<Symbol, JavaVariable> JavaScope;
 
 struct Environment {
 	Environment();
 	Environment(Environment* p_enclosing);
+	Environment(Environment* p_enclosing, uint32_t slot_count);
 	bool scope_has(const Token &name);
 	JavaVariable scope_get(const Token &name);
 	void scope_set(const Token &name, JavaVariable value);
 
-	void define(std::string name, uint32_t line, uint32_t column, JavaType expected_type, JavaVariable variable);
-	void define(Stmt_Var* stmt, const Token& name, Expr* initializer, JavaType expected_type, JavaObject value);
-	void define(Token name, JavaType expected_type, JavaVariable variable);
-	void assign(Token name, JavaObject value);
-	void assign(Token name, JavaObject value, bool force);
-	void assign(const std::string &name, uint32_t line, uint32_t column, JavaObject value);
-	void assign(const std::string &name, uint32_t line, uint32_t column, JavaObject value, bool force);
-	JavaObject get(const std::string &name, uint32_t line, uint32_t column);
-	JavaObject get(const Token &name);
+	void define(Symbol name, uint32_t line, uint32_t column, JavaType expected_type, JavaVariable variable);
+	void define(Symbol name, const SourceSpan& span, JavaType expected_type, JavaVariable variable);
+	void define(const Stmt_Var* stmt, const VarName& name, const SourceSpan& span, ExprId initializer, JavaType expected_type, JavaObject value);
+	void assign(Symbol name, const SourceSpan& span, JavaObject value);
+	void assign(Symbol name, const SourceSpan& span, JavaObject value, bool force);
+	void assign(Symbol name, LocalRef local, const SourceSpan& span, JavaObject value);
+	JavaObject get(Symbol name, const SourceSpan& span);
+	inline JavaObject get(Symbol name, LocalRef local, const SourceSpan& span);
 	void define_native_function(
 		const std::string& name,
 		std::function<int()> arity_fn,
 		std::function<JavaObject(void*, uint32_t, uint32_t, std::vector<ArgumentInfo>)> call_fn,
-		std::function<std::string()> to_string_fn);
-	void* get_function_ptr(const std::string& name);
+		std::function<std::string()> to_string_fn,
+		bool is_pure = false,
+		JavaType result_type = JavaType::none);
+	void* get_function_ptr(Symbol name);
 
 	JavaScope values;
+	// Locals bound by the resolver, see Resolver.h. A slot whose type is none wasn't defined yet.
+	std::vector<JavaVariable> slots;
 	Environment* enclosing = nullptr;
+
+private:
+	void define_slot(uint16_t slot, Symbol name, const SourceSpan& span, JavaType expected_type, JavaVariable variable);
+	JavaObject get_slot_slow(Symbol name, LocalRef local, const SourceSpan& span);
 };
+
+// Reading a local takes `depth` hops up the enclosing environments and an index. Slots that
+// aren't defined yet, or hold an uninitialized variable, go through get_slot_slow.
+inline JavaObject Environment::get(Symbol name, LocalRef local, const SourceSpan& span) {
+	if (local.depth == LOCAL_DEPTH_NONE) return get(name, span);
+
+	Environment* environment = this;
+	for (uint16_t i = 0; i < local.depth; i++) environment = environment->enclosing;
+	const JavaVariable& variable = environment->slots[local.slot];
+
+	if (variable.object.type == JavaType::none || variable.is_uninitialized) {
+		return get_slot_slow(name, local, span);
+	}
+	return variable.object;
+}
@@ -13,6 +13,8 @@
 
 
 void JavaError::error(const std::string &name, uint32_t line, uint32_t column, const char* fmt, ...) {
+	had_error = true;
+	if (is_silenced) return;
 	printf(COLOR_CYN"Error at '%s' on [%u:%u]: ", name.c_str(), line, column);
 
 	va_list args;
@@ -21,10 +23,11 @@ void JavaError::error(const std::string &name, uint32_t line, uint32_t column, c
 	__crt_va_end(args);
 
 	printf(ERROR_MSG_END);
-	had_error = true;
 }
 
 void JavaError::error(uint32_t line, uint32_t column, const char* fmt, ...) {
+	had_error = true;
+	if (is_silenced) return;
 	printf(COLOR_CYN"Error at [%u:%u]: ", line, column);
 
 	va_list args;
@@ -33,12 +36,13 @@ void JavaError::error(uint32_t line, uint32_t column, const char* fmt, ...) {
 	__crt_va_end(args);
 
 	printf(ERROR_MSG_END);
-	had_error = true;
 }
 
 void JavaError::error(const Token &token, const char* fmt, ...) {
-	char* error_point = token.lexeme != NULL ? token.lexeme : (char*)get_token_type_name(token.type);
-	printf(COLOR_CYN"Error at '%s' on [%u:%u]: ", error_point, token.line, token.column);
+	had_error = true;
+	if (is_silenced) return;
+	std::string_view error_point = !token.lexeme.empty() ? token.lexeme : get_token_type_name(token.type);
+	printf(COLOR_CYN"Error at '%.*s' on [%u:%u]: ", (int)error_point.size(), error_point.data(), token.line, token.column);
 
 	va_list args;
 	__crt_va_start(args, fmt);
@@ -46,15 +50,15 @@ void JavaError::error(const Token &token, const char* fmt, ...) {
 	__crt_va_end(args);
 
 	printf(ERROR_MSG_END);
-	had_error = true;
 }
 
 void JavaError::error(const Token &token, const char* fmt, va_list args) {
-	char* error_point = token.lexeme != NULL ? token.lexeme : (char*)get_token_type_name(token.type);
-	printf(COLOR_CYN"Error at '%s' on [%u:%u]: ", error_point, token.line, token.column);
+	had_error = true;
+	if (is_silenced) return;
+	std::string_view error_point = !token.lexeme.empty() ? token.lexeme : get_token_type_name(token.type);
+	printf(COLOR_CYN"Error at '%.*s' on [%u:%u]: ", (int)error_point.size(), error_point.data(), token.line, token.column);
 	(void)_vfprintf_l(stdout, fmt, NULL, args);
 	printf(ERROR_MSG_END);
-	had_error = true;
 }
 
 void JavaError::runtime_error(const JavaRuntimeError &error) {
@@ -6,6 +6,7 @@
 #include <string>
 
 #include "Token.h"
+#include "SourceSpan.h"
 #include "Color.h"
 
 class JavaRuntimeError {
@@ -39,8 +40,24 @@ public:
 		va_end(args);
 	}
 
+	// The span is only looked up by the throw expression, so nodes don't pay for their location
+	// until an error is actually reported.
+	JavaRuntimeError(const std::string &_name, const SourceSpan &span, unsigned int _call_line, const char *_call_file, const char *_fmt, ...):
+		name(_name),
+		line(span.line),
+		column(span.column),
+		call_line(_call_line),
+		call_file(_call_file),
+		fmt(_fmt)
+	{
+		va_list args;
+		va_start(args, _fmt);
+        (void)_vsnprintf_l(message, sizeof(message), fmt, NULL, args);
+		va_end(args);
+	}
+
 	JavaRuntimeError(const Token &token, unsigned int _call_line, const char *_call_file, const char *_fmt, ...):
-		name(token.lexeme),
+		name(token.lexeme.empty() ? get_token_type_name(token.type) : token.lexeme),
 		line(token.line),
 		column(token.column),
 		call_line(_call_line),
@@ -57,12 +74,17 @@ public:
 #define JAVA_RUNTIME_ERROR(token, message) JavaRuntimeError(token, __LINE__, __FILE__, message)
 #define JAVA_RUNTIME_ERROR_VA(token, fmt, ...) JavaRuntimeError(token, __LINE__, __FILE__, fmt, __VA_ARGS__)
 
+#define JAVA_RUNTIME_ERROR_AT(name, span, message) JavaRuntimeError(name, span, __LINE__, __FILE__, message)
+#define JAVA_RUNTIME_ERROR_AT_VA(name, span, fmt, ...) JavaRuntimeError(name, span, __LINE__, __FILE__, fmt, __VA_ARGS__)
+
 #define JAVA_RUNTIME_ERR(name, line, column, message) JavaRuntimeError(name, line, column, __LINE__, __FILE__, message)
 #define JAVA_RUNTIME_ERR_VA(name, line, column, fmt, ...) JavaRuntimeError(name, line, column, __LINE__, __FILE__, fmt, __VA_ARGS__)
 
 namespace JavaError {
 	extern bool had_error;
 	extern bool had_runtime_error;
+	// Syntax errors are only recorded in had_error while it's set, see Optimizer::parse_body.
+	extern bool is_silenced;
 
 	void error(uint32_t line, uint32_t column, const char* fmt, ...);
 	void error(const std::string& name, uint32_t line, uint32_t column, const char* fmt, ...);
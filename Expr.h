@@ -1,11 +1,13 @@
 #pragma once
 
 #include "Token.h"
+#include "SourceSpan.h"
 #include "JavaObject.h"
+#include "Arena.h"
 #include <vector>
 #include <string>
 
-enum class ExprType {
+enum class ExprType : uint8_t {
 	assign,
 	binary,
 	call,
@@ -22,200 +24,257 @@ enum class ExprType {
 	variable,
 };
 
-struct Expr { virtual inline ExprType get_type() = 0; };
+#define EXPR_TYPE_COUNT ((size_t)ExprType::variable + 1)
 
-void expr_free(Expr *expr);
+// Nodes live in per-kind pools of an Ast (see Ast.h) and link to each other with 32-bit ids.
+// The top bits of an id are the kind of the node, and the rest its index in the pool of that
+// kind, so the kind is known without touching the node.
+typedef uint32_t ExprId;
 
-struct Expr_Assign : public Expr {
-	const Expr* lhs;
-	const std::string lhs_name;
-	const uint32_t line;
-	const uint32_t column;
-	const Expr* rhs;
+#define AST_KIND_SHIFT 27
+#define AST_INDEX_MASK ((1u << AST_KIND_SHIFT) - 1)
+#define EXPR_NONE UINT32_MAX
 
-	Expr_Assign(const Expr* _lhs, const std::string _lhs_name, const uint32_t _line, const uint32_t _column, const Expr* _rhs):
+inline ExprType expr_type(ExprId id) {
+	return (ExprType)(id >> AST_KIND_SHIFT);
+}
+
+// Where the resolver (see Resolver.h) found a local variable: `depth` scopes up from the one the
+// expression runs in, at index `slot` of that scope. Globals and anything it couldn't bind keep
+// LOCAL_DEPTH_NONE, and are looked up by name.
+#define LOCAL_DEPTH_NONE UINT16_MAX
+#define LOCAL_SLOT_NONE UINT16_MAX
+
+struct LocalRef {
+	uint16_t depth = LOCAL_DEPTH_NONE;
+	uint16_t slot = LOCAL_SLOT_NONE;
+};
+
+struct Expr_Assign {
+	static constexpr ExprType kind = ExprType::assign;
+
+	ExprId lhs;
+	const Symbol lhs_name;
+	const SpanId span;
+	LocalRef local = {};
+	ExprId rhs;
+
+	Expr_Assign(ExprId _lhs, const Symbol _lhs_name, const SpanId _span, ExprId _rhs):
 		lhs(_lhs),
 		lhs_name(_lhs_name),
-		line(_line),
-		column(_column),
+		span(_span),
 		rhs(_rhs)
 	{}
-
-	inline ExprType get_type() override { return ExprType::assign; }
 };
 
-struct Expr_Binary : public Expr {
-	const Expr* left;
-	const Token _operator;
-	const Expr* right;
+// Operators of Expr_Binary that have typed kernels.
+enum class BinaryOp : uint8_t {
+	add, subtract, multiply, divide, remainder,
+	left_shift, right_shift, bitwise_or, bitwise_xor, bitwise_and,
+	greater, less, greater_equal, less_equal, equal, not_equal,
+	count,
+};
 
-	Expr_Binary(const Expr* _left, const Token __operator, const Expr* _right) :
+// An operator applied to two operands promoted to the same number type, like int + int -> int.
+// The resolver picks one when it knows the types of both operands and the operation can't fail
+// on them, the interpreter then skips the promotion logic (see Interpreter::evaluate_binary).
+// Kernels are numbered densely so the switch over them is a jump table.
+typedef uint8_t BinaryKernel;
+
+#define BINARY_KERNEL_NONE 0
+
+constexpr BinaryKernel binary_kernel(BinaryOp op, JavaType type) {
+	return (BinaryKernel)(1 + (uint8_t)op * 6 + ((uint8_t)type - (uint8_t)JavaType::_byte));
+}
+
+// Type of the result of a kernel, the type of its operands or boolean for a comparison.
+constexpr JavaType binary_kernel_result(BinaryKernel kernel) {
+	uint8_t index = kernel - 1;
+	if ((BinaryOp)(index / 6) >= BinaryOp::greater) return JavaType::_boolean;
+	return (JavaType)((uint8_t)JavaType::_byte + index % 6);
+}
+
+struct Expr_Binary {
+	static constexpr ExprType kind = ExprType::binary;
+
+	ExprId left;
+	ExprId right;
+	const SpanId span;
+	const TokenType _operator;
+	// Types of the operands the kernel was picked for, checked before it runs.
+	JavaType left_type = JavaType::none;
+	JavaType right_type = JavaType::none;
+	BinaryKernel kernel = BINARY_KERNEL_NONE;
+
+	Expr_Binary(ExprId _left, const TokenType __operator, const SpanId _span, ExprId _right) :
 		left(_left),
-		_operator(__operator),
-		right(_right)
+		right(_right),
+		span(_span),
+		_operator(__operator)
 	{}
-
-	inline ExprType get_type() override { return ExprType::binary; }
 };
 
-struct Expr_Cast : public Expr {
-	const JavaType type;
-	const uint32_t line, column;
-	const Expr *right;
+struct Expr_Cast {
+	static constexpr ExprType kind = ExprType::cast;
 
-	Expr_Cast(const JavaType _type, const uint32_t _line, const uint32_t _column, const Expr* _right):
-		type(_type), line(_line), column(_column), right(_right) {}
+	const JavaType type;
+	const SpanId span;
+	ExprId right;
 
-	inline ExprType get_type() override { return ExprType::cast; }
+	Expr_Cast(const JavaType _type, const SpanId _span, ExprId _right):
+		type(_type), span(_span), right(_right) {}
 };
 
 struct ParseCallInfo {
-	Expr* expr;
-	uint32_t line, column;
+	ExprId expr;
+	SpanId span;
 };
 
-struct Expr_Call : public Expr {
-	const Expr* callee;
-	const Token paren;
-	const std::vector<ParseCallInfo> *arguments;
+struct Expr_Call {
+	static constexpr ExprType kind = ExprType::call;
+
+	ExprId callee;
+	const SpanId paren;
+	const ArenaArray<ParseCallInfo> arguments;
 
-	Expr_Call(const Expr* _callee, const Token _paren, const std::vector<ParseCallInfo> *_arguments) :
+	Expr_Call(ExprId _callee, const SpanId _paren, const ArenaArray<ParseCallInfo> _arguments) :
 		callee(_callee),
 		paren(_paren),
 		arguments(_arguments)
 	{}
-
-	inline ExprType get_type() override { return ExprType::call; }
 };
 
-struct Expr_Get : public Expr {
-	const Expr* object;
-	const std::string name;
-	const uint32_t line, column;
+struct Expr_Get {
+	static constexpr ExprType kind = ExprType::get;
+
+	ExprId object;
+	const Symbol name;
+	const SpanId span;
 
-	Expr_Get(const Expr* _object, const Token _name):
+	Expr_Get(ExprId _object, const Symbol _name, const SpanId _span):
 		object(_object),
-		name(_name.lexeme),
-		line(_name.line),
-		column(_name.column)
+		name(_name),
+		span(_span)
 	{}
-
-	inline ExprType get_type() override { return ExprType::get; }
 };
 
-struct Expr_Grouping : public Expr {
-	const Expr* expression;
+struct Expr_Grouping {
+	static constexpr ExprType kind = ExprType::grouping;
 
-	Expr_Grouping(const Expr* _expression):
+	ExprId expression;
+
+	Expr_Grouping(ExprId _expression):
 		expression(_expression)
 	{}
-
-	inline ExprType get_type() override { return ExprType::grouping; }
 };
 
-struct Expr_Increment : public Expr {
-	const Token name;
+struct Expr_Increment {
+	static constexpr ExprType kind = ExprType::increment;
+
+	const Symbol name;
+	const SpanId span;
+	LocalRef local = {};
 	const bool is_positive;
 
-	Expr_Increment(const Token p_name, const int8_t p_is_positive):
-		name(p_name), is_positive(p_is_positive)
+	Expr_Increment(const Symbol p_name, const SpanId p_span, const int8_t p_is_positive):
+		name(p_name), span(p_span), is_positive(p_is_positive)
 	{}
-
-	inline ExprType get_type() override { return ExprType::increment; }
 };
 
-struct Expr_Literal : public Expr{
+struct Expr_Literal {
+	static constexpr ExprType kind = ExprType::literal;
+
 	JavaObject literal;
 
 	Expr_Literal(JavaObject _literal):
 		literal(_literal)
 	{}
-
-	inline ExprType get_type() override { return ExprType::literal; }
 };
 
-struct Expr_Logical : public Expr {
-	const Expr* left;
-	const Token _operator;
-	const Expr* right;
+struct Expr_Logical {
+	static constexpr ExprType kind = ExprType::logical;
 
-	Expr_Logical(const Expr* _left, const Token __operator, const Expr* _right) :
+	ExprId left;
+	ExprId right;
+	const SpanId span;
+	const TokenType _operator;
+
+	Expr_Logical(ExprId _left, const TokenType __operator, const SpanId _span, ExprId _right) :
 		left(_left),
-		_operator(__operator),
-		right(_right)
+		right(_right),
+		span(_span),
+		_operator(__operator)
 	{}
-
-	inline ExprType get_type() override { return ExprType::logical; }
 };
 
-struct Expr_Set : public Expr {
-	const Expr_Get* lhs;
-	const std::string rhs_name;
-	const uint32_t line, column;
-	const Expr* value;
+struct Expr_Set {
+	static constexpr ExprType kind = ExprType::set;
 
-	Expr_Set(const Expr_Get* _lhs, const std::string _name, const uint32_t _line, const uint32_t _column, const Expr* _value) :
+	ExprId lhs;
+	const Symbol rhs_name;
+	const SpanId span;
+	ExprId value;
+
+	Expr_Set(ExprId _lhs, const Symbol _name, const SpanId _span, ExprId _value) :
 		lhs(_lhs),
 		rhs_name(_name),
-		line(_line),
-		column(_column),
+		span(_span),
 		value(_value)
 	{}
-
-	inline ExprType get_type() override { return ExprType::set; }
 };
 
-struct Expr_Ternary : public Expr {
-	const Expr *condition;
-	const Expr *then;
-	const Expr *otherwise;
-	const Token question_mark;
+struct Expr_Ternary {
+	static constexpr ExprType kind = ExprType::ternary;
 
-	Expr_Ternary(const Expr* _condition, const Expr* _then, const Expr* _otherwise, const Token _question_mark):
+	ExprId condition;
+	ExprId then;
+	ExprId otherwise;
+	const SpanId question_mark;
+
+	Expr_Ternary(ExprId _condition, ExprId _then, ExprId _otherwise, const SpanId _question_mark):
 		condition(_condition),
 		then(_then),
 		otherwise(_otherwise),
 		question_mark(_question_mark)
 	{}
-
-	inline ExprType get_type() override { return ExprType::ternary; }
 };
 
-struct Expr_This : public Expr {
-	std::string name;
-	uint32_t line, column;
+struct Expr_This {
+	static constexpr ExprType kind = ExprType::self;
 
-	Expr_This(std::string p_name, uint32_t p_line, uint32_t p_column):
-		name(p_name), line(p_line), column(p_column) {}
+	Symbol name;
+	SpanId span;
 
-	inline ExprType get_type() override { return ExprType::self; }
+	Expr_This(Symbol p_name, SpanId p_span):
+		name(p_name), span(p_span) {}
 };
 
-struct Expr_Unary : public Expr {
-	const Token _operator;
-	const Expr *right;
+struct Expr_Unary {
+	static constexpr ExprType kind = ExprType::unary;
 
-	Expr_Unary(const Token __operator, const Expr* _right) :
-		_operator(__operator),
-		right(_right)
-	{}
+	ExprId right;
+	const SpanId span;
+	const TokenType _operator;
 
-	inline ExprType get_type() override { return ExprType::unary; }
+	Expr_Unary(const TokenType __operator, const SpanId _span, ExprId _right) :
+		right(_right),
+		span(_span),
+		_operator(__operator)
+	{}
 };
 
-struct Expr_Variable : public Expr {
-	const std::string name;
-	const uint32_t line;
-	const uint32_t column;
+struct Expr_Variable {
+	static constexpr ExprType kind = ExprType::variable;
+
+	const Symbol name;
+	const SpanId span;
+	LocalRef local = {};
 	const bool is_function;
 
-	Expr_Variable(const std::string _name, const uint32_t _line, const uint32_t _column, const bool _is_function) :
+	Expr_Variable(const Symbol _name, const SpanId _span, const bool _is_function) :
 		name(_name),
-		line(_line),
-		column(_column),
+		span(_span),
 		is_function(_is_function)
 	{}
-
-	inline ExprType get_type() override { return ExprType::variable; }
 };
 
@@ -21,7 +21,7 @@
 
 extern bool REPL;
 
-Interpreter::Interpreter() {
+Interpreter::Interpreter(Ast* p_ast): ast(p_ast) {
 	globals = DBG_new Environment();
 
 	strings_arena = arena_make();
@@ -72,7 +72,8 @@ Interpreter::Interpreter() {
 			Java_double input = cast_to_double(args[0].object, "sqrt", line, column);
 			return JavaObject{ JavaType::_double, JavaValue{ ._double = sqrt(input) }};
 		},
-		[]() { return "<native_fn sqrt>"; });
+		[]() { return "<native_fn sqrt>"; },
+		true, JavaType::_double);
 
 	globals->define_native_function("pow",
 		[]() { return 2; },
@@ -81,7 +82,8 @@ Interpreter::Interpreter() {
 			Java_double power = cast_to_double(args[1].object, "pow", line, column);
 			return JavaObject{ JavaType::_double, JavaValue{ ._double = pow(number, power) }};
 		},
-		[]() { return "<native_fn pow>"; });
+		[]() { return "<native_fn pow>"; },
+		true, JavaType::_double);
 
 	environment = globals;
 }
@@ -95,20 +97,12 @@ Interpreter::~Interpreter() {
 
 			switch (function->get_type()) {
 				case CallableType::UserDefined: {
-					JavaFunction* userfn = dynamic_cast<JavaFunction*>(function);
-					const auto& body = userfn->declaration_body;
-
-					for (int i = 0; i < body->size(); i++) {
-						stmt_free(body->at(i));
-					}
-
-					delete userfn->declaration_body;
-					delete userfn->declaration_params;
+					JavaFunction* userfn = callable_cast<JavaFunction>(function);
 					delete userfn;
 				} break;
 
 				case CallableType::Builtin: {
-					JavaNativeFunction* nativefn = (JavaNativeFunction*)function;
+					JavaNativeFunction* nativefn = callable_cast<JavaNativeFunction>(function);
 					delete nativefn;
 				} break;
 			}
@@ -118,19 +112,10 @@ Interpreter::~Interpreter() {
 			for (auto const& [_, variable] : classinfo->static_fields) {
 				if (variable.object.type == JavaType::Function) {
 					JavaCallable* callable = (JavaCallable*)variable.object.value.function;
-					assert(callable->get_type() == CallableType::UserDefined);
-					JavaFunction* userfn = dynamic_cast<JavaFunction*>(callable);
+					JavaFunction* userfn = callable_cast<JavaFunction>(callable);
 					delete userfn;
 				}
 			}
-			for (Stmt_Function* method : classinfo->methods) {
-				delete method->params;
-				for (int i = 0; i < method->body->size(); i++) {
-					stmt_free(method->body->at(i));
-				}
-				delete method->body;
-				delete method;
-			}
 			delete classinfo;
 		}
 	}
@@ -140,9 +125,8 @@ Interpreter::~Interpreter() {
 		for (auto const& [_, variable] : instance->fields) {
 			if (variable.object.type == JavaType::Function) {
 				JavaCallable* callable = (JavaCallable*)variable.object.value.function;
-				assert(callable->get_type() == CallableType::UserDefined);
-				JavaFunction* userfn = dynamic_cast<JavaFunction*>(callable);
-				if (userfn->closure != nullptr && userfn->closure->values.contains("this")) {
+				JavaFunction* userfn = callable_cast<JavaFunction>(callable);
+				if (userfn->closure != nullptr && userfn->closure->values.contains(SYMBOL_THIS)) {
 					delete userfn->closure;
 					userfn->closure = nullptr;
 				}
@@ -155,10 +139,10 @@ Interpreter::~Interpreter() {
 	delete globals;
 }
 
-void Interpreter::interpret(std::vector<Stmt*>* statements) {
+void Interpreter::interpret(const StmtList& statements) {
 	try {
-		for (int i = 0; i < statements->size(); i++) {
-			execute_statement(statements->at(i));
+		for (int i = 0; i < statements.size(); i++) {
+			execute_statement(statements.at(i));
 		}
 	}
 	catch (JavaRuntimeError error) {
@@ -166,17 +150,17 @@ void Interpreter::interpret(std::vector<Stmt*>* statements) {
 	}
 }
 
-void Interpreter::add_class_names(const std::set<std::string>& class_names) {
-	for (const std::string &name : class_names) {
+void Interpreter::add_class_names(const std::set<Symbol>& class_names) {
+	for (Symbol name : class_names) {
 		this->class_names.insert(name);
 	}
 }
 
-void Interpreter::execute_block(const std::vector<Stmt*>& statements, Environment* env) {
+void Interpreter::execute_block(const StmtList& statements, Environment* env) {
 	Environment* previous = this->environment;
 	this->environment = env;
 
-	for (Stmt* statement : statements) {
+	for (StmtId statement : statements) {
 		if (this->broke || this->continued) break;
 		execute_statement(statement);
 	}
@@ -185,28 +169,36 @@ void Interpreter::execute_block(const std::vector<Stmt*>& statements, Environmen
 	this->environment = previous;
 }
 
-JavaObject Interpreter::validate_variable(const Stmt_Var* stmt, const JavaType type, const Token& name, const Expr* initializer) {
+// Type of a variable declaration as it was written in the source.
+static std::string var_type_name(const Stmt_Var* stmt) {
+	if (stmt->type_name != SYMBOL_NONE) return symbol_table.name(stmt->type_name);
+	return get_token_type_lexeme(stmt->type);
+}
+
+JavaObject Interpreter::validate_variable(const Stmt_Var* stmt, const JavaType type, const VarName& name, ExprId initializer) {
 	JavaObject value = { JavaType::none, JavaValue{} };
 
 	if (type == JavaType::none) {
-		throw JAVA_RUNTIME_ERROR_VA(stmt->type, "Token '%s' is an invalid type.", stmt->type.lexeme);
+		std::string type_name = var_type_name(stmt);
+		throw JAVA_RUNTIME_ERROR_AT_VA(type_name, ast_span(ast, stmt->type_span), "Token '%s' is an invalid type.", type_name.c_str());
 	}
 
-	if (initializer != nullptr) {
-		value = evaluate((Expr*)initializer);
+	if (initializer != EXPR_NONE) {
+		value = evaluate(initializer);
 
 		if (value.type == JavaType::_void) {
-			throw JAVA_RUNTIME_ERROR(name, "Void isn't a valid value, as it is a zero-byte type.");
+			throw JAVA_RUNTIME_ERROR_AT(symbol_table.name(name.symbol), ast_span(ast, name.span), "Void isn't a valid value, as it is a zero-byte type.");
 		}
 
 		if (is_java_type_primitive(type) && value.type == JavaType::_null) {
-			throw JAVA_RUNTIME_ERROR(stmt->type, "Primitives can't be null.");
+			throw JAVA_RUNTIME_ERROR_AT(var_type_name(stmt), ast_span(ast, stmt->type_span), "Primitives can't be null.");
 		}
 
 		if (is_java_type_number(type) && !is_java_type_number(value.type) ||
 		   !is_java_type_number(type) &&  is_java_type_number(value.type))
 		{
-			throw JAVA_RUNTIME_ERROR_VA(stmt->type, "Can't do an implicit cast between '%s' and '%s'.", java_type_cstring(value.type), stmt->type.lexeme);
+			std::string type_name = var_type_name(stmt);
+			throw JAVA_RUNTIME_ERROR_AT_VA(type_name, ast_span(ast, stmt->type_span), "Can't do an implicit cast between '%s' and '%s'.", java_type_cstring(value.type), type_name.c_str());
 		}
 
 		value.is_null = (value.type == JavaType::_null);
@@ -214,30 +206,31 @@ JavaObject Interpreter::validate_variable(const Stmt_Var* stmt, const JavaType t
 	return value;
 }
 
-void Interpreter::execute_statement(Stmt* statement) {
-	switch (statement->get_type()) {
+void Interpreter::execute_statement(StmtId statement) {
+	switch (stmt_type(statement)) {
 		case StmtType::Break: {
 			this->broke = true;
 		} break;
 
 		case StmtType::Block: {
-			Stmt_Block* stmt = dynamic_cast<Stmt_Block*>(statement);
-			auto block_environment = DBG_new Environment(environment);
+			Stmt_Block* stmt = ast_get<Stmt_Block>(ast, statement);
+			auto block_environment = DBG_new Environment(environment, stmt->slot_count);
 			execute_block(stmt->statements, block_environment);
 		} break;
 
 		case StmtType::Class: {
-			Stmt_Class* stmt = dynamic_cast<Stmt_Class*>(statement);
+			Stmt_Class* stmt = ast_get<Stmt_Class>(ast, statement);
+			const SourceSpan& span = ast_span(ast, stmt->span);
 			JavaClass *class_info = DBG_new JavaClass{ 
 				this,
-				std::string(stmt->name.lexeme),
-				stmt->name.line,
-				stmt->name.column,
+				symbol_table.name(stmt->name),
+				span.line,
+				span.column,
 				stmt->is_abstract,
 				stmt->attributes,
 				stmt->methods,
 			};
-			environment->define(stmt->name, JavaType::Class, JavaVariable{
+			environment->define(stmt->name, span, JavaType::Class, JavaVariable{
 				.object = {JavaType::Class, {.class_info = class_info} },
 				.visibility = Visibility::Public,
 				.is_static = false,
@@ -251,10 +244,10 @@ void Interpreter::execute_statement(Stmt* statement) {
 		} break;
 
 		case StmtType::Expression: { 
-			Stmt_Expression* stmt = dynamic_cast<Stmt_Expression*>(statement);
-			JavaObject value = evaluate((Expr*)stmt->expression);
+			Stmt_Expression* stmt = ast_get<Stmt_Expression>(ast, statement);
+			JavaObject value = evaluate(stmt->expression);
 			if (REPL) {
-				AstPrinter::println("Expression Ast: ", (Expr*)stmt->expression);
+				AstPrinter::println("Expression Ast: ", ast, stmt->expression);
 				printf("Expression statement result: ");
 				java_object_print(value);
 				printf("\n\n");
@@ -262,7 +255,7 @@ void Interpreter::execute_statement(Stmt* statement) {
 		} break;
 
 		case StmtType::Function: {
-			Stmt_Function* stmt = dynamic_cast<Stmt_Function*>(statement);
+			Stmt_Function* stmt = ast_get<Stmt_Function>(ast, statement);
 			void* fn = DBG_new JavaFunction(stmt, this->globals);
 			JavaVariable function = {
 				.object = {
@@ -274,77 +267,78 @@ void Interpreter::execute_statement(Stmt* statement) {
 				.is_final = true,
 				.is_uninitialized = false,
 			};
-			globals->define(stmt->name, JavaType::Function, function);
+			globals->define(stmt->name, ast_span(ast, stmt->span), JavaType::Function, function);
 		} break;
 
 		case StmtType::If: { 
-			Stmt_If* stmt = dynamic_cast<Stmt_If*>(statement);
-			JavaObject condition = evaluate((Expr*)stmt->condition);
+			Stmt_If* stmt = ast_get<Stmt_If>(ast, statement);
+			JavaObject condition = evaluate(stmt->condition);
 			if (condition.type != JavaType::_boolean) {
-				throw JAVA_RUNTIME_ERROR(stmt->token, "Condition must be boolean");
+				throw JAVA_RUNTIME_ERROR_AT(get_token_type_lexeme(TokenType::_if), ast_span(ast, stmt->span), "Condition must be boolean");
 			}
 
 			if (condition.value._boolean) {
-				execute_statement((Stmt*)stmt->then_branch);
+				execute_statement(stmt->then_branch);
 			}
 			else {
 				bool matched = false;
 				for (int i = 0; i < stmt->else_ifs.size(); i++) {
 					const Else_If& else_if = stmt->else_ifs.at(i);
-					JavaObject else_if_condition = evaluate((Expr*)else_if.condition);
+					JavaObject else_if_condition = evaluate(else_if.condition);
 					if (else_if_condition.type != JavaType::_boolean) {
-						throw JAVA_RUNTIME_ERROR(else_if.token, "Condition must be boolean");
+						throw JAVA_RUNTIME_ERROR_AT(get_token_type_lexeme(TokenType::_if), ast_span(ast, else_if.span), "Condition must be boolean");
 					}
 					if (else_if_condition.value._boolean) {
 						matched = true;
-						execute_statement((Stmt*)else_if.then_branch);
+						execute_statement(else_if.then_branch);
 						break;
 					}
 				}
-				if (stmt->else_branch != nullptr && !matched) {
-					execute_statement((Stmt*)stmt->else_branch);
+				if (stmt->else_branch != STMT_NONE && !matched) {
+					execute_statement(stmt->else_branch);
 				}
 			}
 		} break;
 
 		case StmtType::Print: { 
-			Stmt_Print* stmt = dynamic_cast<Stmt_Print*>(statement);
-			JavaObject value = evaluate((Expr*)stmt->expression);
+			Stmt_Print* stmt = ast_get<Stmt_Print>(ast, statement);
+			JavaObject value = evaluate(stmt->expression);
 			if (value.type == JavaType::_void) {
-				throw JAVA_RUNTIME_ERROR(stmt->token, "Can't print void.");
+				TokenType keyword = stmt->has_newline ? TokenType::soutln : TokenType::sout;
+				throw JAVA_RUNTIME_ERROR_AT(get_token_type_lexeme(keyword), ast_span(ast, stmt->span), "Can't print void.");
 			}
-			if (REPL) AstPrinter::println("Print Ast: ", (Expr*)stmt->expression);
+			if (REPL) AstPrinter::println("Print Ast: ", ast, stmt->expression);
 			java_object_print(value);
 			if (stmt->has_newline) printf("\n");
 		} break;
 
 		case StmtType::Return: {
-			Stmt_Return* stmt = dynamic_cast<Stmt_Return*>(statement);
+			Stmt_Return* stmt = ast_get<Stmt_Return>(ast, statement);
 			JavaObject value = { JavaType::_void, JavaValue{} };
-			if (stmt->value != nullptr) {
-				value = evaluate((Expr*)stmt->value);
+			if (stmt->value != EXPR_NONE) {
+				value = evaluate(stmt->value);
 			}
 			throw Return{ value };
 		} break;
 
 		case StmtType::Var: {
-			Stmt_Var* stmt = dynamic_cast<Stmt_Var*>(statement);
+			Stmt_Var* stmt = ast_get<Stmt_Var>(ast, statement);
 
 			assert(stmt->names.size() == stmt->initializers.size());
 
 			for (int i = 0; i < stmt->names.size(); i++) {
-				Expr* initializer = stmt->initializers.at(i);
-				const Token& name = stmt->names.at(i);
-				JavaType type = token_type_to_java_type(stmt->type.type);
+				ExprId initializer = stmt->initializers.at(i);
+				const VarName& name = stmt->names.at(i);
+				JavaType type = token_type_to_java_type(stmt->type);
 				JavaObject value = validate_variable(stmt, type, name, initializer);
-				environment->define(stmt, name, initializer, type, value);
+				environment->define(stmt, name, ast_span(ast, name.span), initializer, type, value);
 
 				if (REPL) {
 					printf("Defined %s ", stmt->is_static ? "static" : "non static");
-					printf("(%s %s) ", stmt->is_final ? "final" : "var", name.lexeme);
-					printf("of type (%s) with visibility ", stmt->type.lexeme);
+					printf("(%s %s) ", stmt->is_final ? "final" : "var", symbol_table.name(name.symbol).c_str());
+					printf("of type (%s) with visibility ", var_type_name(stmt).c_str());
 					printf("%s", visibility_to_cstring(stmt->visibility));
-					if (initializer != nullptr) {
+					if (initializer != EXPR_NONE) {
 						printf(" initialized with ");
 						java_object_print(value);
 					}
@@ -354,42 +348,120 @@ void Interpreter::execute_statement(Stmt* statement) {
 		} break;
 
 		case StmtType::While: {
-			Stmt_While* stmt = dynamic_cast<Stmt_While*>(statement);
-			JavaObject condition = evaluate((Expr*)stmt->condition);
+			Stmt_While* stmt = ast_get<Stmt_While>(ast, statement);
+			JavaObject condition = evaluate(stmt->condition);
 			if (condition.type != JavaType::_boolean) {
-				throw JAVA_RUNTIME_ERROR(stmt->token, "Expected boolean condition.");
+				throw JAVA_RUNTIME_ERROR_AT(get_token_type_lexeme(stmt->keyword), ast_span(ast, stmt->span), "Expected boolean condition.");
 			}
 			while (condition.value._boolean) {
-				execute_statement((Stmt*)stmt->body);
+				execute_statement(stmt->body);
 				if (this->broke) {
 					this->broke = false;
 					break;
 				}
 				if (this->continued) {
 					this->continued = false;
-					if (((Stmt*)stmt->body)->get_type() == StmtType::Block && stmt->has_increment) {
-						Stmt_Block* block = dynamic_cast<Stmt_Block*>((Stmt*)stmt->body);
-						execute_statement(block->statements.back());
+					if (stmt_type(stmt->body) == StmtType::Block && stmt->has_increment) {
+						// The increment was resolved as the last statement of the body, so it runs in a scope like the body's.
+						Stmt_Block* block = ast_get<Stmt_Block>(ast, stmt->body);
+						execute_block(StmtList{ &block->statements.back(), 1 }, DBG_new Environment(environment, block->slot_count));
 					}
 				}
-				condition = evaluate((Expr*)stmt->condition);
+				condition = evaluate(stmt->condition);
 			}
 		} break;
 	}
 }
 
-JavaObject Interpreter::evaluate_binary(Expr* expression) {
-	Expr_Binary* expr = dynamic_cast<Expr_Binary*>(expression);
-	JavaObject lhs = evaluate((Expr*)expr->left);
-	JavaObject rhs = evaluate((Expr*)expr->right);
+JavaObject Interpreter::evaluate_binary(ExprId expression) {
+	Expr_Binary* expr = ast_get<Expr_Binary>(ast, expression);
+	JavaObject lhs = evaluate(expr->left);
+	JavaObject rhs = evaluate(expr->right);
+
+	// Runtime errors reported on the operators.
+	#define op_error(message) throw JAVA_RUNTIME_ERROR_AT(get_token_type_lexeme(expr->_operator), ast_span(ast, expr->span), message)
+
+	// Kernel picked by the resolver, when the operands have the types it was picked for.
+	if (expr->kernel != BINARY_KERNEL_NONE && lhs.type == expr->left_type && rhs.type == expr->right_type) {
+		JavaObject result = {};
+
+		// Only the operand of the smaller type has to be promoted.
+		#define operand(side, T) ((side.type == JavaType::T) ? side.value.T : java_cast_to##T(side))
+
+		#define kernel(op, T, c_op)                                              \
+			case binary_kernel(BinaryOp::op, JavaType::T): {                     \
+				result.type = JavaType::T;                                       \
+				result.value.T = operand(lhs, T) c_op operand(rhs, T);          \
+				return result;                                                   \
+			} break;
+
+		#define kernel_right_not_zero(op, T, c_op)                               \
+			case binary_kernel(BinaryOp::op, JavaType::T): {                     \
+				Java##T right = operand(rhs, T);                                 \
+				if (right == 0) {                                                \
+					op_error("Right hand side can't be zero");                   \
+				}                                                                \
+				result.type = JavaType::T;                                       \
+				result.value.T = operand(lhs, T) c_op right;                     \
+				return result;                                                   \
+			} break;
+
+		#define kernel_bool(op, T, c_op)                                         \
+			case binary_kernel(BinaryOp::op, JavaType::T): {                     \
+				result.type = JavaType::_boolean;                                \
+				result.value._boolean = operand(lhs, T) c_op operand(rhs, T);   \
+				return result;                                                   \
+			} break;
+
+		#define kernels_number(op, c_op, kernel_macro) \
+			kernel_macro(op, _byte, c_op)              \
+			kernel_macro(op, _int, c_op)               \
+			kernel_macro(op, _long, c_op)              \
+			kernel_macro(op, _float, c_op)             \
+			kernel_macro(op, _double, c_op)
+
+		#define kernels_whole(op, c_op, kernel_macro) \
+			kernel_macro(op, _byte, c_op)             \
+			kernel_macro(op, _int, c_op)              \
+			kernel_macro(op, _long, c_op)
+
+		// Chars can only be compared.
+		#define kernels_bool(op, c_op)   \
+			kernel_bool(op, _char, c_op) \
+			kernels_number(op, c_op, kernel_bool)
+
+		switch (expr->kernel) {
+			kernels_number(add, +, kernel)
+			kernels_number(subtract, -, kernel)
+			kernels_number(multiply, *, kernel)
+			kernels_number(divide, /, kernel_right_not_zero)
+			kernels_whole(remainder, %, kernel_right_not_zero)
+			kernels_whole(left_shift, <<, kernel)
+			kernels_whole(right_shift, >>, kernel)
+			kernels_whole(bitwise_or, |, kernel)
+			kernels_whole(bitwise_xor, ^, kernel)
+			kernels_whole(bitwise_and, &, kernel)
+			kernels_bool(greater, >)
+			kernels_bool(less, <)
+			kernels_bool(greater_equal, >=)
+			kernels_bool(less_equal, <=)
+			kernels_bool(equal, ==)
+			kernels_bool(not_equal, !=)
+		}
+
+		#undef operand
+		#undef kernel
+		#undef kernel_right_not_zero
+		#undef kernel_bool
+		#undef kernels_number
+		#undef kernels_whole
+		#undef kernels_bool
+	}
 
 	JavaType smaller = java_get_smaller_type(lhs, rhs);
 	JavaType bigger = java_get_bigger_type(lhs, rhs);
 	JavaObject result = { bigger, JavaValue{} };
 
-	// Runtime errors reported on the operators.
-	#define op_error(message) throw JAVA_RUNTIME_ERROR(expr->_operator, message)
-
 	// These are intended for numbers.
 	#define case_binary(T, op)                                             \
 		case JavaType::T: {                                                \
@@ -461,7 +533,7 @@ JavaObject Interpreter::evaluate_binary(Expr* expression) {
 		} break;
 
 	// Actually calling those crazy macros to generate the code.
-	switch (expr->_operator.type) {
+	switch (expr->_operator) {
 		case_op(-, minus, case_binary)
 		case_op(*, star, case_binary)
 		case_op(/, slash, case_binary_right_not_zero)
@@ -478,6 +550,7 @@ JavaObject Interpreter::evaluate_binary(Expr* expression) {
 		case_op_whole(|, bitwise_or, case_binary)
 		case_op_whole(^, bitwise_xor, case_binary)
 		case_op_whole(&, bitwise_and, case_binary)
+		default: break;
 	}
 
 	// These crazy macros are only for this code.
@@ -492,12 +565,12 @@ JavaObject Interpreter::evaluate_binary(Expr* expression) {
 	return JavaObject{ JavaType::none, JavaValue{} };
 }
 
-JavaObject Interpreter::evaluate_unary(Expr* expression) {
-	Expr_Unary* expr = dynamic_cast<Expr_Unary*>(expression);
-	JavaObject right = evaluate((Expr*)expr->right);
+JavaObject Interpreter::evaluate_unary(ExprId expression) {
+	Expr_Unary* expr = ast_get<Expr_Unary>(ast, expression);
+	JavaObject right = evaluate(expr->right);
 
 	// Runtime errors reported on the operators.
-	#define op_error(message) throw JAVA_RUNTIME_ERROR(expr->_operator, message)
+	#define op_error(message) throw JAVA_RUNTIME_ERROR_AT(get_token_type_lexeme(expr->_operator), ast_span(ast, expr->span), message)
 
 	// This is intended for numbers and booleans.
 	#define case_unary(op, T)                   \
@@ -534,7 +607,7 @@ JavaObject Interpreter::evaluate_unary(Expr* expression) {
 		} break;
 
 	// Actual code calling some of the macros.
-	switch (expr->_operator.type) {
+	switch (expr->_operator) {
 		case_op_unary(-, minus)
 		case_op_unary_whole(~, bitwise_not)
 
@@ -545,6 +618,8 @@ JavaObject Interpreter::evaluate_unary(Expr* expression) {
 			return result;
 		} break;
 
+		default: break;
+
 		// Those crazy macros exist only for this code.
 		#undef op_error
 		#undef case_unary
@@ -554,12 +629,13 @@ JavaObject Interpreter::evaluate_unary(Expr* expression) {
 	return JavaObject{ JavaType::none, JavaValue{} };
 }
 
-JavaObject Interpreter::evaluate_increment_or_decrement(Expr* expression) {
-	Expr_Increment* expr = dynamic_cast<Expr_Increment*>(expression);
-	JavaObject result = environment->get(expr->name);
+JavaObject Interpreter::evaluate_increment_or_decrement(ExprId expression) {
+	Expr_Increment* expr = ast_get<Expr_Increment>(ast, expression);
+	const SourceSpan& span = ast_span(ast, expr->span);
+	JavaObject result = environment->get(expr->name, expr->local, span);
 
 	#define case_op(op, T) case JavaType::T: op result.value.T; break;
-	#define type_error() throw JAVA_RUNTIME_ERROR(expr->name, "Expected a number operand.")
+	#define type_error() throw JAVA_RUNTIME_ERROR_AT(symbol_table.name(expr->name), span, "Expected a number operand.")
 
 	if (expr->is_positive) {
 		switch (result.type) {
@@ -586,28 +662,28 @@ JavaObject Interpreter::evaluate_increment_or_decrement(Expr* expression) {
 	#undef case_op
 	#undef type_error
 
-	environment->assign(expr->name, result);
+	environment->assign(expr->name, expr->local, span, result);
 	return result;
 }
 
-JavaObject Interpreter::evaluate_logical(Expr* expression) {
-	Expr_Logical* expr = dynamic_cast<Expr_Logical*>(expression);
+JavaObject Interpreter::evaluate_logical(ExprId expression) {
+	Expr_Logical* expr = ast_get<Expr_Logical>(ast, expression);
 	JavaObject result = { JavaType::_boolean, JavaValue{} };
 
-	JavaObject lhs = evaluate((Expr*)expr->left);
+	JavaObject lhs = evaluate(expr->left);
 	if (lhs.type != JavaType::_boolean) {
-		throw JAVA_RUNTIME_ERROR(expr->_operator, "Expected boolean operand on the left hand side.");
+		throw JAVA_RUNTIME_ERROR_AT(get_token_type_lexeme(expr->_operator), ast_span(ast, expr->span), "Expected boolean operand on the left hand side.");
 	}
 
-	switch (expr->_operator.type) {
+	switch (expr->_operator) {
 		case TokenType::_or: {
 			if (lhs.value._boolean == true) {
 				result.value._boolean = true;
 			}
 			else {
-				JavaObject rhs = evaluate((Expr*)expr->right);
+				JavaObject rhs = evaluate(expr->right);
 				if (rhs.type != JavaType::_boolean) {
-					throw JAVA_RUNTIME_ERROR(expr->_operator, "Expected boolean operand on the right hand side.");
+					throw JAVA_RUNTIME_ERROR_AT(get_token_type_lexeme(expr->_operator), ast_span(ast, expr->span), "Expected boolean operand on the right hand side.");
 				}
 				result.value._boolean = rhs.value._boolean;
 			}
@@ -618,25 +694,27 @@ JavaObject Interpreter::evaluate_logical(Expr* expression) {
 				result.value._boolean = false;
 			}
 			else {
-				JavaObject rhs = evaluate((Expr*)expr->right);
+				JavaObject rhs = evaluate(expr->right);
 				if (rhs.type != JavaType::_boolean) {
-					throw JAVA_RUNTIME_ERROR(expr->_operator, "Expected boolean operand on the right hand side.");
+					throw JAVA_RUNTIME_ERROR_AT(get_token_type_lexeme(expr->_operator), ast_span(ast, expr->span), "Expected boolean operand on the right hand side.");
 				}
 				result.value._boolean = rhs.value._boolean;
 			}
 		} break;
+
+		default: break;
 	}
 	return result;
 }
 
-JavaObject Interpreter::evaluate(Expr* expression) {
-	if (expression == nullptr) return JavaObject{ JavaType::none, JavaValue{} };
+JavaObject Interpreter::evaluate(ExprId expression) {
+	if (expression == EXPR_NONE) return JavaObject{ JavaType::none, JavaValue{} };
 
-	switch (expression->get_type()) {
+	switch (expr_type(expression)) {
 		case ExprType::assign: {
-			Expr_Assign* expr = dynamic_cast<Expr_Assign*>(expression);
-			JavaObject value = evaluate((Expr*)expr->rhs);
-			environment->assign(expr->lhs_name, expr->line, expr->column, value);
+			Expr_Assign* expr = ast_get<Expr_Assign>(ast, expression);
+			JavaObject value = evaluate(expr->rhs);
+			environment->assign(expr->lhs_name, expr->local, ast_span(ast, expr->span), value);
 			return value;
 		} break;
 
@@ -645,24 +723,32 @@ JavaObject Interpreter::evaluate(Expr* expression) {
 		} break;
 
 		case ExprType::call: {
-			Expr_Call* expr = dynamic_cast<Expr_Call*>(expression);
-			JavaObject callee = evaluate((Expr*)expr->callee);
+			Expr_Call* expr = ast_get<Expr_Call>(ast, expression);
+			JavaObject callee = evaluate(expr->callee);
 
 			std::vector<ArgumentInfo> arguments = {};
-			for (int i = 0; i < expr->arguments->size(); i++) {
-				const auto& argument = expr->arguments->at(i);
-				JavaObject object = evaluate((Expr*)argument.expr);
-				arguments.emplace_back(object, argument.column, argument.line);
+			for (int i = 0; i < expr->arguments.size(); i++) {
+				const auto& argument = expr->arguments.at(i);
+				JavaObject object = evaluate(argument.expr);
+				arguments.emplace_back(object, argument.span);
 			}
 
+			// The callable classes are final, so these calls don't go through the vtable.
 			JavaCallable *function = (JavaCallable*)callee.value.function;
-			return function->call(this, expr->paren.line, expr->paren.column, arguments);
+			const SourceSpan& paren = ast_span(ast, expr->paren);
+			uint32_t line = paren.line, column = paren.column;
+			switch (function->get_type()) {
+				case CallableType::UserDefined: return callable_cast<JavaFunction>(function)->call(this, line, column, arguments);
+				case CallableType::Builtin: return callable_cast<JavaNativeFunction>(function)->call(this, line, column, arguments);
+				case CallableType::Constructor: return callable_cast<JavaClass>(function)->call(this, line, column, arguments);
+			}
+			return function->call(this, line, column, arguments);
 		} break;
 
 		case ExprType::cast: {
-			Expr_Cast* expr = dynamic_cast<Expr_Cast*>(expression);
+			Expr_Cast* expr = ast_get<Expr_Cast>(ast, expression);
 			JavaObject result = { expr->type, {} };
-			JavaObject right = evaluate((Expr*)expr->right);
+			JavaObject right = evaluate(expr->right);
 
 			switch (expr->type) {
 				case JavaType::_byte: result.value._byte = java_cast_to_byte(right); break;
@@ -671,29 +757,29 @@ JavaObject Interpreter::evaluate(Expr* expression) {
 				case JavaType::_long: result.value._long = java_cast_to_long(right); break;
 				case JavaType::_float: result.value._float = java_cast_to_float(right); break;
 				case JavaType::_double: result.value._double = java_cast_to_double(right); break;
-				default: throw JAVA_RUNTIME_ERR(java_type_cstring(expr->type), expr->line, expr->column, "Invalid type to cast.");
+				default: throw JAVA_RUNTIME_ERROR_AT(java_type_cstring(expr->type), ast_span(ast, expr->span), "Invalid type to cast.");
 			}
 			return result;
 		} break;
 
 		case ExprType::literal: {
-			Expr_Literal* expr = dynamic_cast<Expr_Literal*>(expression);
+			Expr_Literal* expr = ast_get<Expr_Literal>(ast, expression);
 			return expr->literal;
 		} break;
 
 		case ExprType::ternary: {
-			Expr_Ternary* expr = dynamic_cast<Expr_Ternary*>(expression);
-			JavaObject condition = evaluate((Expr*)expr->condition);
+			Expr_Ternary* expr = ast_get<Expr_Ternary>(ast, expression);
+			JavaObject condition = evaluate(expr->condition);
 			if (condition.type != JavaType::_boolean) {
-				throw JAVA_RUNTIME_ERROR(expr->question_mark, "Only booleans.");
+				throw JAVA_RUNTIME_ERROR_AT(get_token_type_lexeme(TokenType::question), ast_span(ast, expr->question_mark), "Only booleans.");
 			}
-			if (condition.value._boolean) return evaluate((Expr*)expr->then);
-			return evaluate((Expr*)expr->otherwise);
+			if (condition.value._boolean) return evaluate(expr->then);
+			return evaluate(expr->otherwise);
 		} break;
 
 		case ExprType::self: {
-			Expr_This* expr = dynamic_cast<Expr_This*>(expression);
-			return environment->get(expr->name, expr->line, expr->column);
+			Expr_This* expr = ast_get<Expr_This>(ast, expression);
+			return environment->get(expr->name, ast_span(ast, expr->span));
 		} break;
 
 		case ExprType::logical: {
@@ -701,8 +787,8 @@ JavaObject Interpreter::evaluate(Expr* expression) {
 		} break;
 
 		case ExprType::get: {
-			Expr_Get* expr = dynamic_cast<Expr_Get*>(expression);
-			JavaObject object = evaluate((Expr*)expr->object);
+			Expr_Get* expr = ast_get<Expr_Get>(ast, expression);
+			JavaObject object = evaluate(expr->object);
 			switch (object.type) {
 				case JavaType::Instance: {
 					JavaInstance* instance = (JavaInstance*)object.value.instance;
@@ -714,13 +800,13 @@ JavaObject Interpreter::evaluate(Expr* expression) {
 					return classinfo->get(expr);
 				} break;
 
-				default: throw JAVA_RUNTIME_ERR(expr->name, expr->line, expr->column, "Only instances and classes have properties.");
+				default: throw JAVA_RUNTIME_ERROR_AT(symbol_table.name(expr->name), ast_span(ast, expr->span), "Only instances and classes have properties.");
 			}
 		} break;
 
 		case ExprType::grouping: {
-			Expr_Grouping* expr = dynamic_cast<Expr_Grouping*>(expression);
-			return evaluate((Expr*)expr->expression);
+			Expr_Grouping* expr = ast_get<Expr_Grouping>(ast, expression);
+			return evaluate(expr->expression);
 		} break;
 
 		case ExprType::increment: {
@@ -728,12 +814,12 @@ JavaObject Interpreter::evaluate(Expr* expression) {
 		} break;
 
 		case ExprType::set: {
-			Expr_Set* expr = dynamic_cast<Expr_Set*>(expression);
-			JavaObject lhs = evaluate((Expr*)expr->lhs->object);
+			Expr_Set* expr = ast_get<Expr_Set>(ast, expression);
+			JavaObject lhs = evaluate(ast_get<Expr_Get>(ast, expr->lhs)->object);
 			if (lhs.type != JavaType::Instance) {
-				throw JAVA_RUNTIME_ERR(expr->rhs_name, expr->line, expr->column, "Only instances have fields.");
+				throw JAVA_RUNTIME_ERROR_AT(symbol_table.name(expr->rhs_name), ast_span(ast, expr->span), "Only instances have fields.");
 			}
-			JavaObject value = evaluate((Expr*)expr->value);
+			JavaObject value = evaluate(expr->value);
 			JavaInstance* instance = (JavaInstance*)lhs.value.instance;
 			instance->set(expr, value);
 			return value;
@@ -744,8 +830,8 @@ JavaObject Interpreter::evaluate(Expr* expression) {
 		} break;
 
 		case ExprType::variable: {
-			Expr_Variable* expr = dynamic_cast<Expr_Variable*>(expression);
-			return environment->get(expr->name, expr->line, expr->column);
+			Expr_Variable* expr = ast_get<Expr_Variable>(ast, expression);
+			return environment->get(expr->name, expr->local, ast_span(ast, expr->span));
 		} break;
 	}
 
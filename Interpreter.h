@@ -1,38 +1,50 @@
 #pragma once
 
-#include "Expr.h"
-#include "Stmt.h"
+#include "Ast.h"
 #include "Arena.h"
 #include "JavaObject.h"
 #include "Environment.h"
+#include "Optimizer.h"
 
 #include <set>
 #include <random>
 
 class Interpreter {
 public:
-	Interpreter();
+	Interpreter(Ast* p_ast);
 	~Interpreter();
-	void interpret(std::vector<Stmt*>* statements);
-	void execute_block(const std::vector<Stmt*> &statements, Environment *environment);
-	void add_class_names(const std::set<std::string>& class_names);
-	JavaObject validate_variable(const Stmt_Var* stmt, const JavaType type, const Token& name, const Expr* initializer);
+	void interpret(const StmtList& statements);
+	void execute_block(const StmtList& statements, Environment *environment);
+	void add_class_names(const std::set<Symbol>& class_names);
+	JavaObject validate_variable(const Stmt_Var* stmt, const JavaType type, const VarName& name, ExprId initializer);
+	// Only for expressions that read nothing but literals, see Optimizer.h.
+	JavaObject evaluate_constant(ExprId expression) { return evaluate(expression); }
 	struct Return { JavaObject value; };
 private:
-	void execute_statement(Stmt* statement);
-	JavaObject evaluate(Expr *expression);
-	JavaObject evaluate_binary(Expr *expression);
-	JavaObject evaluate_logical(Expr* expression);
-	JavaObject evaluate_increment_or_decrement(Expr* expression);
-	JavaObject evaluate_unary(Expr *expression);
+	void execute_statement(StmtId statement);
+	JavaObject evaluate(ExprId expression);
+	JavaObject evaluate_binary(ExprId expression);
+	JavaObject evaluate_logical(ExprId expression);
+	JavaObject evaluate_increment_or_decrement(ExprId expression);
+	JavaObject evaluate_unary(ExprId expression);
 private:
 	bool broke = false;
 	bool continued = false;
 	std::mt19937 gen;
 public:
+	Ast* ast;
 	Environment* globals;
 	Environment* environment;
 	std::vector<void*> instances;
-	std::set<std::string> class_names;
+	std::set<Symbol> class_names;
+	// Filled by the optimizer, it outlives one run of it because of the REPL and lazy bodies.
+	std::unordered_map<Symbol, ClassConstants> class_constants;
+	// Nodes the optimizer took out of the tree as dead code, they stay in the Ast until it's freed.
+	size_t removed_nodes = 0;
+	// Bodies with at most this many nodes are copied into the calls to them, 0 turns inlining off.
+	uint32_t inline_budget = INLINE_DEFAULT_BUDGET;
+	size_t inlined_calls = 0;
+	// Functions whose bodies are being optimized, they aren't inlined until they're done.
+	std::vector<const Stmt_Function*> optimizing_functions;
 	Arena strings_arena;
 };
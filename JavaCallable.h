@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Interpreter.h"
+#include <assert.h>
 
 enum class CallableType {
 	Builtin,
@@ -9,8 +10,20 @@ enum class CallableType {
 };
 
 struct JavaCallable {
-	virtual CallableType get_type() = 0;
+	// Stored in the callable so the interpreter can switch on it and call the concrete type directly.
+	const CallableType type;
+
+	JavaCallable(CallableType p_type): type(p_type) {}
+
+	inline CallableType get_type() const { return type; }
 	virtual int arity() = 0;
 	virtual JavaObject call(Interpreter* intepreter, uint32_t line, uint32_t column, std::vector<ArgumentInfo> arguments) = 0;
 	virtual std::string to_string() = 0;
 };
+
+// Checked replacement for dynamic_cast, T::callable_type must be the type stored in the callable.
+template<typename T>
+inline T* callable_cast(void* callable) {
+	assert(((JavaCallable*)callable)->type == T::callable_type && "Callable of a different type.");
+	return static_cast<T*>((JavaCallable*)callable);
+}
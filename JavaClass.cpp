@@ -13,11 +13,12 @@
 	#define DBG_new new
 #endif
 
-JavaClass::JavaClass(Interpreter *p_interpreter, std::string p_name, uint32_t p_line, uint32_t p_column, bool p_is_abstract, std::vector<Stmt_Var*> p_attributes, std::vector<Stmt_Function*> p_methods):
-	interpreter(p_interpreter), name(p_name), line(p_line), column(p_column), is_abstract(p_is_abstract), attributes(p_attributes), methods(p_methods)
+JavaClass::JavaClass(Interpreter *p_interpreter, std::string p_name, uint32_t p_line, uint32_t p_column, bool p_is_abstract, ArenaArray<StmtId> p_attributes, ArenaArray<StmtId> p_methods):
+	JavaCallable(callable_type), interpreter(p_interpreter), name(p_name), line(p_line), column(p_column), is_abstract(p_is_abstract), attributes(p_attributes), methods(p_methods)
 {
-	for (Stmt_Function* methoddecl : methods) {
-		if (strcmp(methoddecl->name.lexeme, "__init__") == 0) {
+	for (StmtId method : methods) {
+		Stmt_Function* methoddecl = ast_get<Stmt_Function>(interpreter->ast, method);
+		if (methoddecl->name == SYMBOL_INIT) {
 			this->constructor = methoddecl;
 			continue;
 		}
@@ -34,19 +35,22 @@ JavaClass::JavaClass(Interpreter *p_interpreter, std::string p_name, uint32_t p_
 			.is_final = true,
 			.is_uninitialized = false,
 		};
-		if (static_fields.contains(methoddecl->name.lexeme)) {
-			throw JAVA_RUNTIME_ERROR_VA(methoddecl->name, "In class '%s' the method '%s' is already defined.", this->name.c_str(), methoddecl->name.lexeme);
+		const Symbol method_name = methoddecl->name;
+		if (static_fields.contains(method_name)) {
+			const std::string& text = symbol_table.name(method_name);
+			throw JAVA_RUNTIME_ERROR_AT_VA(text, ast_span(interpreter->ast, methoddecl->span), "In class '%s' the method '%s' is already defined.", this->name.c_str(), text.c_str());
 		}
-		static_fields.insert({std::string(methoddecl->name.lexeme), variable});
+		static_fields.insert({method_name, variable});
 	}
-	for (Stmt_Var* vardecl : attributes) {
+	for (StmtId attribute : attributes) {
+		Stmt_Var* vardecl = ast_get<Stmt_Var>(interpreter->ast, attribute);
 		if (!vardecl->is_static) continue;
 		assert(vardecl->names.size() == vardecl->initializers.size());
 
 		for (int i = 0; i < vardecl->names.size(); i++) {
-			Expr* initializer = vardecl->initializers.at(i);
-			const Token& name = vardecl->names.at(i);
-			JavaType type = token_type_to_java_type(vardecl->type.type);
+			ExprId initializer = vardecl->initializers.at(i);
+			const VarName& name = vardecl->names.at(i);
+			JavaType type = token_type_to_java_type(vardecl->type);
 			JavaObject value = interpreter->validate_variable(vardecl, type, name, initializer);
 			JavaVariable variable = {
 				.object = value,
@@ -55,21 +59,23 @@ JavaClass::JavaClass(Interpreter *p_interpreter, std::string p_name, uint32_t p_
 				.is_final = vardecl->is_final,
 				.is_uninitialized = false,
 			};
-			auto casted = try_cast(std::string(name.lexeme), name.line, name.column, type, value);
+			const std::string& field_name = symbol_table.name(name.symbol);
+			const SourceSpan& span = ast_span(interpreter->ast, name.span);
+			auto casted = try_cast(field_name, span.line, span.column, type, value);
 			variable.object = casted.first;
 			variable.object.is_null = casted.second;
 
-			if (static_fields.contains(name.lexeme)) {
-				throw JAVA_RUNTIME_ERROR_VA(name, "In class '%s' the field '%s' is already defined.", this->name.c_str(), name.lexeme);
+			if (static_fields.contains(name.symbol)) {
+				throw JAVA_RUNTIME_ERROR_AT_VA(field_name, span, "In class '%s' the field '%s' is already defined.", this->name.c_str(), field_name.c_str());
 			}
-			static_fields.insert({ name.lexeme, variable });
+			static_fields.insert({ name.symbol, variable });
 		}
 	}
 }
 
 int JavaClass::arity() {
 	if (constructor == nullptr) return 0;
-	return (int)constructor->params->size();
+	return (int)constructor->params.size();
 }
 
 JavaObject JavaClass::call(Interpreter* interpreter, uint32_t line, uint32_t column, std::vector<ArgumentInfo> arguments) {
@@ -81,9 +87,9 @@ JavaObject JavaClass::call(Interpreter* interpreter, uint32_t line, uint32_t col
 	}
 	JavaInstance* instance = DBG_new JavaInstance{ interpreter, this }; // freed at interpreter destructor.
 	if (constructor != nullptr) {
-		JavaObject member = instance->get("__init__", line, column);
+		JavaObject member = instance->get(SYMBOL_INIT, line, column);
 		assert(member.type == JavaType::Function);
-		JavaFunction* fn = (JavaFunction*)member.value.function;
+		JavaFunction* fn = callable_cast<JavaFunction>(member.value.function);
 		fn->call(interpreter, line, column, arguments);
 	}
 	interpreter->instances.push_back(instance);
@@ -96,28 +102,30 @@ std::string JavaClass::to_string() {
 	return result;
 }
 
-CallableType JavaClass::get_type() {
-	return CallableType::Constructor;
-}
-
 JavaObject JavaClass::get(Expr_Get* expr) {
-	return get(expr->name, expr->line, expr->column);
+	const SourceSpan& span = ast_span(interpreter->ast, expr->span);
+	return get(expr->name, span.line, span.column);
 }
 
-JavaObject JavaClass::get(std::string name, uint32_t line, uint32_t column) {
-	if (static_fields.contains(name)) {
-		return static_fields.at(name).object;
+JavaObject JavaClass::get(Symbol name, uint32_t line, uint32_t column) {
+	auto field = static_fields.find(name);
+	if (field != static_fields.end()) {
+		return field->second.object;
 	}
-	throw JAVA_RUNTIME_ERR_VA(name, line, column, "Class '%s' doesn't have static field '%s'.", this->name.c_str(), name.c_str());
+	const std::string& text = symbol_table.name(name);
+	throw JAVA_RUNTIME_ERR_VA(text, line, column, "Class '%s' doesn't have static field '%s'.", this->name.c_str(), text.c_str());
 }
 
 void JavaClass::set(Expr_Set* expr, JavaObject value) {
-	set(expr->rhs_name, expr->line, expr->column, value);
+	const SourceSpan& span = ast_span(interpreter->ast, expr->span);
+	set(expr->rhs_name, span.line, span.column, value);
 }
 
-void JavaClass::set(std::string name, uint32_t line, uint32_t column, JavaObject value) {
-	if (static_fields.contains(name)) {
-		static_fields[name].object = value;
+void JavaClass::set(Symbol name, uint32_t line, uint32_t column, JavaObject value) {
+	auto field = static_fields.find(name);
+	if (field != static_fields.end()) {
+		field->second.object = value;
 	}
-	throw JAVA_RUNTIME_ERR_VA(name, line, column, "Class '%s' doesn't have static field '%s'.", this->name.c_str(), name.c_str());
+	const std::string& text = symbol_table.name(name);
+	throw JAVA_RUNTIME_ERR_VA(text, line, column, "Class '%s' doesn't have static field '%s'.", this->name.c_str(), text.c_str());
 }
\ No newline at end of file
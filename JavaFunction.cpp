@@ -1,5 +1,8 @@
 #include "JavaFunction.h"
 #include "Error.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Optimizer.h"
 #include <assert.h>
 
 #if defined(_DEBUG) && (defined(_WIN32) || defined(_WIN64))
@@ -10,13 +13,9 @@
 	#define DBG_new new
 #endif
 
-CallableType JavaFunction::get_type() {
-	return CallableType::UserDefined;
-}
-
 JavaFunction *JavaFunction::bind(JavaInstance *instance) {
 	Environment* env = DBG_new Environment(closure);
-	env->define("this", 0, 0, JavaType::Instance, JavaVariable{
+	env->define(SYMBOL_THIS, 0, 0, JavaType::Instance, JavaVariable{
 		.object = {
 			JavaType::Instance,
 			JavaValue{ .instance = instance },
@@ -30,25 +29,32 @@ JavaFunction *JavaFunction::bind(JavaInstance *instance) {
 }
 
 int JavaFunction::arity() {
-	return (int)declaration_params->size();
+	return (int)declaration_params.size();
 }
 
 JavaObject JavaFunction::call(Interpreter* interpreter, uint32_t line, uint32_t column, std::vector<ArgumentInfo> arguments) {
+	if (!declaration->is_body_parsed) {
+		if (!parse_skipped_function_body(interpreter->ast, declaration, interpreter->class_names)) {
+			throw JAVA_RUNTIME_ERR(to_string(), line, column, "Syntax error in the body of the function.");
+		}
+		resolve_function(interpreter->ast, declaration);
+		optimize_function(interpreter, declaration);
+	}
+
 	Environment* previous = interpreter->environment;
-	Environment* environment = DBG_new Environment(this->closure);
+	Environment* environment = DBG_new Environment(this->closure, declaration->slot_count);
 
 	for (int i = 0; i < arity(); i++) {
-		const JavaTypeInfo &decl = declaration_params->at(i).first;
-		const std::string &parameter_name = declaration_params->at(i).second;
+		const JavaTypeInfo &decl = declaration_params.at(i).first;
 
 		const ArgumentInfo &arg = arguments.at(i);
 		JavaVariable argument = { arg.object, Visibility::Local, false, false, false };
 
-		environment->values[parameter_name] = argument;
+		environment->slots[i] = argument;
 	}
 
 	try {
-		interpreter->execute_block(*declaration_body, environment);
+		interpreter->execute_block(declaration->body, environment);
 	}
 	catch (Interpreter::Return retrn) {
 		delete environment;
@@ -69,6 +75,6 @@ JavaObject JavaFunction::call(Interpreter* interpreter, uint32_t line, uint32_t
 
 std::string JavaFunction::to_string() {
 	std::string result("<fn ");
-	result.append(declaration_name).append(">");
+	result.append(symbol_table.name(declaration_name)).append(">");
 	return result;
 }
@@ -3,40 +3,44 @@
 #include "JavaCallable.h"
 #include "JavaInstance.h"
 
-struct JavaFunction : public JavaCallable {
+struct JavaFunction final : public JavaCallable {
+	static constexpr CallableType callable_type = CallableType::UserDefined;
+
 	const JavaType return_type;
-	const std::string declaration_name;
-	const std::vector<std::pair<JavaTypeInfo, std::string>>* declaration_params;
-	const std::vector<Stmt*>* declaration_body;
+	const Symbol declaration_name;
+	const ArenaArray<Parameter> declaration_params;
+	Stmt_Function* const declaration; // The body may not be parsed yet, see JavaFunction::call.
 	Environment* closure;
 
-	JavaFunction(const Stmt_Function* declaration, Environment* p_closure):
-		return_type(declaration->return_type),
-		declaration_name(declaration->name.lexeme),
-		declaration_params(declaration->params),
-		declaration_body(declaration->body),
+	JavaFunction(Stmt_Function* p_declaration, Environment* p_closure):
+		JavaCallable(callable_type),
+		return_type(p_declaration->return_type),
+		declaration_name(p_declaration->name),
+		declaration_params(p_declaration->params),
+		declaration(p_declaration),
 		closure(p_closure)
 	{}
 
 	JavaFunction(JavaFunction* other, Environment* p_closure):
+		JavaCallable(callable_type),
 		return_type(other->return_type),
 		declaration_name(other->declaration_name),
 		declaration_params(other->declaration_params),
-		declaration_body(other->declaration_body),
+		declaration(other->declaration),
 		closure(p_closure)
 	{}
 
-	JavaFunction(const Stmt_Function* declaration):
-		return_type(declaration->return_type),
-		declaration_name(declaration->name.lexeme),
-		declaration_params(declaration->params),
-		declaration_body(declaration->body),
+	JavaFunction(Stmt_Function* p_declaration):
+		JavaCallable(callable_type),
+		return_type(p_declaration->return_type),
+		declaration_name(p_declaration->name),
+		declaration_params(p_declaration->params),
+		declaration(p_declaration),
 		closure(nullptr)
 	{}
 
 
 	JavaFunction *bind(JavaInstance *instance);
-	CallableType get_type() override;
 	int arity() override;
 	JavaObject call(Interpreter* interpreter, uint32_t line, uint32_t column, std::vector<ArgumentInfo> arguments) override;
 	std::string to_string() override;
@@ -15,14 +15,15 @@ JavaInstance::JavaInstance(Interpreter* p_interpreter, JavaClass* p_class_info):
 	interpreter(p_interpreter),
 	class_info(p_class_info)
 {
-	for (const Stmt_Var* vardecl : class_info->attributes) {
+	for (StmtId attribute : class_info->attributes) {
+		const Stmt_Var* vardecl = ast_get<Stmt_Var>(interpreter->ast, attribute);
 		if (vardecl->is_static) continue;
 		assert(vardecl->names.size() == vardecl->initializers.size());
 
 		for (int i = 0; i < vardecl->names.size(); i++) {
-			Expr* initializer = vardecl->initializers.at(i);
-			const Token& name = vardecl->names.at(i);
-			JavaType type = token_type_to_java_type(vardecl->type.type);
+			ExprId initializer = vardecl->initializers.at(i);
+			const VarName& name = vardecl->names.at(i);
+			JavaType type = token_type_to_java_type(vardecl->type);
 			JavaObject value = interpreter->validate_variable(vardecl, type, name, initializer);
 			JavaVariable variable = {
 				.object = value,
@@ -31,21 +32,24 @@ JavaInstance::JavaInstance(Interpreter* p_interpreter, JavaClass* p_class_info):
 				.is_final = vardecl->is_final,
 				.is_uninitialized = false,
 			};
-			auto casted = try_cast(std::string(name.lexeme), name.line, name.column, type, value);
+			const std::string& field_name = symbol_table.name(name.symbol);
+			const SourceSpan& span = ast_span(interpreter->ast, name.span);
+			auto casted = try_cast(field_name, span.line, span.column, type, value);
 			variable.object = casted.first;
 			variable.object.is_null = casted.second;
 
-			if (fields.contains(name.lexeme)) {
-				throw JAVA_RUNTIME_ERROR_VA(name, "In class '%s' the field '%s' is already defined.", this->class_info->name.c_str(), name.lexeme);
+			if (fields.contains(name.symbol)) {
+				throw JAVA_RUNTIME_ERROR_AT_VA(field_name, span, "In class '%s' the field '%s' is already defined.", this->class_info->name.c_str(), field_name.c_str());
 			}
-			fields.insert({ name.lexeme, variable });
+			fields.insert({ name.symbol, variable });
 		}
 	}
-	for (const Stmt_Function* methoddecl : class_info->methods) {
+	for (StmtId method : class_info->methods) {
+		Stmt_Function* methoddecl = ast_get<Stmt_Function>(interpreter->ast, method);
 		if (methoddecl->is_static) continue;
 
 		Environment* env = DBG_new Environment(interpreter->globals);
-		env->define("this", 0, 0, JavaType::Instance, JavaVariable{
+		env->define(SYMBOL_THIS, 0, 0, JavaType::Instance, JavaVariable{
 			.object = {
 				JavaType::Instance,
 				JavaValue{ .instance = this },
@@ -66,22 +70,25 @@ JavaInstance::JavaInstance(Interpreter* p_interpreter, JavaClass* p_class_info):
 			.is_final = true,
 			.is_uninitialized = false,
 		};
-		if (fields.contains(methoddecl->name.lexeme)) {
-			throw JAVA_RUNTIME_ERROR_VA(methoddecl->name, "In class '%s' the method '%s' is already defined.", this->class_info->name.c_str(), methoddecl->name.lexeme);
+		const Symbol method_name = methoddecl->name;
+		if (fields.contains(method_name)) {
+			const std::string& text = symbol_table.name(method_name);
+			throw JAVA_RUNTIME_ERROR_AT_VA(text, ast_span(interpreter->ast, methoddecl->span), "In class '%s' the method '%s' is already defined.", this->class_info->name.c_str(), text.c_str());
 		}
-		fields.insert({std::string(methoddecl->name.lexeme), variable});
+		fields.insert({method_name, variable});
 	}
 }
 
 JavaObject JavaInstance::get(Expr_Get* expr) {
-	return get(expr->name, expr->line, expr->column);
+	const SourceSpan& span = ast_span(interpreter->ast, expr->span);
+	return get(expr->name, span.line, span.column);
 }
 
 static bool is_private_out_of_class(JavaInstance* instance, Visibility visibility) {
 	bool has_this = false;
 	Environment* e;
 	for (e = instance->interpreter->environment; true; e = e->enclosing) {
-		if (e->values.contains("this")) {
+		if (e->values.contains(SYMBOL_THIS)) {
 			has_this = true;
 			break;
 		}
@@ -89,37 +96,43 @@ static bool is_private_out_of_class(JavaInstance* instance, Visibility visibilit
 	}
 
 	if (!has_this) return visibility == Visibility::Private;
-	if (e->values["this"].object.type != JavaType::Instance) return visibility == Visibility::Private;
+	if (e->values[SYMBOL_THIS].object.type != JavaType::Instance) return visibility == Visibility::Private;
 
-	JavaInstance* this_instance = (JavaInstance*)e->values["this"].object.value.instance;
+	JavaInstance* this_instance = (JavaInstance*)e->values[SYMBOL_THIS].object.value.instance;
 	return visibility == Visibility::Private && this_instance->class_info->name != instance->class_info->name;
 }
 
-JavaObject JavaInstance::get(std::string name, uint32_t line, uint32_t column) {
-	if (fields.contains(name)) {
-		if (is_private_out_of_class(this, fields[name].visibility)) {
-			throw JAVA_RUNTIME_ERR_VA(name, line, column, "In class '%s' the field '%s' is private.", class_info->name.c_str(), name.c_str());
+JavaObject JavaInstance::get(Symbol name, uint32_t line, uint32_t column) {
+	auto field = fields.find(name);
+	if (field != fields.end()) {
+		if (is_private_out_of_class(this, field->second.visibility)) {
+			const std::string& text = symbol_table.name(name);
+			throw JAVA_RUNTIME_ERR_VA(text, line, column, "In class '%s' the field '%s' is private.", class_info->name.c_str(), text.c_str());
 		}
-		return fields[name].object;
+		return field->second.object;
 	}
 	if (class_info->static_fields.contains(name)) {
 		return class_info->get(name, line, column);
 	}
-	throw JAVA_RUNTIME_ERR_VA(name, line, column, "Class '%s' doesn't have field '%s'.", class_info->name.c_str(), name.c_str());
+	const std::string& text = symbol_table.name(name);
+	throw JAVA_RUNTIME_ERR_VA(text, line, column, "Class '%s' doesn't have field '%s'.", class_info->name.c_str(), text.c_str());
 }
 
 void JavaInstance::set(Expr_Set* expr, JavaObject value) {
-	set(expr->rhs_name, expr->line, expr->column, value);
+	const SourceSpan& span = ast_span(interpreter->ast, expr->span);
+	set(expr->rhs_name, span.line, span.column, value);
 }
 
-void JavaInstance::set(std::string name, uint32_t line, uint32_t column, JavaObject value) {
-	if (fields.contains(name)) {
-		fields[name].object = value;
+void JavaInstance::set(Symbol name, uint32_t line, uint32_t column, JavaObject value) {
+	auto field = fields.find(name);
+	if (field != fields.end()) {
+		field->second.object = value;
 		return;
 	}
 	if (class_info->static_fields.contains(name)) {
 		class_info->set(name, line, column, value);
 		return;
 	}
-	throw JAVA_RUNTIME_ERR_VA(name, line, column, "Class '%s' doesn't have field '%s'.", class_info->name.c_str(), name.c_str());
+	const std::string& text = symbol_table.name(name);
+	throw JAVA_RUNTIME_ERR_VA(text, line, column, "Class '%s' doesn't have field '%s'.", class_info->name.c_str(), text.c_str());
 }
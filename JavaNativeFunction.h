@@ -8,23 +8,32 @@ typedef std::function<int()> Native_Arity;
 typedef std::function<JavaObject(void*, uint32_t, uint32_t, std::vector<ArgumentInfo>)> Native_Call;
 typedef std::function<std::string()> Native_ToString;
 
-struct JavaNativeFunction : public JavaCallable {
+struct JavaNativeFunction final : public JavaCallable {
+	static constexpr CallableType callable_type = CallableType::Builtin;
+
 	Native_Arity arity_fn;
 	Native_Call call_fn;
 	Native_ToString to_string_fn;
+	// The result only depends on the arguments and the call has no side effects,
+	// so the optimizer can run it ahead of time (see Optimizer.h).
+	bool is_pure;
+	// Type of every result of a pure native, none when it depends on the arguments. Repeated calls
+	// are only shared through a temporary when it's known.
+	JavaType result_type;
 
 	JavaNativeFunction(Native_Arity p_arity_fn,
 					   Native_Call p_call_fn,
-					   Native_ToString p_to_string_fn):
+					   Native_ToString p_to_string_fn,
+					   bool p_is_pure = false,
+					   JavaType p_result_type = JavaType::none):
+		JavaCallable(callable_type),
 		arity_fn(p_arity_fn),
 		call_fn(p_call_fn),
-		to_string_fn(p_to_string_fn)
+		to_string_fn(p_to_string_fn),
+		is_pure(p_is_pure),
+		result_type(p_result_type)
 	{}
 
-	CallableType get_type() {
-		return CallableType::Builtin;
-	}
-
 	int arity() override {
 		return arity_fn();
 	}
@@ -95,6 +95,20 @@ JavaType token_type_to_java_type(TokenType type) {
 	}
 }
 
+TokenType java_type_to_token_type(JavaType type) {
+	switch (type) {
+		case JavaType::_boolean: return TokenType::type_boolean;
+		case JavaType::_byte: return TokenType::type_byte;
+		case JavaType::_char: return TokenType::type_char;
+		case JavaType::_int: return TokenType::type_int;
+		case JavaType::_long: return TokenType::type_long;
+		case JavaType::_float: return TokenType::type_float;
+		case JavaType::_double: return TokenType::type_double;
+		case JavaType::String: return TokenType::type_String;
+		default: return TokenType::type_void;
+	}
+}
+
 const char* java_type_cstring(JavaType type) {
 	switch (type) {
 		case JavaType::_null: return "null";
@@ -170,7 +184,7 @@ void java_object_print(const JavaObject& object) {
 		} break;
 
 		case JavaType::_int: {
-			printf("%ld", object.value._int);
+			printf("%d", object.value._int);
 		} break;
 
 		case JavaType::_long: {
@@ -55,6 +55,8 @@ struct JavaObject {
 
 std::pair<JavaObject, bool> try_cast(const std::string& name, uint32_t line, uint32_t column, JavaType type, JavaObject value);
 JavaType token_type_to_java_type(TokenType type);
+// Keyword of a primitive type, the inverse of token_type_to_java_type for them.
+TokenType java_type_to_token_type(JavaType type);
 const char* java_type_cstring(JavaType type);
 bool is_java_type_number(JavaType type);
 bool is_java_type_primitive(JavaType type);
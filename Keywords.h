@@ -0,0 +1,135 @@
+#pragma once
+
+// Keyword classification through a perfect hash that is generated at compile time.
+// The key of a keyword is made of its length, first and last characters, which are
+// all distinct among the keywords. The multiplier that spreads those keys over the
+// table without collisions is searched by the compiler, so adding a keyword only
+// requires adding it to the list below.
+
+#include <stdint.h>
+#include <string_view>
+
+#include "TokenType.h"
+
+struct Keyword {
+	std::string_view name;
+	TokenType type;
+};
+
+inline constexpr Keyword keywords[] = {
+	{ "true", TokenType::_true },
+	{ "false", TokenType::_false },
+	{ "null", TokenType::_null },
+	{ "if", TokenType::_if },
+	{ "else", TokenType::_else },
+	{ "for", TokenType::_for },
+	{ "while", TokenType::_while },
+	{ "break", TokenType::_break },
+	{ "continue", TokenType::_continue },
+	{ "return", TokenType::_return },
+	{ "public", TokenType::_public },
+	{ "protected", TokenType::_protected },
+	{ "private", TokenType::_private },
+	{ "final", TokenType::_final },
+	{ "static", TokenType::_static },
+	{ "extends", TokenType::extends },
+	{ "abstract", TokenType::_abstract },
+	{ "class", TokenType::_class },
+	{ "sout", TokenType::sout },
+	{ "soutln", TokenType::soutln },
+	{ "super", TokenType::super },
+	{ "this", TokenType::_this },
+	{ "__init__", TokenType::constructor },
+	{ "void", TokenType::type_void },
+	{ "boolean", TokenType::type_boolean },
+	{ "byte", TokenType::type_byte },
+	{ "char", TokenType::type_char },
+	{ "int", TokenType::type_int },
+	{ "long", TokenType::type_long },
+	{ "float", TokenType::type_float },
+	{ "double", TokenType::type_double },
+	{ "String", TokenType::type_String },
+	{ "ArrayList", TokenType::type_ArrayList },
+};
+
+#define KEYWORD_COUNT (sizeof(keywords) / sizeof(keywords[0]))
+#define KEYWORD_TABLE_BITS 8
+#define KEYWORD_TABLE_SIZE (1 << KEYWORD_TABLE_BITS)
+#define KEYWORD_EMPTY_SLOT 0xFF
+
+static_assert(KEYWORD_COUNT < KEYWORD_EMPTY_SLOT, "Keyword indices must fit in a byte.");
+
+constexpr size_t keyword_min_length() {
+	size_t result = keywords[0].name.size();
+	for (const Keyword& keyword : keywords) {
+		if (keyword.name.size() < result) result = keyword.name.size();
+	}
+	return result;
+}
+
+constexpr size_t keyword_max_length() {
+	size_t result = 0;
+	for (const Keyword& keyword : keywords) {
+		if (keyword.name.size() > result) result = keyword.name.size();
+	}
+	return result;
+}
+
+// Expects a name with at least one character.
+constexpr uint32_t keyword_hash(std::string_view name, uint32_t multiplier) {
+	uint32_t key = (uint32_t)name.size() << 16 | (uint32_t)(uint8_t)name.front() << 8 | (uint32_t)(uint8_t)name.back();
+	return (key * multiplier) >> (32 - KEYWORD_TABLE_BITS);
+}
+
+constexpr bool keyword_multiplier_is_perfect(uint32_t multiplier) {
+	bool used[KEYWORD_TABLE_SIZE] = {};
+	for (const Keyword& keyword : keywords) {
+		uint32_t slot = keyword_hash(keyword.name, multiplier);
+		if (used[slot]) return false;
+		used[slot] = true;
+	}
+	return true;
+}
+
+constexpr uint32_t keyword_find_multiplier() {
+	// Odd multipliers only, starting from the golden ratio constant.
+	for (uint32_t multiplier = 0x9E3779B1; multiplier != 0x9E3779B1 - 2; multiplier += 2) {
+		if (keyword_multiplier_is_perfect(multiplier)) return multiplier;
+	}
+	return 0;
+}
+
+struct KeywordTable {
+	uint32_t multiplier;
+	size_t min_length, max_length;
+	uint8_t slots[KEYWORD_TABLE_SIZE];
+};
+
+constexpr KeywordTable keyword_make_table() {
+	KeywordTable table = { keyword_find_multiplier(), keyword_min_length(), keyword_max_length(), {} };
+	for (uint8_t& slot : table.slots) slot = KEYWORD_EMPTY_SLOT;
+	for (size_t i = 0; i < KEYWORD_COUNT; i++) {
+		table.slots[keyword_hash(keywords[i].name, table.multiplier)] = (uint8_t)i;
+	}
+	return table;
+}
+
+inline constexpr KeywordTable keyword_table = keyword_make_table();
+
+static_assert(keyword_table.multiplier != 0, "Couldn't find a perfect hash for the keywords.");
+
+// Returns TokenType::identifier when the name isn't a keyword.
+constexpr TokenType keyword_lookup(std::string_view name) {
+	if (name.size() < keyword_table.min_length || name.size() > keyword_table.max_length) {
+		return TokenType::identifier;
+	}
+	uint8_t index = keyword_table.slots[keyword_hash(name, keyword_table.multiplier)];
+	if (index == KEYWORD_EMPTY_SLOT || keywords[index].name != name) {
+		return TokenType::identifier;
+	}
+	return keywords[index].type;
+}
+
+static_assert(keyword_lookup("ArrayList") == TokenType::type_ArrayList);
+static_assert(keyword_lookup("__init__") == TokenType::constructor);
+static_assert(keyword_lookup("interface") == TokenType::identifier);
@@ -1,6 +1,12 @@
 #include "Lexer.h"
+#include "Keywords.h"
+#include "LexerSimd.h"
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <charconv>
 #include <unordered_map>
 #include <string>
 #include <string_view>
@@ -10,42 +16,63 @@
 	#include <crtdbg.h>
 #endif
 
-Lexer::Lexer(char* src, uint64_t len): source({ src, len })
+Lexer::Lexer(const char* src, uint64_t len): source({ src, len })
 {
+	tokens.source = src;
+}
+
+Lexer::Lexer(const char* src, uint64_t len, uint32_t p_line, uint32_t p_column, Arena* p_strings_arena):
+	source({ src, len }), strings_arena(p_strings_arena), line(p_line), column(p_column)
+{
+	tokens.source = src;
 }
 
 Lexer::~Lexer() {
-	for (auto& token : tokens) {
-		if (token.lexeme != NULL && !token.is__init__) {
-			free(token.lexeme);
-			token.lexeme = NULL;
-		}
+	for (char* string : strings) {
+		free(string);
 	}
 }
 
 void Lexer::print_tokens() {
 	printf("Tokens: { ");
-	for (const Token& token : tokens) {
-		printf("(%s", get_token_type_name(token.type));
-		if (token.lexeme != NULL) printf(" \"%s\"", token.lexeme);
-		switch (token.literal.type) {
-			case JavaType::_long: printf(" %lld", token.literal.value._long); break;
-			case JavaType::_double: printf(" %f", token.literal.value._double); break;
+	for (uint32_t i = 0; i < tokens.size(); i++) {
+		std::string_view lexeme = tokens.lexeme(i);
+		printf("(%s", get_token_type_name(tokens.type(i)));
+		if (!lexeme.empty()) printf(" \"%.*s\"", (int)lexeme.size(), lexeme.data());
+		JavaObject literal = tokens.literal(i);
+		switch (literal.type) {
+			case JavaType::_int: printf(" %d", literal.value._int); break;
+			case JavaType::_long: printf(" %lld", literal.value._long); break;
+			case JavaType::_float: printf(" %f", literal.value._float); break;
+			case JavaType::_double: printf(" %f", literal.value._double); break;
+			default: break;
 		}
 		printf(") ");
 	}
 	printf("}\n");
 }
 
-std::vector<Token>& Lexer::scan() { 
-	while (current < source.len) {
+TokenStore& Lexer::scan() {
+	Token token;
+	do {
+		token = next();
+		tokens.push(token);
+	} while (token.type != TokenType::eof);
+	return tokens;
+}
+
+Token Lexer::next() {
+	has_scanned = false;
+	while (!has_scanned) {
+		advance_lines_to(simd_skip_whitespace(source.bytes, current, source.len));
 		start = current;
+		if (is_at_end()) {
+			add_token(TokenType::eof, JavaType::none, {0});
+			break;
+		}
 		scan_token();
 	}
-	start = current;
-
-	add_token(TokenType::eof, JavaType::none, {0});
-	return tokens;
+	return scanned;
 }
 
 void Lexer::scan_token() {
@@ -63,6 +90,7 @@ void Lexer::scan_token() {
 		case '^': add_token(TokenType::bitwise_xor); break;
 		case '~': add_token(TokenType::bitwise_not); break;
 		case ',': add_token(TokenType::comma); break;
+		case '@': add_token(TokenType::at); break;
 		case '.': {
 			if (is_digit(peek()))
 				JavaError::error(line, column, "There must be a number before the dot in the double or float literal.");
@@ -103,7 +131,7 @@ void Lexer::scan_token() {
 		case '/': {
 			if (match('/')) {
 				// ignore single line comment.
-				while (peek() != '\n' && !is_at_end()) advance();
+				advance_to(simd_find_byte(source.bytes, current, source.len, '\n'));
 			}
 			else if (match('*')) {
 				scan_multiline_comment();
@@ -138,56 +166,140 @@ void Lexer::scan_token() {
 }
 
 void Lexer::scan_identifier() {
-	while (is_alpha_numeric(peek())) advance();
+	advance_to(simd_skip_identifier(source.bytes, current, source.len));
 
-	std::string name(&source.bytes[start], current - start);
-	name.append("\0");
-
-	TokenType type = keywords.contains(name) ? keywords.at(name) : TokenType::identifier;
+	std::string_view name(&source.bytes[start], current - start);
+	TokenType type = keyword_lookup(name);
 	add_token(type);
+	if (type == TokenType::identifier || type == TokenType::_this || type == TokenType::constructor) {
+		scanned.symbol = symbol_table.intern(name);
+	}
+}
+
+static inline bool is_radix_digit(char c, int radix) {
+	switch (radix) {
+		case 2: return c == '0' || c == '1';
+		case 16: return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+		default: return c >= '0' && c <= '9';
+	}
+}
+
+// Copies the digits of a number literal without its underscores. Fails when an underscore
+// isn't between two digits, or when the digits don't fit in the buffer.
+static bool strip_underscores(std::string_view digits, int radix, char* buffer, size_t capacity, std::string_view* result) {
+	size_t length = 0;
+	for (size_t i = 0; i < digits.size(); i++) {
+		if (digits[i] == '_') {
+			if (i == 0 || i + 1 == digits.size()) return false;
+			if (!is_radix_digit(digits[i - 1], radix) && digits[i - 1] != '_') return false;
+			if (!is_radix_digit(digits[i + 1], radix) && digits[i + 1] != '_') return false;
+			continue;
+		}
+		if (length == capacity) return false;
+		buffer[length++] = digits[i];
+	}
+	*result = std::string_view(buffer, length);
+	return true;
+}
+
+// Consumes the digits of the given radix, and the underscores between them.
+inline void Lexer::scan_digits(int radix) {
+	while (true) {
+		if (radix == 10) advance_to(simd_skip_digits(source.bytes, current, source.len));
+		else while (is_radix_digit(peek(), radix)) advance();
+
+		if (peek() != '_') return;
+		while (peek() == '_') advance();
+	}
 }
 
 void Lexer::scan_number_literal() {
-	enum class Number_Type : uint8_t { _long, _double, _float };
-	Number_Type number_type = Number_Type::_long;
+	int radix = 10;
+	if (source.bytes[start] == '0' && (peek() == 'x' || peek() == 'X')) radix = 16;
+	if (source.bytes[start] == '0' && (peek() == 'b' || peek() == 'B')) radix = 2;
 
-	while (is_digit(peek())) advance();
+	JavaType type = JavaType::_int;
+	uint64_t digits_start = start;
 
-	if (peek() == '.' && is_digit(peek_next())) {
-		number_type = Number_Type::_double;
+	if (radix != 10) {
 		advance();
-		while (!is_at_end() && is_digit(peek())) {
-			if (peek_next() == 'f') {
-				number_type = Number_Type::_float;
-				advance();
-			}
-			advance();
+		digits_start = current;
+		scan_digits(radix);
+		if (current == digits_start) {
+			JavaError::error(line, column, "There must be digits after the '0%c' prefix of the number literal.", peek_prev());
+			add_token(TokenType::number, type, JavaValue{0});
+			return;
 		}
 	}
-	else if (peek() == '.' && peek_next() == 'f') {
-		JavaError::error(line, column, "There must be a number between the dot and the 'f' in the float literal.");
+	else {
+		scan_digits(10);
+		if (peek() == '.' && is_digit(peek_next())) {
+			type = JavaType::_double;
+			advance();
+			scan_digits(10);
+		}
+		else if (peek() == '.' && peek_next() == 'f') {
+			JavaError::error(line, column, "There must be a number between the dot and the 'f' in the float literal.");
+		}
+		else if (peek() == '.' && !is_digit(peek_next())) {
+			JavaError::error(line, column, "There must be a number after the dot in the double literal.");
+		}
 	}
-	else if (peek() == '.' && !is_digit(peek_next())) {
-		JavaError::error(line, column, "There must be a number after the dot in the double literal.");
+
+	uint64_t digits_end = current;
+	switch (peek()) {
+		case 'L': case 'l': if (type == JavaType::_int) { type = JavaType::_long; advance(); } break;
+		case 'F': case 'f': if (radix == 10) { type = JavaType::_float; advance(); } break;
+		case 'D': case 'd': if (radix == 10) { type = JavaType::_double; advance(); } break;
 	}
 
-	std::string name(&source.bytes[start], current - start);
-	name.append("\0");
+	std::string_view digits(&source.bytes[digits_start], digits_end - digits_start);
+	char buffer[NUMBER_LITERAL_MAX_DIGITS];
+	bool has_underscores = digits.find('_') != std::string_view::npos;
+	if (has_underscores && digits.size() - std::count(digits.begin(), digits.end(), '_') > sizeof(buffer)) {
+		JavaError::error(line, column, "The number literal is too long, it can have at most %d digits.", NUMBER_LITERAL_MAX_DIGITS);
+		add_token(TokenType::number, type, JavaValue{0});
+		return;
+	}
+	if (has_underscores && !strip_underscores(digits, radix, buffer, sizeof(buffer), &digits)) {
+		JavaError::error(line, column, "Underscores in a number literal must be between digits.");
+		add_token(TokenType::number, type, JavaValue{0});
+		return;
+	}
 
+	const char* first = digits.data();
+	const char* last = first + digits.size();
+	std::from_chars_result result = {};
 	JavaValue value = {};
 
-	#define case_number(T, strconv_fn)                         \
-		case Number_Type::T: {                                 \
-			value.T = (Java##T)strconv_fn(name.c_str());       \
-			add_token(TokenType::number, JavaType::T, value);  \
+	// Hex and binary literals can set the sign bit, like in Java, so integers are parsed unsigned.
+	// 2147483648 and 9223372036854775808L become the minimum value of their type, the parser only
+	// accepts them right after a minus (see Parser::unary).
+	switch (type) {
+		case JavaType::_int: {
+			uint32_t bits = 0;
+			result = std::from_chars(first, last, bits, radix);
+			if (radix == 10 && bits > (uint32_t)INT32_MAX + 1) result.ec = std::errc::result_out_of_range;
+			value._int = (Java_int)bits;
+		} break;
+		case JavaType::_long: {
+			uint64_t bits = 0;
+			result = std::from_chars(first, last, bits, radix);
+			if (radix == 10 && bits > (uint64_t)INT64_MAX + 1) result.ec = std::errc::result_out_of_range;
+			value._long = (Java_long)bits;
 		} break;
+		case JavaType::_float: result = std::from_chars(first, last, value._float); break;
+		case JavaType::_double: result = std::from_chars(first, last, value._double); break;
+		default: assert(false && "Not a number literal type");
+	}
 
-	switch (number_type) {
-		case_number(_long, atoll)
-		case_number(_float, atof)
-		case_number(_double, atof)
+	if (result.ec == std::errc::result_out_of_range) {
+		JavaError::error(line, column, "The number literal '%.*s' is out of range for type '%s'.", (int)(current - start), &source.bytes[start], java_type_cstring(type));
+	}
+	else {
+		assert(result.ec == std::errc() && result.ptr == last);
 	}
-	#undef case_number
+	add_token(TokenType::number, type, value);
 }
 
 void Lexer::scan_string_literal() {
@@ -265,46 +377,84 @@ void Lexer::scan_char_literal() {
 inline void Lexer::scan_multiline_comment() {
 	uint32_t nested_count = 1;
 
-	for (;; advance()) {
-		if (peek() == '\n') {
-			column = 1;
-			line++;
-			continue;
+	while (nested_count != 0) {
+		// Only a '*' or a '/' can open or close a comment, everything in between is skipped.
+		uint64_t next = simd_find_either(source.bytes, current, source.len, '*', '/');
+		if (next + 1 >= source.len) {
+			advance_lines_to(source.len);
+			JavaError::error(line, column, "Unterminated multiline comment.");
+			return;
 		}
+		advance_lines_to(next);
+
 		if (peek() == '/' && peek_next() == '*') {
 			nested_count++;
+			advance();
 		}
-		if (peek() == '*' && peek_next() == '/') {
+		else if (peek() == '*' && peek_next() == '/') {
 			nested_count--;
+			advance();
 		}
-		if (nested_count == 0) {
-			advance(); advance();
-			break;
-		}
+		advance();
 	}
 }
 
 inline void Lexer::add_token(TokenType type) {
-	char* lexeme = source.bytes + start;
-	size_t lexeme_len = current - start;
-	tokens.emplace_back(Token{ type, lexeme, lexeme_len, line, column - 1, JavaObject{JavaType::none, JavaValue{0}} });
+	std::string_view lexeme(source.bytes + start, current - start);
+	scanned = Token{ type, lexeme, line, column - 1, JavaObject{JavaType::none, JavaValue{0}} };
+	has_scanned = true;
 }
 
 inline void Lexer::add_token(TokenType type, JavaType jtype, JavaValue jvalue) {
-	char* lexeme = source.bytes + start;
-	size_t lexeme_len = current - start;
-	tokens.emplace_back(Token{ type, lexeme, lexeme_len, line, column - 1, JavaObject{jtype, jvalue} });
+	std::string_view lexeme(source.bytes + start, current - start);
+	scanned = Token{ type, lexeme, line, column - 1, JavaObject{jtype, jvalue} };
+	has_scanned = true;
 }
 
 inline void Lexer::add_string_token() {
-	char* lexeme = source.bytes + start + 1;
-	size_t lexeme_len = current - start - 2;
-	tokens.emplace_back(Token{ TokenType::string, lexeme, lexeme_len, line, column - 1, JavaObject{JavaType::String, JavaValue{}} });
-	Token &last = tokens.at(tokens.size() - 1);
-	last.literal.value.String = last.lexeme;
+	std::string_view lexeme(source.bytes + start + 1, current - start - 2);
+
+	// The value of the literal outlives the token, so it gets its own null terminated copy.
+	char* string;
+	if (strings_arena != nullptr) {
+		string = (char*)arena_alloc_align(strings_arena, lexeme.size() + 1, 1);
+	}
+	else {
+		string = (char*)malloc((lexeme.size() + 1) * sizeof(char));
+		assert(string != NULL);
+		strings.push_back(string);
+	}
+	memcpy(string, lexeme.data(), lexeme.size());
+	string[lexeme.size()] = '\0';
+
+	JavaValue value = {};
+	value.String = string;
+	scanned = Token{ TokenType::string, lexeme, line, column - 1, JavaObject{JavaType::String, value} };
+	has_scanned = true;
+}
+
+// Skips to the end of a run that is known to have no newlines.
+inline void Lexer::advance_to(uint64_t end) {
+	column += (uint32_t)(end - current);
+	current = end;
+}
+
+// Skips to the end of a run, counting its newlines to find out the line and column.
+inline void Lexer::advance_lines_to(uint64_t end) {
+	uint64_t last_newline = 0;
+	uint32_t newlines = simd_count_newlines(source.bytes, current, end, &last_newline);
+	if (newlines == 0) {
+		column += (uint32_t)(end - current);
+	}
+	else {
+		line += newlines;
+		column = (uint32_t)(end - last_newline);
+	}
+	current = end;
 }
 
 inline char Lexer::advance() {
+	if (is_at_end()) return '\0';
 	char c = source.bytes[current];
 	column++; current++;
 	return c;
@@ -318,7 +468,8 @@ inline bool Lexer::match(char next) {
 }
 
 inline char Lexer::peek() {
-	assert(current >= 0 && current < source.len);
+	// The source might be a read-only mapping that ends right at a page boundary.
+	if (is_at_end()) return '\0';
 	return source.bytes[current];
 }
 
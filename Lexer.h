@@ -2,71 +2,45 @@
 
 #include <stdint.h>
 #include <vector>
-#include <unordered_map>
-#include <string_view>
 
 #include "Token.h"
+#include "TokenStore.h"
 #include "Error.h"
+#include "Arena.h"
+
+// Longest number literal with underscores, they are copied without them before being converted.
+#define NUMBER_LITERAL_MAX_DIGITS 128
 
 struct big_string_view {
-	char* bytes;
+	const char* bytes;
 	uint64_t len;
 };
 
 class Lexer {
 public:
-	Lexer(char* src, uint64_t len);
+	Lexer(const char* src, uint64_t len);
+	// Lexes a piece of a bigger source, starting at the given position. The string literals are
+	// copied to the arena instead, so they outlive the lexer.
+	Lexer(const char* src, uint64_t len, uint32_t p_line, uint32_t p_column, Arena* p_strings_arena);
 	~Lexer();
 
 	void print_tokens();
-	std::vector<Token>& scan();
+	TokenStore& scan();
+	Token next();
 
 private:
-	const std::unordered_map<std::string_view, TokenType> keywords = {
-		{ "true", TokenType::_true },
-		{ "false", TokenType::_false },
-		{ "null", TokenType::_null },
-		{ "if", TokenType::_if },
-		{ "else", TokenType::_else },
-		{ "for", TokenType::_for },
-		{ "while", TokenType::_while },
-		{ "break", TokenType::_break },
-		{ "continue", TokenType::_continue },
-		{ "return", TokenType::_return },
-		{ "public", TokenType::_public },
-		{ "protected", TokenType::_protected },
-		{ "private", TokenType::_private },
-		{ "final", TokenType::_final },
-		{ "static", TokenType::_static },
-		{ "extends", TokenType::extends },
-		{ "abstract", TokenType::_abstract },
-		{ "class", TokenType::_class },
-		{ "sout", TokenType::sout },
-		{ "soutln", TokenType::soutln },
-		{ "super", TokenType::super },
-		{ "this", TokenType::_this },
-		{ "__init__", TokenType::constructor },
-		{ "void", TokenType::type_void },
-		{ "boolean", TokenType::type_boolean },
-		{ "byte", TokenType::type_byte },
-		{ "char", TokenType::type_char },
-		{ "int", TokenType::type_int },
-		{ "long", TokenType::type_long },
-		{ "float", TokenType::type_float },
-		{ "double", TokenType::type_double },
-		{ "String", TokenType::type_String },
-		{ "ArrayList", TokenType::type_ArrayList },
-	};
-
 	void scan_token();
 	void scan_identifier();
 	void scan_number_literal();
+	inline void scan_digits(int radix);
 	void scan_string_literal();
 	void scan_char_literal();
 	inline void scan_multiline_comment();
 	inline void add_token(TokenType type);
 	inline void add_token(TokenType type, JavaType jtype, JavaValue jvalue);
 	inline void add_string_token();
+	inline void advance_to(uint64_t end);
+	inline void advance_lines_to(uint64_t end);
 	inline char advance();
 	inline bool match(char next);
 	inline char peek();
@@ -79,7 +53,11 @@ private:
 
 private:
 	big_string_view source;
-	std::vector<Token> tokens;
+	TokenStore tokens; // Only filled by scan(), the parser pulls them one at a time with next().
+	Token scanned;
+	bool has_scanned = false;
+	std::vector<char*> strings; // Owned storage of the string literals, freed in the destructor.
+	Arena* strings_arena = nullptr;
 	uint64_t start = 0, current = 0;
 	uint32_t line = 1, column = 1;
 };
@@ -0,0 +1,331 @@
+#include "LexerSimd.h"
+
+#include <bit>
+#include <string.h>
+
+#if defined(_DEBUG) && (defined(_WIN32) || defined(_WIN64))
+	#include <stdlib.h>
+	#include <crtdbg.h>
+#endif
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	#define LEXER_SIMD_X86 1
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+#else
+	#define LEXER_SIMD_X86 0
+#endif
+
+// MSVC lets any function use AVX2 intrinsics, gcc and clang need to be told per function.
+#if defined(_MSC_VER) && !defined(__clang__)
+	#define TARGET_AVX2
+#else
+	#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+typedef uint64_t (*Skip_Fn)(const char* bytes, uint64_t from, uint64_t len);
+
+// ---------------------------------------------------------------------------------------------
+// Scalar
+
+static inline bool is_whitespace(char c) {
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\0';
+}
+
+static inline bool is_digit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+static inline bool is_identifier(char c) {
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || is_digit(c);
+}
+
+static uint64_t scalar_skip_whitespace(const char* bytes, uint64_t from, uint64_t len) {
+	while (from < len && is_whitespace(bytes[from])) from++;
+	return from;
+}
+
+static uint64_t scalar_skip_identifier(const char* bytes, uint64_t from, uint64_t len) {
+	while (from < len && is_identifier(bytes[from])) from++;
+	return from;
+}
+
+static uint64_t scalar_skip_digits(const char* bytes, uint64_t from, uint64_t len) {
+	while (from < len && is_digit(bytes[from])) from++;
+	return from;
+}
+
+static uint64_t scalar_find_byte(const char* bytes, uint64_t from, uint64_t len, char c) {
+	if (from >= len) return len;
+	const char* found = (const char*)memchr(bytes + from, c, len - from);
+	return found != NULL ? (uint64_t)(found - bytes) : len;
+}
+
+static uint64_t scalar_find_either(const char* bytes, uint64_t from, uint64_t len, char a, char b) {
+	while (from < len && bytes[from] != a && bytes[from] != b) from++;
+	return from;
+}
+
+static uint32_t scalar_count_newlines(const char* bytes, uint64_t from, uint64_t to, uint64_t* last_newline) {
+	uint32_t count = 0;
+	for (uint64_t i = from; i < to; i++) {
+		if (bytes[i] == '\n') {
+			count++;
+			*last_newline = i;
+		}
+	}
+	return count;
+}
+
+#if LEXER_SIMD_X86
+
+// ---------------------------------------------------------------------------------------------
+// SSE2, 16 bytes per block.
+
+static inline __m128i sse2_in_range(__m128i v, char lo, char hi) {
+	return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8(hi + 1)));
+}
+
+static inline uint32_t sse2_whitespace_mask(__m128i v) {
+	__m128i m = _mm_or_si128(
+		_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+		_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+	m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_setzero_si128()));
+	return (uint32_t)_mm_movemask_epi8(m);
+}
+
+static inline uint32_t sse2_digit_mask(__m128i v) {
+	return (uint32_t)_mm_movemask_epi8(sse2_in_range(v, '0', '9'));
+}
+
+static inline uint32_t sse2_identifier_mask(__m128i v) {
+	// Setting the 0x20 bit maps upper case letters to lower case ones, and nothing else into a-z.
+	__m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+	__m128i m = _mm_or_si128(sse2_in_range(lower, 'a', 'z'), sse2_in_range(v, '0', '9'));
+	m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+	return (uint32_t)_mm_movemask_epi8(m);
+}
+
+template <uint32_t (*in_run)(__m128i), Skip_Fn scalar_tail>
+static uint64_t sse2_skip(const char* bytes, uint64_t from, uint64_t len) {
+	for (; from + 16 <= len; from += 16) {
+		uint32_t stop = ~in_run(_mm_loadu_si128((const __m128i*)(bytes + from))) & 0xFFFF;
+		if (stop != 0) return from + std::countr_zero(stop);
+	}
+	return scalar_tail(bytes, from, len);
+}
+
+static uint64_t sse2_find_byte(const char* bytes, uint64_t from, uint64_t len, char c) {
+	__m128i needle = _mm_set1_epi8(c);
+	for (; from + 16 <= len; from += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(bytes + from));
+		uint32_t hit = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+		if (hit != 0) return from + std::countr_zero(hit);
+	}
+	return scalar_find_byte(bytes, from, len, c);
+}
+
+static uint64_t sse2_find_either(const char* bytes, uint64_t from, uint64_t len, char a, char b) {
+	__m128i needle_a = _mm_set1_epi8(a);
+	__m128i needle_b = _mm_set1_epi8(b);
+	for (; from + 16 <= len; from += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(bytes + from));
+		__m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, needle_a), _mm_cmpeq_epi8(v, needle_b));
+		uint32_t hit = (uint32_t)_mm_movemask_epi8(m);
+		if (hit != 0) return from + std::countr_zero(hit);
+	}
+	return scalar_find_either(bytes, from, len, a, b);
+}
+
+static uint32_t sse2_count_newlines(const char* bytes, uint64_t from, uint64_t to, uint64_t* last_newline) {
+	__m128i newline = _mm_set1_epi8('\n');
+	uint32_t count = 0;
+	for (; from + 16 <= to; from += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(bytes + from));
+		uint32_t hit = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline));
+		if (hit != 0) {
+			count += std::popcount(hit);
+			*last_newline = from + std::bit_width(hit) - 1;
+		}
+	}
+	return count + scalar_count_newlines(bytes, from, to, last_newline);
+}
+
+// ---------------------------------------------------------------------------------------------
+// AVX2, 32 bytes per block. What is left after the last whole block goes through SSE2.
+
+TARGET_AVX2 static inline __m256i avx2_in_range(__m256i v, char lo, char hi) {
+	return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+}
+
+TARGET_AVX2 static inline uint32_t avx2_whitespace_mask(__m256i v) {
+	__m256i m = _mm256_or_si256(
+		_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+		_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+	m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+	return (uint32_t)_mm256_movemask_epi8(m);
+}
+
+TARGET_AVX2 static inline uint32_t avx2_digit_mask(__m256i v) {
+	return (uint32_t)_mm256_movemask_epi8(avx2_in_range(v, '0', '9'));
+}
+
+TARGET_AVX2 static inline uint32_t avx2_identifier_mask(__m256i v) {
+	__m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+	__m256i m = _mm256_or_si256(avx2_in_range(lower, 'a', 'z'), avx2_in_range(v, '0', '9'));
+	m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+	return (uint32_t)_mm256_movemask_epi8(m);
+}
+
+template <uint32_t (*in_run)(__m256i), Skip_Fn sse2_tail>
+TARGET_AVX2 static uint64_t avx2_skip(const char* bytes, uint64_t from, uint64_t len) {
+	for (; from + 32 <= len; from += 32) {
+		uint32_t stop = ~in_run(_mm256_loadu_si256((const __m256i*)(bytes + from)));
+		if (stop != 0) return from + std::countr_zero(stop);
+	}
+	return sse2_tail(bytes, from, len);
+}
+
+TARGET_AVX2 static uint64_t avx2_find_byte(const char* bytes, uint64_t from, uint64_t len, char c) {
+	__m256i needle = _mm256_set1_epi8(c);
+	for (; from + 32 <= len; from += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)(bytes + from));
+		uint32_t hit = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle));
+		if (hit != 0) return from + std::countr_zero(hit);
+	}
+	return sse2_find_byte(bytes, from, len, c);
+}
+
+TARGET_AVX2 static uint64_t avx2_find_either(const char* bytes, uint64_t from, uint64_t len, char a, char b) {
+	__m256i needle_a = _mm256_set1_epi8(a);
+	__m256i needle_b = _mm256_set1_epi8(b);
+	for (; from + 32 <= len; from += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)(bytes + from));
+		__m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, needle_a), _mm256_cmpeq_epi8(v, needle_b));
+		uint32_t hit = (uint32_t)_mm256_movemask_epi8(m);
+		if (hit != 0) return from + std::countr_zero(hit);
+	}
+	return sse2_find_either(bytes, from, len, a, b);
+}
+
+TARGET_AVX2 static uint32_t avx2_count_newlines(const char* bytes, uint64_t from, uint64_t to, uint64_t* last_newline) {
+	__m256i newline = _mm256_set1_epi8('\n');
+	uint32_t count = 0;
+	for (; from + 32 <= to; from += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)(bytes + from));
+		uint32_t hit = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, newline));
+		if (hit != 0) {
+			count += std::popcount(hit);
+			*last_newline = from + std::bit_width(hit) - 1;
+		}
+	}
+	return count + sse2_count_newlines(bytes, from, to, last_newline);
+}
+
+static bool cpu_has_avx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4] = {0};
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+
+	// The os must also save the ymm registers on context switches.
+	__cpuid(info, 1);
+	bool has_osxsave = (info[2] & (1 << 27)) != 0;
+	bool has_avx = (info[2] & (1 << 28)) != 0;
+	if (!has_osxsave || !has_avx) return false;
+	if ((_xgetbv(0) & 0x6) != 0x6) return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // LEXER_SIMD_X86
+
+// ---------------------------------------------------------------------------------------------
+// Dispatch
+
+struct SimdBackend {
+	const char* name;
+	Skip_Fn skip_whitespace;
+	Skip_Fn skip_identifier;
+	Skip_Fn skip_digits;
+	uint64_t (*find_byte)(const char*, uint64_t, uint64_t, char);
+	uint64_t (*find_either)(const char*, uint64_t, uint64_t, char, char);
+	uint32_t (*count_newlines)(const char*, uint64_t, uint64_t, uint64_t*);
+};
+
+static const SimdBackend scalar_backend = {
+	"scalar",
+	scalar_skip_whitespace,
+	scalar_skip_identifier,
+	scalar_skip_digits,
+	scalar_find_byte,
+	scalar_find_either,
+	scalar_count_newlines,
+};
+
+#if LEXER_SIMD_X86
+static const SimdBackend sse2_backend = {
+	"sse2",
+	sse2_skip<sse2_whitespace_mask, scalar_skip_whitespace>,
+	sse2_skip<sse2_identifier_mask, scalar_skip_identifier>,
+	sse2_skip<sse2_digit_mask, scalar_skip_digits>,
+	sse2_find_byte,
+	sse2_find_either,
+	sse2_count_newlines,
+};
+
+static const SimdBackend avx2_backend = {
+	"avx2",
+	avx2_skip<avx2_whitespace_mask, sse2_skip<sse2_whitespace_mask, scalar_skip_whitespace>>,
+	avx2_skip<avx2_identifier_mask, sse2_skip<sse2_identifier_mask, scalar_skip_identifier>>,
+	avx2_skip<avx2_digit_mask, sse2_skip<sse2_digit_mask, scalar_skip_digits>>,
+	avx2_find_byte,
+	avx2_find_either,
+	avx2_count_newlines,
+};
+#endif
+
+static const SimdBackend* simd_select_backend() {
+#if LEXER_SIMD_X86
+	if (cpu_has_avx2()) return &avx2_backend;
+	return &sse2_backend;
+#else
+	return &scalar_backend;
+#endif
+}
+
+static const SimdBackend* backend = simd_select_backend();
+
+uint64_t simd_skip_whitespace(const char* bytes, uint64_t from, uint64_t len) {
+	return backend->skip_whitespace(bytes, from, len);
+}
+
+uint64_t simd_skip_identifier(const char* bytes, uint64_t from, uint64_t len) {
+	return backend->skip_identifier(bytes, from, len);
+}
+
+uint64_t simd_skip_digits(const char* bytes, uint64_t from, uint64_t len) {
+	return backend->skip_digits(bytes, from, len);
+}
+
+uint64_t simd_find_byte(const char* bytes, uint64_t from, uint64_t len, char c) {
+	return backend->find_byte(bytes, from, len, c);
+}
+
+uint64_t simd_find_either(const char* bytes, uint64_t from, uint64_t len, char a, char b) {
+	return backend->find_either(bytes, from, len, a, b);
+}
+
+uint32_t simd_count_newlines(const char* bytes, uint64_t from, uint64_t to, uint64_t* last_newline) {
+	return backend->count_newlines(bytes, from, to, last_newline);
+}
+
+const char* simd_backend_name() {
+	return backend->name;
+}
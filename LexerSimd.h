@@ -0,0 +1,21 @@
+#pragma once
+
+// Fast paths used by the Lexer to consume runs of bytes a block at a time.
+// There are SSE2 and AVX2 versions, and a scalar fallback for everything else.
+// The best version supported by the cpu is picked the first time one is called.
+//
+// Every function looks at the bytes in [from, len) and returns the offset of the first
+// byte that ends the run, or len if the run reaches the end of the source.
+
+#include <stdint.h>
+
+uint64_t simd_skip_whitespace(const char* bytes, uint64_t from, uint64_t len);
+uint64_t simd_skip_identifier(const char* bytes, uint64_t from, uint64_t len);
+uint64_t simd_skip_digits(const char* bytes, uint64_t from, uint64_t len);
+uint64_t simd_find_byte(const char* bytes, uint64_t from, uint64_t len, char c);
+uint64_t simd_find_either(const char* bytes, uint64_t from, uint64_t len, char a, char b);
+
+// Counts the newlines in [from, to). When there is at least one, the offset of the last one is written to last_newline.
+uint32_t simd_count_newlines(const char* bytes, uint64_t from, uint64_t to, uint64_t* last_newline);
+
+const char* simd_backend_name();
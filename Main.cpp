@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <assert.h>
 #include <string>
 #include <memory>
@@ -14,16 +15,42 @@
 #include "Parser.h"
 #include "Interpreter.h"
 #include "Color.h"
+#include "SourceFile.h"
+#include "Benchmark.h"
+#include "ProgramCache.h"
+#include "Resolver.h"
+#include "Optimizer.h"
 
 namespace JavaError {
 	bool had_error;
 	bool had_runtime_error;
+	bool is_silenced;
 };
 
 bool REPL = false;
 
-static void run_file(char *name);
+enum class CacheMode {
+	use,
+	disable,
+	clear,
+};
+
+struct RunOptions {
+	CacheMode cache_mode = CacheMode::use;
+	// Parses every function body up front, so the syntax errors in functions that never run are reported too.
+	bool is_eager = false;
+	// Parses and runs one top level statement at a time, instead of parsing the whole file first.
+	bool is_streaming = false;
+	// Prints the program as the optimizer left it and how many dead nodes it removed, instead of running it.
+	bool is_dumping_optimized_ast = false;
+	// Most nodes the body of a function can have to be inlined at its calls, 0 turns inlining off.
+	uint32_t inline_budget = INLINE_DEFAULT_BUDGET;
+};
+
+static void run_file(char *name, const RunOptions& options);
 static void run_repl();
+static void print_usage();
+static bool parse_inline_budget(const char* text, uint32_t* budget);
 
 int main(int argc, char** argv) {
 	JavaError::had_error = false;
@@ -31,61 +58,190 @@ int main(int argc, char** argv) {
 
 	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
 
-	if (argc - 1 > 1) {
-		printf("Usage: javaclone <file>");
-		return 1;
+	if (argc - 1 >= 1 && strcmp(argv[1], "--bench") == 0) {
+		return run_benchmark(argc - 2, argv + 2);
+	}
+
+	RunOptions options = {};
+	int arg = 1;
+	for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; arg++) {
+		if (strcmp(argv[arg], "--no-cache") == 0) options.cache_mode = CacheMode::disable;
+		else if (strcmp(argv[arg], "--clear-cache") == 0) options.cache_mode = CacheMode::clear;
+		else if (strcmp(argv[arg], "--eager") == 0) options.is_eager = true;
+		else if (strcmp(argv[arg], "--stream") == 0) options.is_streaming = true;
+		else if (strcmp(argv[arg], "--dump-optimized-ast") == 0) options.is_dumping_optimized_ast = true;
+		else if (strncmp(argv[arg], "--inline-budget=", 16) == 0) {
+			if (!parse_inline_budget(argv[arg] + 16, &options.inline_budget)) {
+				print_usage();
+				return 1;
+			}
+		}
+		else break;
+	}
+
+	// The whole program is dumped, bodies included, as it comes out of the parser and the optimizer.
+	if (options.is_dumping_optimized_ast) {
+		options.is_eager = true;
+		options.is_streaming = false;
+		if (options.cache_mode == CacheMode::use) options.cache_mode = CacheMode::disable;
 	}
-	else if (argc - 1 == 1) {
-		run_file(argv[1]);
+	// The cached program was inlined with the default budget.
+	if (options.inline_budget != INLINE_DEFAULT_BUDGET && options.cache_mode == CacheMode::use) {
+		options.cache_mode = CacheMode::disable;
 	}
-	else {
+
+	if (argc == 1) {
 		REPL = true;
 		run_repl();
 	}
+	else if (arg == argc - 1) {
+		run_file(argv[arg], options);
+	}
+	else {
+		print_usage();
+		return 1;
+	}
 	
 	_CrtSetReportMode(_CRT_WARN, _CRTDBG_MODE_DEBUG);
 	_CrtDumpMemoryLeaks();
 	return 0;
 }
 
-static void run_file(char *name) {
-	printf("Running file: %s\n", name);
+static void print_usage() {
+	printf("Usage: javaclone [--no-cache | --clear-cache] [--eager] [--stream] [--dump-optimized-ast] [--inline-budget=N] <file>\n       javaclone --bench [options]");
+}
 
-	FILE* file = fopen(name, "r");
-	assert(file != NULL);
+// Only plain decimal digits that fit in 32 bits, strtoul alone would read a typo as 0.
+static bool parse_inline_budget(const char* text, uint32_t* budget) {
+	if (*text < '0' || *text > '9') return false;
+	char* end = nullptr;
+	unsigned long long value = strtoull(text, &end, 10);
+	if (*end != '\0' || value > UINT32_MAX) return false;
+	*budget = (uint32_t)value;
+	return true;
+}
+
+// The nodes of a statement are dropped after it runs, so memory doesn't grow with the file.
+// They are kept when the statement declares a function or a class, or when running it added
+// nodes, like the bodies of functions parsed on their first call.
+static void stream_statements(Interpreter* interpreter, Ast* ast, Lexer& lexer, const RunOptions& options) {
+	Parser parser(lexer, ast);
+	parser.skip_function_bodies = !options.is_eager;
 
-	fseek(file, 0, SEEK_END);
-	uint64_t len = ftell(file);
-	fseek(file, 0, SEEK_SET);
+	while (true) {
+		AstMark start = ast_mark(ast);
+		StmtId statement = parser.parse_statement();
+
+		if (JavaError::had_error) {
+			exit(1);
+		}
+		if (statement == STMT_NONE) break;
+
+		resolve_statement(ast, statement);
+		statement = optimize_statement(interpreter, statement);
+
+		AstMark parsed = ast_mark(ast);
+		const size_t functions = (size_t)StmtType::Function;
+		const size_t classes = (size_t)StmtType::Class;
+		bool is_declaration = parsed.stmts[functions] != start.stmts[functions] || parsed.stmts[classes] != start.stmts[classes];
+		if (parsed.stmts[classes] != start.stmts[classes]) {
+			interpreter->add_class_names(parser.class_names);
+		}
 
-	char* src = (char*)malloc(len * sizeof(char));
-	assert(src != NULL);
-	memset(src, 0, len);
-	fread(src, sizeof(char), len, file);
+		if (statement != STMT_NONE) {
+			interpreter->interpret(StmtList{ &statement, 1 });
+		}
+		if (JavaError::had_runtime_error) break;
 
-	Interpreter interpreter = {};
+		if (!is_declaration && ast_mark_equal(parsed, ast_mark(ast))) {
+			ast_reset(ast, start);
+		}
+	}
+}
 
-	Lexer lexer(src, len);
-	std::vector<Token> &tokens = lexer.scan();
+static void run_file(char *name, const RunOptions& options) {
+	std::string cache_path = program_cache_path(name);
+	if (options.cache_mode == CacheMode::clear) {
+		if (remove(cache_path.c_str()) == 0) printf("Removed cache: %s\n", cache_path.c_str());
+		return;
+	}
 
-	Parser parser(tokens);
-	std::vector<Stmt*>* statements = parser.parse_statements();
+	printf("Running file: %s\n", name);
 
-	if (JavaError::had_error) {
-		parser.statements_free(statements);
+	SourceFile file = {};
+	if (!source_file_open(&file, name)) {
+		printf("Couldn't open file: %s\n", name);
 		exit(1);
 	}
 
-	interpreter.add_class_names(parser.class_names);
-	interpreter.interpret(statements);
-	parser.statements_free(statements);
+	Ast ast = ast_make();
+	Interpreter interpreter(&ast);
+	interpreter.inline_budget = options.inline_budget;
+
+	// Taken before the lexer interns any name of the program.
+	ProgramCacheKey cache_key = program_cache_key(file);
+	ProgramCache cache = {};
+	StmtList statements = {};
+	std::set<Symbol> class_names;
+
+	// The lexer owns the string literals, so it lives as long as the nodes even when it isn't used.
+	Lexer lexer(file.bytes, file.len);
+	if (options.is_streaming) {
+		stream_statements(&interpreter, &ast, lexer, options);
+		ast_free(&ast);
+		source_file_close(&file);
+		return;
+	}
+
+	// An eager run has to check every body, and the cached ones were skipped.
+	bool is_cached = options.cache_mode == CacheMode::use && !options.is_eager &&
+		program_cache_load(&cache, cache_path.c_str(), cache_key, &ast, &statements, &class_names);
+
+	if (!is_cached) {
+		Parser parser(lexer, &ast);
+		parser.skip_function_bodies = !options.is_eager;
+		statements = parser.parse_statements();
+
+		if (JavaError::had_error) {
+			exit(1);
+		}
 
-	free(src);
-	fclose(file);
+		// The cache keeps the nodes as they are, slots and folded constants included. The bodies
+		// the inliner parses ahead need the names of the classes.
+		class_names = parser.class_names;
+		interpreter.add_class_names(class_names);
+		resolve_statements(&ast, statements);
+		optimize_program(&interpreter, statements);
+		if (options.cache_mode == CacheMode::use) {
+			program_cache_save(cache_path.c_str(), cache_key, file, &ast, statements, class_names);
+		}
+	}
+	else {
+		analyze_classes(&interpreter, statements);
+		interpreter.add_class_names(class_names);
+	}
+
+	if (options.is_dumping_optimized_ast) {
+		AstPrinter::print_statements(&ast, statements);
+		printf("Removed %zu dead nodes of %zu.\n", interpreter.removed_nodes, ast_node_count(&ast));
+		printf("Inlined %zu calls.\n", interpreter.inlined_calls);
+	}
+	else {
+		interpreter.interpret(statements);
+	}
+	ast_free(&ast);
+	program_cache_close(&cache);
+
+	source_file_close(&file);
 }
 
 static void run_repl() {
-	Interpreter interpreter = {};
+	// Functions and classes declared on one line are called from the next ones, so every line's
+	// source and nodes go into an Ast that lives as long as the session.
+	Ast ast = ast_make();
+	Interpreter interpreter(&ast);
+	// Every definition is echoed, the parameters of inlined calls would show up as definitions too.
+	interpreter.inline_budget = 0;
 
 	while (true) {
 		JavaError::had_error = false;
@@ -99,24 +255,26 @@ static void run_repl() {
 		size_t len = strlen(prompt);
 		if (len == 1) goto done;
 
-		std::string src(prompt);
+		char* src = (char*)arena_alloc_align(&ast.arena, len + 1, 1);
+		memcpy(src, prompt, len);
 
-		Lexer lexer((char*)src.c_str(), len);
-		std::vector<Token> &tokens = lexer.scan();
-		if (!JavaError::had_error && REPL) lexer.print_tokens();
+		// The whole line is scanned once up front to show its tokens, then it's lexed again as the parser pulls from it.
+		Lexer printed_lexer(src, len);
+		printed_lexer.scan();
+		if (!JavaError::had_error && REPL) printed_lexer.print_tokens();
 
 		if (JavaError::had_error) { continue; }
 
-		Parser parser(tokens);
-		std::vector<Stmt*>* statements = parser.parse_statements();
+		Lexer lexer(src, len);
+		Parser parser(lexer, &ast);
+		StmtList statements = parser.parse_statements();
 
-		if (JavaError::had_error) {
-			parser.statements_free(statements);
-			continue;
-		}
+		if (JavaError::had_error) { continue; }
 
+		resolve_statements(&ast, statements);
+		optimize_statements(&interpreter, statements);
 		interpreter.interpret(statements);
-		parser.statements_free(statements);
 	}
-done:;
+done:
+	ast_free(&ast);
 }
\ No newline at end of file
@@ -0,0 +1,1932 @@
+#include "Optimizer.h"
+#include "Interpreter.h"
+#include "JavaCallable.h"
+#include "JavaFunction.h"
+#include "JavaNativeFunction.h"
+#include "JavaClass.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Error.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_set>
+
+#if defined(_DEBUG) && (defined(_WIN32) || defined(_WIN64))
+	#include <stdlib.h>
+	#include <crtdbg.h>
+#endif
+
+struct OptimizerScope {
+	// Value of the constant final locals, by slot. Other slots hold JavaType::none.
+	std::vector<JavaObject> constants;
+	// Declared type of the number and boolean locals, by slot. Other slots hold JavaType::none.
+	std::vector<JavaType> types;
+	// Of the block or function, temporaries get the slots after the ones of the resolver.
+	uint16_t* slot_count;
+	// Parameters get the first slots, their types are only hints since arguments aren't cast.
+	uint16_t parameter_count;
+};
+
+// Shape of a pure expression, two expressions with the same key compute the same value as long as
+// none of the locals they read is assigned in between.
+struct PureKey {
+	std::string text;
+	JavaType type = JavaType::none;
+	std::vector<LocalRef> operands;
+	uint32_t cost = 0;
+	bool can_fail = false; // A division or remainder by something that may be zero, or a read of a parameter.
+};
+
+// What the inliner found out about a function the first time a call to it was looked at.
+struct InlineBody {
+	bool is_inlinable;
+	JavaType result_type; // Of the returned expression, the call casts it to the return type.
+};
+
+struct Optimizer {
+	Interpreter* interpreter;
+	Ast* ast;
+	// Scopes line up with the ones of the resolver.
+	std::vector<OptimizerScope> scopes = {};
+	// Classes whose constants were computed in this run, the code after them runs after they are defined.
+	std::unordered_set<Symbol> analyzed_classes = {};
+	// Declarations of the temporaries of the loop being optimized, they go right before it.
+	std::vector<StmtId> preheader = {};
+	// Top level functions declared in this run, the code after them runs after they are defined.
+	std::unordered_map<Symbol, Stmt_Function*> functions = {};
+	std::unordered_map<const Stmt_Function*, InlineBody> inline_bodies = {};
+	// Functions whose bodies are being copied, they aren't inlined again into their own copy.
+	std::vector<const Stmt_Function*> inlining = {};
+	// Scopes around the statements being optimized that declare classes. Those names are found
+	// before the globals, so the names in an inlined body could mean something else there.
+	uint32_t class_scopes = 0;
+	// Parsing a body ahead adds nodes, and a streamed statement drops the ones it adds (see Main.cpp).
+	bool can_parse_bodies = true;
+
+	// Drops the statements that are removed, and the ones after a statement that always leaves the
+	// list. The top level of a program is run to the end even after a break, so it's only pruned in bodies.
+	void statements(StmtList& statements);
+	void push_scope(uint16_t* slot_count);
+	void declare_types(Stmt_Var* stmt);
+	void share_subexpressions(StmtList& statements);
+	void hoist_invariants(StmtId loop);
+	// A hidden local `$t<slot>` in the innermost scope, SYMBOL_NONE when it has no slots left.
+	Symbol temporary(JavaType type, uint16_t* slot);
+	// A slot after the ones of the innermost scope, LOCAL_SLOT_NONE when it has no slots left.
+	uint16_t new_slot(JavaType type);
+	// The function a call runs, when it's known before the program runs.
+	Stmt_Function* callee_declaration(ExprId callee);
+	bool parse_body(Stmt_Function* function);
+	const InlineBody* inline_body(Stmt_Function* function);
+	JavaType static_type(ExprId expression);
+	ExprId* call_site(ExprId* location);
+	// Calls inlined into the statement add their statements to `out`. Returns the statement, or
+	// STMT_NONE when nothing is left of it.
+	StmtId inline_calls(StmtId statement, std::vector<StmtId>* out);
+	bool inline_call(ExprId* site, bool is_discarded, std::vector<StmtId>* out);
+	void emit(StmtId statement, std::vector<StmtId>* out);
+	StmtId temporary_declaration(Symbol name, SpanId span, uint16_t slot, JavaType type, ExprId initializer, bool is_final);
+	// Locals are keyed by their depth from the scope `nesting` levels up, reads of locals declared
+	// in the levels in between aren't pure.
+	bool pure_key(ExprId expression, uint16_t nesting, PureKey* key);
+	// Declarations that aren't right in a list of statements may not run before the names they
+	// declare are read, so their values aren't propagated. Returns the statement that takes its
+	// place, or STMT_NONE when it's removed.
+	StmtId statement(StmtId statement, bool is_in_list);
+	// Branches of ifs and bodies of loops can't be removed, they're left as an empty block.
+	StmtId branch(StmtId statement);
+	StmtId if_statement(StmtId statement);
+	void remove_unused_functions(StmtList& statements);
+	void removed_statement(StmtId statement);
+	void removed_expression(ExprId expression);
+	ExprId expression(ExprId expression);
+	void function(Stmt_Function* function);
+	void declare_constants(Stmt_Var* stmt);
+	void analyze_class(const Stmt_Class* stmt);
+	const ClassConstants* class_constants(ExprId object);
+	ExprId fold_get(ExprId expression);
+	ExprId fold(ExprId expression);
+	ExprId fold_call(ExprId expression);
+	ExprId literal(JavaObject value);
+};
+
+static bool is_literal(ExprId expression) {
+	return expression != EXPR_NONE && expr_type(expression) == ExprType::literal;
+}
+
+// Conditions that are a boolean literal, the others are kept to fail when they run.
+static bool is_boolean_literal(const Ast* ast, ExprId expression, bool value) {
+	if (!is_literal(expression)) return false;
+	const JavaObject& literal = ast_get<Expr_Literal>(ast, expression)->literal;
+	return literal.type == JavaType::_boolean && !literal.is_null && literal.value._boolean == value;
+}
+
+// Whether running the statement always leaves the list it's in, by a return, break or continue.
+static bool terminates(const Ast* ast, StmtId statement) {
+	switch (stmt_type(statement)) {
+		case StmtType::Break:
+		case StmtType::Continue:
+		case StmtType::Return:
+			return true;
+
+		case StmtType::Block: {
+			const Stmt_Block* stmt = ast_get<Stmt_Block>(ast, statement);
+			return !stmt->statements.empty() && terminates(ast, stmt->statements.back());
+		}
+
+		case StmtType::If: {
+			const Stmt_If* stmt = ast_get<Stmt_If>(ast, statement);
+			if (stmt->else_branch == STMT_NONE || !terminates(ast, stmt->then_branch) || !terminates(ast, stmt->else_branch)) return false;
+			for (const Else_If& else_if : stmt->else_ifs) {
+				if (!terminates(ast, else_if.then_branch)) return false;
+			}
+			return true;
+		}
+
+		default:
+			return false;
+	}
+}
+
+// Counts the nodes of a subtree, and collects the names it reads, assigns or calls when asked to.
+struct TreeWalk {
+	const Ast* ast;
+	size_t nodes = 0;
+	std::unordered_set<Symbol>* names = nullptr;
+	std::vector<Symbol> new_names = {}; // The ones that weren't in names yet.
+
+	void name(Symbol name);
+	void statement(StmtId statement);
+	void expression(ExprId expression);
+};
+
+void TreeWalk::name(Symbol name) {
+	if (names != nullptr && names->insert(name).second) new_names.push_back(name);
+}
+
+void TreeWalk::statement(StmtId statement) {
+	if (statement == STMT_NONE) return;
+	nodes++;
+
+	switch (stmt_type(statement)) {
+		case StmtType::Break:
+		case StmtType::Continue:
+			break;
+
+		case StmtType::Block: {
+			for (StmtId inner : ast_get<Stmt_Block>(ast, statement)->statements) this->statement(inner);
+		} break;
+
+		case StmtType::Class: {
+			Stmt_Class* stmt = ast_get<Stmt_Class>(ast, statement);
+			for (StmtId attribute : stmt->attributes) this->statement(attribute);
+			for (StmtId method : stmt->methods) this->statement(method);
+		} break;
+
+		case StmtType::Expression: {
+			expression(ast_get<Stmt_Expression>(ast, statement)->expression);
+		} break;
+
+		case StmtType::Function: {
+			Stmt_Function* stmt = ast_get<Stmt_Function>(ast, statement);
+			if (stmt->is_body_parsed) {
+				for (StmtId inner : stmt->body) this->statement(inner);
+			}
+			else if (names != nullptr) {
+				// A skipped body has no nodes yet, any name in its tokens may be used.
+				Lexer lexer(stmt->body_source.data(), stmt->body_source.size());
+				for (Token token = lexer.next(); token.type != TokenType::eof; token = lexer.next()) {
+					if (token.type == TokenType::identifier) name(token.symbol);
+				}
+			}
+		} break;
+
+		case StmtType::If: {
+			Stmt_If* stmt = ast_get<Stmt_If>(ast, statement);
+			expression(stmt->condition);
+			this->statement(stmt->then_branch);
+			for (const Else_If& else_if : stmt->else_ifs) {
+				expression(else_if.condition);
+				this->statement(else_if.then_branch);
+			}
+			this->statement(stmt->else_branch);
+		} break;
+
+		case StmtType::Print: {
+			expression(ast_get<Stmt_Print>(ast, statement)->expression);
+		} break;
+
+		case StmtType::Return: {
+			expression(ast_get<Stmt_Return>(ast, statement)->value);
+		} break;
+
+		case StmtType::Var: {
+			for (ExprId initializer : ast_get<Stmt_Var>(ast, statement)->initializers) expression(initializer);
+		} break;
+
+		case StmtType::While: {
+			Stmt_While* stmt = ast_get<Stmt_While>(ast, statement);
+			expression(stmt->condition);
+			this->statement(stmt->body);
+		} break;
+	}
+}
+
+void TreeWalk::expression(ExprId expression) {
+	if (expression == EXPR_NONE) return;
+	nodes++;
+
+	switch (expr_type(expression)) {
+		case ExprType::assign: {
+			Expr_Assign* expr = ast_get<Expr_Assign>(ast, expression);
+			this->expression(expr->lhs);
+			this->expression(expr->rhs);
+		} break;
+
+		case ExprType::binary: {
+			Expr_Binary* expr = ast_get<Expr_Binary>(ast, expression);
+			this->expression(expr->left);
+			this->expression(expr->right);
+		} break;
+
+		case ExprType::call: {
+			Expr_Call* expr = ast_get<Expr_Call>(ast, expression);
+			this->expression(expr->callee);
+			for (const ParseCallInfo& argument : expr->arguments) this->expression(argument.expr);
+		} break;
+
+		case ExprType::cast: {
+			this->expression(ast_get<Expr_Cast>(ast, expression)->right);
+		} break;
+
+		case ExprType::get: {
+			this->expression(ast_get<Expr_Get>(ast, expression)->object);
+		} break;
+
+		case ExprType::grouping: {
+			this->expression(ast_get<Expr_Grouping>(ast, expression)->expression);
+		} break;
+
+		case ExprType::increment: {
+			name(ast_get<Expr_Increment>(ast, expression)->name);
+		} break;
+
+		case ExprType::literal:
+		case ExprType::self:
+			break;
+
+		case ExprType::logical: {
+			Expr_Logical* expr = ast_get<Expr_Logical>(ast, expression);
+			this->expression(expr->left);
+			this->expression(expr->right);
+		} break;
+
+		case ExprType::set: {
+			Expr_Set* expr = ast_get<Expr_Set>(ast, expression);
+			this->expression(expr->lhs);
+			this->expression(expr->value);
+		} break;
+
+		case ExprType::ternary: {
+			Expr_Ternary* expr = ast_get<Expr_Ternary>(ast, expression);
+			this->expression(expr->condition);
+			this->expression(expr->then);
+			this->expression(expr->otherwise);
+		} break;
+
+		case ExprType::unary: {
+			this->expression(ast_get<Expr_Unary>(ast, expression)->right);
+		} break;
+
+		case ExprType::variable: {
+			name(ast_get<Expr_Variable>(ast, expression)->name);
+		} break;
+	}
+}
+
+static bool is_constant_type(JavaType type) {
+	return is_java_type_number(type) || type == JavaType::_boolean;
+}
+
+ExprId Optimizer::literal(JavaObject value) {
+	return ast_new<Expr_Literal>(ast, value);
+}
+
+// Runs an expression whose operands are all literals. Errors are kept for runtime, where they are
+// reported when and if the expression runs.
+ExprId Optimizer::fold(ExprId expression) {
+	try {
+		JavaObject value = interpreter->evaluate_constant(expression);
+		if (!is_constant_type(value.type)) return expression;
+		return literal(value);
+	}
+	catch (JavaRuntimeError) {
+		return expression;
+	}
+}
+
+// Only a name that reaches the globals can be a native, locals were bound by the resolver.
+ExprId Optimizer::fold_call(ExprId expression) {
+	Expr_Call* expr = ast_get<Expr_Call>(ast, expression);
+	if (expr_type(expr->callee) != ExprType::variable) return expression;
+
+	Expr_Variable* callee = ast_get<Expr_Variable>(ast, expr->callee);
+	if (callee->local.depth != LOCAL_DEPTH_NONE) return expression;
+
+	auto found = interpreter->globals->values.find(callee->name);
+	if (found == interpreter->globals->values.end() || found->second.object.type != JavaType::Function) return expression;
+
+	JavaCallable* function = (JavaCallable*)found->second.object.value.function;
+	if (function->get_type() != CallableType::Builtin) return expression;
+
+	JavaNativeFunction* native = callable_cast<JavaNativeFunction>(function);
+	if (!native->is_pure) return expression;
+
+	std::vector<ArgumentInfo> arguments = {};
+	for (const ParseCallInfo& argument : expr->arguments) {
+		if (!is_literal(argument.expr)) return expression;
+		arguments.emplace_back(ast_get<Expr_Literal>(ast, argument.expr)->literal, argument.span);
+	}
+
+	try {
+		const SourceSpan& span = ast_span(ast, expr->paren);
+		JavaObject value = native->call(interpreter, span.line, span.column, arguments);
+		if (!is_constant_type(value.type)) return expression;
+		return literal(value);
+	}
+	catch (JavaRuntimeError) {
+		return expression;
+	}
+}
+
+void Optimizer::declare_constants(Stmt_Var* stmt) {
+	if (!stmt->is_final || scopes.empty()) return;
+
+	JavaType type = token_type_to_java_type(stmt->type);
+	if (!is_constant_type(type)) return;
+
+	for (size_t i = 0; i < stmt->names.size(); i++) {
+		const VarName& name = stmt->names.at(i);
+		ExprId initializer = stmt->initializers.at(i);
+		if (name.slot == LOCAL_SLOT_NONE || !is_literal(initializer)) continue;
+
+		// The same checks and cast the variable goes through when it's defined.
+		try {
+			JavaObject value = interpreter->validate_variable(stmt, type, name, initializer);
+			const SourceSpan& span = ast_span(ast, name.span);
+			auto casted = try_cast(symbol_table.name(name.symbol), span.line, span.column, type, value);
+			casted.first.is_null = casted.second;
+			scopes.back().constants.at(name.slot) = casted.first;
+		}
+		catch (JavaRuntimeError) {}
+	}
+}
+
+// Mirrors what the JavaClass constructor does with the static fields.
+void Optimizer::analyze_class(const Stmt_Class* stmt) {
+	ClassConstants constants = { stmt };
+	for (StmtId attribute : stmt->attributes) {
+		Stmt_Var* vardecl = ast_get<Stmt_Var>(ast, attribute);
+		if (!vardecl->is_static || !vardecl->is_final) continue;
+
+		JavaType type = token_type_to_java_type(vardecl->type);
+		if (!is_constant_type(type)) continue;
+
+		for (size_t i = 0; i < vardecl->names.size(); i++) {
+			const VarName& name = vardecl->names.at(i);
+			ExprId initializer = vardecl->initializers.at(i);
+			if (!is_literal(initializer)) continue;
+
+			try {
+				JavaObject value = interpreter->validate_variable(vardecl, type, name, initializer);
+				const SourceSpan& span = ast_span(ast, name.span);
+				auto casted = try_cast(symbol_table.name(name.symbol), span.line, span.column, type, value);
+				casted.first.is_null = casted.second;
+				constants.fields.insert({ name.symbol, casted.first });
+			}
+			catch (JavaRuntimeError) {}
+		}
+	}
+	interpreter->class_constants.insert_or_assign(stmt->name, constants);
+	analyzed_classes.insert(stmt->name);
+}
+
+// Constants of the class the object of a get names. A class analyzed in an earlier run (a previous
+// line of the REPL, or the program around a lazy body) only counts if it was actually defined.
+const ClassConstants* Optimizer::class_constants(ExprId object) {
+	if (expr_type(object) != ExprType::variable) return nullptr;
+	Expr_Variable* variable = ast_get<Expr_Variable>(ast, object);
+	if (variable->local.depth != LOCAL_DEPTH_NONE) return nullptr;
+
+	auto found = interpreter->class_constants.find(variable->name);
+	if (found == interpreter->class_constants.end()) return nullptr;
+	if (analyzed_classes.contains(variable->name)) return &found->second;
+
+	auto defined = interpreter->globals->values.find(variable->name);
+	if (defined == interpreter->globals->values.end() || defined->second.object.type != JavaType::Class) return nullptr;
+	JavaClass* class_info = (JavaClass*)defined->second.object.value.class_info;
+	if (class_info->attributes.items != found->second.declaration->attributes.items) return nullptr;
+	return &found->second;
+}
+
+ExprId Optimizer::fold_get(ExprId expression) {
+	Expr_Get* expr = ast_get<Expr_Get>(ast, expression);
+	const ClassConstants* constants = class_constants(expr->object);
+	if (constants == nullptr) return expression;
+
+	auto field = constants->fields.find(expr->name);
+	if (field == constants->fields.end()) return expression;
+	return literal(field->second);
+}
+
+void Optimizer::removed_statement(StmtId statement) {
+	TreeWalk walk = { ast };
+	walk.statement(statement);
+	interpreter->removed_nodes += walk.nodes;
+}
+
+void Optimizer::removed_expression(ExprId expression) {
+	TreeWalk walk = { ast };
+	walk.expression(expression);
+	interpreter->removed_nodes += walk.nodes;
+}
+
+void Optimizer::statements(StmtList& statements) {
+	// Top level classes are globals, like the functions.
+	bool has_classes = false;
+	for (StmtId statement : statements) {
+		has_classes = has_classes || (stmt_type(statement) == StmtType::Class && !scopes.empty());
+	}
+	if (has_classes) class_scopes++;
+
+	std::vector<StmtId> kept = {};
+	kept.reserve(statements.count);
+	for (uint32_t i = 0; i < statements.count; i++) {
+		StmtId statement = this->statement(statements.items[i], true);
+		kept.insert(kept.end(), preheader.begin(), preheader.end());
+		preheader.clear();
+		if (statement != STMT_NONE && !scopes.empty() && class_scopes == 0) {
+			statement = inline_calls(statement, &kept);
+		}
+		if (statement == STMT_NONE) continue;
+		kept.push_back(statement);
+
+		if (!scopes.empty() && terminates(ast, statement)) {
+			for (i++; i < statements.count; i++) {
+				removed_statement(statements.items[i]);
+			}
+		}
+	}
+
+	if (kept.size() <= statements.count) {
+		std::copy(kept.begin(), kept.end(), statements.items);
+		statements.count = (uint32_t)kept.size();
+	}
+	else {
+		statements = arena_push_array(&ast->arena, kept);
+	}
+	if (has_classes) class_scopes--;
+
+	if (!scopes.empty()) share_subexpressions(statements);
+}
+
+void Optimizer::push_scope(uint16_t* slot_count) {
+	OptimizerScope scope = { {}, {}, slot_count, 0 };
+	scope.constants.resize(*slot_count, JavaObject{ JavaType::none, JavaValue{} });
+	scope.types.resize(*slot_count, JavaType::none);
+	scopes.push_back(std::move(scope));
+}
+
+void Optimizer::declare_types(Stmt_Var* stmt) {
+	JavaType type = token_type_to_java_type(stmt->type);
+	if (scopes.empty() || !is_constant_type(type)) return;
+	for (const VarName& name : stmt->names) {
+		if (name.slot != LOCAL_SLOT_NONE) scopes.back().types.at(name.slot) = type;
+	}
+}
+
+StmtId Optimizer::branch(StmtId statement) {
+	StmtId optimized = this->statement(statement, false);
+	if (optimized != STMT_NONE) return optimized;
+	return ast_new<Stmt_Block>(ast, StmtList{});
+}
+
+void Optimizer::function(Stmt_Function* function) {
+	if (!function->is_body_parsed) return;
+
+	std::vector<OptimizerScope> enclosing = std::move(scopes);
+	scopes.clear();
+	push_scope(&function->slot_count);
+	scopes.back().parameter_count = (uint16_t)function->params.size();
+	for (size_t i = 0; i < function->params.size(); i++) {
+		JavaType type = function->params[i].first.type;
+		if (is_constant_type(type)) scopes.back().types.at(i) = type;
+	}
+
+	// The body only sees the globals, not the classes of the blocks around the declaration.
+	uint32_t enclosing_class_scopes = class_scopes;
+	class_scopes = 0;
+	interpreter->optimizing_functions.push_back(function);
+	statements(function->body);
+	interpreter->optimizing_functions.pop_back();
+	class_scopes = enclosing_class_scopes;
+
+	scopes = std::move(enclosing);
+}
+
+// Arms whose condition is false are dropped, and the first one whose condition is true becomes the
+// else branch. An if that's left with no arm is replaced by its else branch.
+StmtId Optimizer::if_statement(StmtId statement) {
+	Stmt_If* stmt = ast_get<Stmt_If>(ast, statement);
+	std::vector<Else_If> arms = {};
+	StmtId else_branch = stmt->else_branch;
+	bool is_pruned = false;
+
+	const Else_If first = { stmt->span, stmt->condition, stmt->then_branch };
+	for (size_t i = 0; i <= stmt->else_ifs.size(); i++) {
+		const Else_If& arm = (i == 0) ? first : stmt->else_ifs[i - 1];
+		ExprId condition = expression(arm.condition);
+
+		if (is_boolean_literal(ast, condition, false)) {
+			removed_expression(condition);
+			removed_statement(arm.then_branch);
+			is_pruned = true;
+			continue;
+		}
+		if (is_boolean_literal(ast, condition, true)) {
+			removed_expression(condition);
+			for (size_t j = i; j < stmt->else_ifs.size(); j++) {
+				removed_expression(stmt->else_ifs[j].condition);
+				removed_statement(stmt->else_ifs[j].then_branch);
+			}
+			removed_statement(else_branch);
+			else_branch = arm.then_branch;
+			is_pruned = true;
+			break;
+		}
+		arms.push_back(Else_If{ arm.span, condition, branch(arm.then_branch) });
+	}
+	if (else_branch != STMT_NONE) {
+		else_branch = this->statement(else_branch, false);
+	}
+
+	if (arms.empty()) {
+		interpreter->removed_nodes++;
+		return else_branch;
+	}
+	if (!is_pruned) {
+		stmt->condition = arms[0].condition;
+		stmt->then_branch = arms[0].then_branch;
+		for (size_t i = 0; i < stmt->else_ifs.size(); i++) {
+			stmt->else_ifs[i].condition = arms[i + 1].condition;
+			stmt->else_ifs[i].then_branch = arms[i + 1].then_branch;
+		}
+		stmt->else_branch = else_branch;
+		return statement;
+	}
+	ArenaArray<Else_If> else_ifs = arena_push_array(&ast->arena, arms.data() + 1, arms.size() - 1);
+	return ast_new<Stmt_If>(ast, arms[0].span, arms[0].condition, arms[0].then_branch, else_ifs, else_branch);
+}
+
+StmtId Optimizer::statement(StmtId statement, bool is_in_list) {
+	switch (stmt_type(statement)) {
+		case StmtType::Break:
+		case StmtType::Continue:
+			break;
+
+		case StmtType::Block: {
+			Stmt_Block* stmt = ast_get<Stmt_Block>(ast, statement);
+			push_scope(&stmt->slot_count);
+			statements(stmt->statements);
+			scopes.pop_back();
+			if (is_in_list && stmt->statements.empty()) {
+				interpreter->removed_nodes++;
+				return STMT_NONE;
+			}
+		} break;
+
+		case StmtType::Class: {
+			Stmt_Class* stmt = ast_get<Stmt_Class>(ast, statement);
+			for (StmtId attribute : stmt->attributes) {
+				this->statement(attribute, false);
+			}
+			// Classes in blocks are only defined in there, their names aren't looked up from the globals.
+			if (scopes.empty()) analyze_class(stmt);
+			for (StmtId method : stmt->methods) {
+				function(ast_get<Stmt_Function>(ast, method));
+			}
+		} break;
+
+		case StmtType::Expression: {
+			Stmt_Expression* stmt = ast_get<Stmt_Expression>(ast, statement);
+			stmt->expression = expression(stmt->expression);
+		} break;
+
+		case StmtType::Function: {
+			Stmt_Function* stmt = ast_get<Stmt_Function>(ast, statement);
+			function(stmt);
+			if (scopes.empty()) functions.insert_or_assign(stmt->name, stmt);
+		} break;
+
+		case StmtType::If: {
+			return if_statement(statement);
+		} break;
+
+		case StmtType::Print: {
+			Stmt_Print* stmt = ast_get<Stmt_Print>(ast, statement);
+			stmt->expression = expression(stmt->expression);
+		} break;
+
+		case StmtType::Return: {
+			Stmt_Return* stmt = ast_get<Stmt_Return>(ast, statement);
+			stmt->value = expression(stmt->value);
+		} break;
+
+		case StmtType::Var: {
+			Stmt_Var* stmt = ast_get<Stmt_Var>(ast, statement);
+			for (ExprId& initializer : stmt->initializers) {
+				initializer = expression(initializer);
+			}
+			declare_types(stmt);
+			if (is_in_list) declare_constants(stmt);
+		} break;
+
+		case StmtType::While: {
+			Stmt_While* stmt = ast_get<Stmt_While>(ast, statement);
+			stmt->condition = expression(stmt->condition);
+			if (is_boolean_literal(ast, stmt->condition, false)) {
+				removed_statement(statement);
+				return STMT_NONE;
+			}
+
+			if (stmt->has_increment && stmt_type(stmt->body) == StmtType::Block) {
+				// The increment has to stay the last statement of the body, the interpreter runs it on continue.
+				Stmt_Block* body = ast_get<Stmt_Block>(ast, stmt->body);
+				StmtId increment = body->statements.back();
+				push_scope(&body->slot_count);
+				body->statements.count--;
+				statements(body->statements);
+				// Temporaries may have moved the list, so it's copied with the increment at the end.
+				std::vector<StmtId> with_increment(body->statements.begin(), body->statements.end());
+				with_increment.push_back(this->statement(increment, false));
+				body->statements = arena_push_array(&ast->arena, with_increment);
+				scopes.pop_back();
+			}
+			else {
+				stmt->body = branch(stmt->body);
+			}
+			if (is_in_list && !scopes.empty()) hoist_invariants(statement);
+		} break;
+	}
+	return statement;
+}
+
+// Pure expressions cost at least this much to be worth a temporary, a read of a local costs 1.
+#define SHARED_EXPRESSION_MIN_COST 4
+
+// An expression evaluated more than once in a basic block.
+struct SharedExpression {
+	ExprId* first; // Becomes an assignment to the temporary.
+	uint32_t statement; // The temporary is declared right before it.
+	JavaType type;
+	std::vector<LocalRef> operands;
+	std::vector<ExprId*> repeats = {}; // Become reads of the temporary.
+};
+
+// Walks the expressions of a list of statements in the order they run. A basic block ends at any
+// statement that branches or loops, the expressions before it aren't reused after it.
+struct SubexpressionSharing {
+	Optimizer* optimizer;
+	std::vector<SharedExpression> shared = {};
+	std::unordered_map<std::string, size_t> available = {};
+	uint32_t statement = 0;
+
+	void visit(ExprId* location, bool is_conditional);
+	void kill(LocalRef local);
+};
+
+template<typename T>
+static void key_append(std::string* text, const T& value) {
+	text->append((const char*)&value, sizeof(T));
+}
+
+// Literals, locals of a known type, typed kernels, casts, unary operators and calls to pure natives.
+bool Optimizer::pure_key(ExprId expression, uint16_t nesting, PureKey* key) {
+	ExprType type = expr_type(expression);
+	key_append(&key->text, type);
+
+	switch (type) {
+		case ExprType::binary: {
+			Expr_Binary* expr = ast_get<Expr_Binary>(ast, expression);
+			if (expr->kernel == BINARY_KERNEL_NONE) return false;
+			key_append(&key->text, expr->kernel);
+			if (!pure_key(expr->left, nesting, key) || key->type != expr->left_type) return false;
+			if (!pure_key(expr->right, nesting, key) || key->type != expr->right_type) return false;
+			key->type = binary_kernel_result(expr->kernel);
+
+			bool is_division = expr->kernel >= binary_kernel(BinaryOp::divide, JavaType::_byte) && expr->kernel < binary_kernel(BinaryOp::left_shift, JavaType::_byte);
+			if (is_division) {
+				bool is_nonzero = is_literal(expr->right) && java_cast_to_double(ast_get<Expr_Literal>(ast, expr->right)->literal) != 0;
+				key->can_fail = key->can_fail || !is_nonzero;
+			}
+			key->cost += 2;
+			return true;
+		}
+
+		case ExprType::call: {
+			Expr_Call* expr = ast_get<Expr_Call>(ast, expression);
+			if (expr_type(expr->callee) != ExprType::variable) return false;
+			Expr_Variable* callee = ast_get<Expr_Variable>(ast, expr->callee);
+			if (callee->local.depth != LOCAL_DEPTH_NONE) return false;
+
+			auto found = interpreter->globals->values.find(callee->name);
+			if (found == interpreter->globals->values.end() || found->second.object.type != JavaType::Function) return false;
+			JavaCallable* function = (JavaCallable*)found->second.object.value.function;
+			if (function->get_type() != CallableType::Builtin) return false;
+			JavaNativeFunction* native = callable_cast<JavaNativeFunction>(function);
+			if (!native->is_pure || native->result_type == JavaType::none || native->arity() != (int)expr->arguments.size()) return false;
+
+			key_append(&key->text, callee->name);
+			key_append(&key->text, expr->arguments.count);
+			// Natives that are pure take numbers, anything else is rejected when the call runs.
+			for (const ParseCallInfo& argument : expr->arguments) {
+				if (!pure_key(argument.expr, nesting, key) || !is_java_type_number(key->type)) return false;
+			}
+			key->type = native->result_type;
+			key->cost += 8;
+			return true;
+		}
+
+		case ExprType::cast: {
+			Expr_Cast* expr = ast_get<Expr_Cast>(ast, expression);
+			if (!is_java_type_number(expr->type)) return false;
+			key_append(&key->text, expr->type);
+			if (!pure_key(expr->right, nesting, key) || !is_java_type_number(key->type)) return false;
+			key->type = expr->type;
+			key->cost += 1;
+			return true;
+		}
+
+		case ExprType::grouping: {
+			return pure_key(ast_get<Expr_Grouping>(ast, expression)->expression, nesting, key);
+		}
+
+		case ExprType::literal: {
+			const JavaObject& literal = ast_get<Expr_Literal>(ast, expression)->literal;
+			if (!is_constant_type(literal.type) || literal.is_null) return false;
+			key_append(&key->text, literal.type);
+			key_append(&key->text, literal.value);
+			key->type = literal.type;
+			return true;
+		}
+
+		case ExprType::unary: {
+			Expr_Unary* expr = ast_get<Expr_Unary>(ast, expression);
+			key_append(&key->text, expr->_operator);
+			if (!pure_key(expr->right, nesting, key)) return false;
+
+			// The operand types the interpreter doesn't reject, the result has the same type.
+			switch (expr->_operator) {
+				case TokenType::minus: if (!is_java_type_number(key->type) || key->type == JavaType::_char) return false; break;
+				case TokenType::bitwise_not: if (key->type != JavaType::_byte && key->type != JavaType::_int && key->type != JavaType::_long) return false; break;
+				case TokenType::_not: if (key->type != JavaType::_boolean) return false; break;
+				default: return false;
+			}
+			key->cost += 1;
+			return true;
+		}
+
+		case ExprType::variable: {
+			Expr_Variable* expr = ast_get<Expr_Variable>(ast, expression);
+			if (expr->is_function || expr->local.depth == LOCAL_DEPTH_NONE || expr->local.depth < nesting) return false;
+			LocalRef local = { (uint16_t)(expr->local.depth - nesting), expr->local.slot };
+			if (local.depth >= scopes.size()) return false;
+			const OptimizerScope& scope = scopes[scopes.size() - 1 - local.depth];
+			if (local.slot >= scope.types.size() || scope.types[local.slot] == JavaType::none) return false;
+
+			key_append(&key->text, local);
+			key->type = scope.types[local.slot];
+			key->can_fail = key->can_fail || local.slot < scope.parameter_count;
+			key->operands.push_back(local);
+			key->cost += 1;
+			return true;
+		}
+
+		default:
+			return false;
+	}
+}
+
+void SubexpressionSharing::kill(LocalRef local) {
+	for (auto it = available.begin(); it != available.end();) {
+		const std::vector<LocalRef>& operands = shared[it->second].operands;
+		bool is_read = false;
+		for (LocalRef operand : operands) {
+			is_read = is_read || (operand.depth == local.depth && operand.slot == local.slot);
+		}
+		it = is_read ? available.erase(it) : std::next(it);
+	}
+}
+
+// A repeat of an available expression reads the temporary, without looking inside it. Only the
+// expressions that always run when the statement runs make new ones available, the ones that may
+// be skipped by a logical operator or a ternary only reuse them.
+void SubexpressionSharing::visit(ExprId* location, bool is_conditional) {
+	ExprId expression = *location;
+	if (expression == EXPR_NONE) return;
+	Ast* ast = optimizer->ast;
+
+	// A grouping has the key of its expression, which is the one that's shared.
+	if (expr_type(expression) == ExprType::grouping) {
+		visit(&ast_get<Expr_Grouping>(ast, expression)->expression, is_conditional);
+		return;
+	}
+
+	PureKey pure = {};
+	bool is_shareable = optimizer->pure_key(expression, 0, &pure) && pure.cost >= SHARED_EXPRESSION_MIN_COST;
+	if (is_shareable) {
+		auto found = available.find(pure.text);
+		if (found != available.end()) {
+			shared[found->second].repeats.push_back(location);
+			return;
+		}
+	}
+
+	switch (expr_type(expression)) {
+		case ExprType::assign: {
+			Expr_Assign* expr = ast_get<Expr_Assign>(ast, expression);
+			visit(&expr->rhs, is_conditional);
+			if (expr->local.depth != LOCAL_DEPTH_NONE) kill(expr->local);
+		} break;
+
+		case ExprType::binary: {
+			Expr_Binary* expr = ast_get<Expr_Binary>(ast, expression);
+			visit(&expr->left, is_conditional);
+			visit(&expr->right, is_conditional);
+		} break;
+
+		case ExprType::call: {
+			Expr_Call* expr = ast_get<Expr_Call>(ast, expression);
+			visit(&expr->callee, is_conditional);
+			for (ParseCallInfo& argument : expr->arguments) {
+				visit(&argument.expr, is_conditional);
+			}
+		} break;
+
+		case ExprType::cast: {
+			visit(&ast_get<Expr_Cast>(ast, expression)->right, is_conditional);
+		} break;
+
+		case ExprType::get: {
+			visit(&ast_get<Expr_Get>(ast, expression)->object, is_conditional);
+		} break;
+
+		case ExprType::increment: {
+			Expr_Increment* expr = ast_get<Expr_Increment>(ast, expression);
+			if (expr->local.depth != LOCAL_DEPTH_NONE) kill(expr->local);
+		} break;
+
+		case ExprType::logical: {
+			Expr_Logical* expr = ast_get<Expr_Logical>(ast, expression);
+			visit(&expr->left, is_conditional);
+			visit(&expr->right, true);
+		} break;
+
+		case ExprType::set: {
+			Expr_Set* expr = ast_get<Expr_Set>(ast, expression);
+			visit(&ast_get<Expr_Get>(ast, expr->lhs)->object, is_conditional);
+			visit(&expr->value, is_conditional);
+		} break;
+
+		case ExprType::ternary: {
+			Expr_Ternary* expr = ast_get<Expr_Ternary>(ast, expression);
+			visit(&expr->condition, is_conditional);
+			visit(&expr->then, true);
+			visit(&expr->otherwise, true);
+		} break;
+
+		case ExprType::unary: {
+			visit(&ast_get<Expr_Unary>(ast, expression)->right, is_conditional);
+		} break;
+
+		default: break;
+	}
+
+	if (is_shareable && !is_conditional) {
+		available[pure.text] = shared.size();
+		shared.push_back(SharedExpression{ location, statement, pure.type, std::move(pure.operands) });
+	}
+}
+
+// Span the errors of an expression are reported at.
+static SpanId expression_span(const Ast* ast, ExprId expression) {
+	switch (expr_type(expression)) {
+		case ExprType::binary: return ast_get<Expr_Binary>(ast, expression)->span;
+		case ExprType::call: return ast_get<Expr_Call>(ast, expression)->paren;
+		case ExprType::cast: return ast_get<Expr_Cast>(ast, expression)->span;
+		case ExprType::grouping: return expression_span(ast, ast_get<Expr_Grouping>(ast, expression)->expression);
+		case ExprType::unary: return ast_get<Expr_Unary>(ast, expression)->span;
+		default: assert(false && "Only pure expressions are shared."); return 0;
+	}
+}
+
+// The first evaluation of an expression computed again later in its basic block assigns it to a
+// hidden local, declared right before the statement, and the other evaluations read that local.
+// The assignment stays where the expression was, so everything still runs in the same order.
+void Optimizer::share_subexpressions(StmtList& statements) {
+	SubexpressionSharing sharing = { this };
+
+	for (uint32_t i = 0; i < statements.count; i++) {
+		sharing.statement = i;
+		StmtId statement = statements.items[i];
+		switch (stmt_type(statement)) {
+			case StmtType::Expression: {
+				sharing.visit(&ast_get<Stmt_Expression>(ast, statement)->expression, false);
+			} break;
+
+			case StmtType::If: {
+				// The condition runs before the branches, they're blocks of their own.
+				sharing.visit(&ast_get<Stmt_If>(ast, statement)->condition, false);
+				sharing.available.clear();
+			} break;
+
+			case StmtType::Print: {
+				sharing.visit(&ast_get<Stmt_Print>(ast, statement)->expression, false);
+			} break;
+
+			case StmtType::Return: {
+				sharing.visit(&ast_get<Stmt_Return>(ast, statement)->value, false);
+				sharing.available.clear();
+			} break;
+
+			case StmtType::Var: {
+				Stmt_Var* stmt = ast_get<Stmt_Var>(ast, statement);
+				for (size_t j = 0; j < stmt->names.size(); j++) {
+					sharing.visit(&stmt->initializers[j], false);
+					if (stmt->names[j].slot != LOCAL_SLOT_NONE) sharing.kill(LocalRef{ 0, stmt->names[j].slot });
+				}
+			} break;
+
+			default:
+				sharing.available.clear();
+				break;
+		}
+	}
+
+	std::vector<std::vector<StmtId>> declarations(statements.count);
+	size_t declared = 0;
+	for (const SharedExpression& expression : sharing.shared) {
+		if (expression.repeats.empty()) continue;
+
+		uint16_t slot = 0;
+		Symbol name = temporary(expression.type, &slot);
+		if (name == SYMBOL_NONE) continue;
+		SpanId span = expression_span(ast, *expression.first);
+		LocalRef local = { 0, slot };
+
+		ExprId target = ast_new<Expr_Variable>(ast, name, span, false);
+		ast_get<Expr_Variable>(ast, target)->local = local;
+		ExprId assign = ast_new<Expr_Assign>(ast, target, name, span, *expression.first);
+		ast_get<Expr_Assign>(ast, assign)->local = local;
+		*expression.first = assign;
+
+		for (ExprId* repeat : expression.repeats) {
+			*repeat = ast_new<Expr_Variable>(ast, name, span, false);
+			ast_get<Expr_Variable>(ast, *repeat)->local = local;
+		}
+
+		// Some types can't be declared without a value, the zero of the type is never read.
+		ExprId zero = literal(JavaObject{ expression.type, JavaValue{} });
+		declarations[expression.statement].push_back(temporary_declaration(name, span, slot, expression.type, zero, false));
+		declared++;
+	}
+	if (declared == 0) return;
+
+	std::vector<StmtId> result = {};
+	result.reserve(statements.count + declared);
+	for (uint32_t i = 0; i < statements.count; i++) {
+		result.insert(result.end(), declarations[i].begin(), declarations[i].end());
+		result.push_back(statements.items[i]);
+	}
+	statements = arena_push_array(&ast->arena, result);
+}
+
+uint16_t Optimizer::new_slot(JavaType type) {
+	OptimizerScope& scope = scopes.back();
+	if (*scope.slot_count >= LOCAL_SLOT_NONE - 1) return LOCAL_SLOT_NONE;
+
+	scope.constants.push_back(JavaObject{ JavaType::none, JavaValue{} });
+	scope.types.push_back(type);
+	return (*scope.slot_count)++;
+}
+
+Symbol Optimizer::temporary(JavaType type, uint16_t* slot) {
+	*slot = new_slot(type);
+	if (*slot == LOCAL_SLOT_NONE) return SYMBOL_NONE;
+	return symbol_table.intern("$t" + std::to_string(*slot));
+}
+
+StmtId Optimizer::temporary_declaration(Symbol name, SpanId span, uint16_t slot, JavaType type, ExprId initializer, bool is_final) {
+	const VarName names[] = { VarName{ name, span, slot } };
+	const ExprId initializers[] = { initializer };
+	return ast_new<Stmt_Var>(ast, java_type_to_token_type(type), SYMBOL_NONE, span,
+		arena_push_array(&ast->arena, names, 1), arena_push_array(&ast->arena, initializers, 1),
+		Visibility::Local, false, is_final);
+}
+
+// Pure expressions that run on every iteration are hoisted when they cost at least this much.
+#define LOOP_INVARIANT_MIN_COST 2
+
+// Walks a loop twice with the nesting of every statement, counted in scopes from the one the loop
+// runs in. First to find the locals of that scope and the ones around it that the loop assigns,
+// then to replace the invariant expressions with reads of the temporaries declared before it.
+struct LoopInvariants {
+	Optimizer* optimizer;
+	StmtId loop;
+	bool is_hoisting = false;
+	// In the condition of the loop, until an expression that may fail or have an effect. The
+	// expressions up to there run right after the pre-header, when the condition is first tested.
+	bool is_first_to_run = false;
+	bool has_class = false;
+	std::vector<LocalRef> written = {};
+	std::unordered_map<std::string, std::pair<Symbol, uint16_t>> hoisted = {};
+
+	void statement(StmtId statement, uint16_t nesting);
+	void expression(ExprId* location, uint16_t nesting);
+	void write(LocalRef local, uint16_t nesting);
+	bool is_invariant(const PureKey& key);
+	void hoist(ExprId* location, uint16_t nesting, const PureKey& key);
+};
+
+void LoopInvariants::write(LocalRef local, uint16_t nesting) {
+	if (local.depth == LOCAL_DEPTH_NONE || local.depth < nesting) return;
+	written.push_back(LocalRef{ (uint16_t)(local.depth - nesting), local.slot });
+}
+
+bool LoopInvariants::is_invariant(const PureKey& key) {
+	for (LocalRef operand : key.operands) {
+		for (LocalRef local : written) {
+			if (operand.depth == local.depth && operand.slot == local.slot) return false;
+		}
+	}
+	return true;
+}
+
+// The expression moves to the scope of the loop, so its locals are now `nesting` scopes closer.
+static void shift_depths(const Ast* ast, ExprId expression, uint16_t nesting) {
+	switch (expr_type(expression)) {
+		case ExprType::binary: {
+			Expr_Binary* expr = ast_get<Expr_Binary>(ast, expression);
+			shift_depths(ast, expr->left, nesting);
+			shift_depths(ast, expr->right, nesting);
+		} break;
+
+		case ExprType::call: {
+			for (const ParseCallInfo& argument : ast_get<Expr_Call>(ast, expression)->arguments) {
+				shift_depths(ast, argument.expr, nesting);
+			}
+		} break;
+
+		case ExprType::cast: shift_depths(ast, ast_get<Expr_Cast>(ast, expression)->right, nesting); break;
+		case ExprType::grouping: shift_depths(ast, ast_get<Expr_Grouping>(ast, expression)->expression, nesting); break;
+		case ExprType::unary: shift_depths(ast, ast_get<Expr_Unary>(ast, expression)->right, nesting); break;
+
+		case ExprType::variable: {
+			Expr_Variable* expr = ast_get<Expr_Variable>(ast, expression);
+			if (expr->local.depth != LOCAL_DEPTH_NONE) expr->local.depth -= nesting;
+		} break;
+
+		default: break;
+	}
+}
+
+// The same expression hoisted from different places of the loop shares one temporary.
+void LoopInvariants::hoist(ExprId* location, uint16_t nesting, const PureKey& key) {
+	Ast* ast = optimizer->ast;
+	SpanId span = expression_span(ast, *location);
+
+	auto found = hoisted.find(key.text);
+	if (found == hoisted.end()) {
+		uint16_t slot = 0;
+		Symbol name = optimizer->temporary(key.type, &slot);
+		if (name == SYMBOL_NONE) return;
+
+		shift_depths(ast, *location, nesting);
+		optimizer->preheader.push_back(optimizer->temporary_declaration(name, span, slot, key.type, *location, true));
+		found = hoisted.insert({ key.text, { name, slot } }).first;
+	}
+
+	*location = ast_new<Expr_Variable>(ast, found->second.first, span, false);
+	ast_get<Expr_Variable>(ast, *location)->local = LocalRef{ nesting, found->second.second };
+}
+
+void LoopInvariants::expression(ExprId* location, uint16_t nesting) {
+	ExprId expression = *location;
+	if (expression == EXPR_NONE) return;
+	Ast* ast = optimizer->ast;
+
+	// Pure expressions that can't fail run the same whether they're hoisted or not, even when the
+	// loop would have skipped them. The ones that may fail, like the ones that read a parameter
+	// that holds another type, are only hoisted when they would have run first anyway.
+	bool is_safe = false;
+	if (is_hoisting) {
+		PureKey key = {};
+		bool is_pure = optimizer->pure_key(expression, nesting, &key);
+		if (is_pure && (!key.can_fail || is_first_to_run) && key.cost >= LOOP_INVARIANT_MIN_COST && is_invariant(key)) {
+			hoist(location, nesting, key);
+			return;
+		}
+		is_safe = is_pure && !key.can_fail;
+	}
+
+	switch (expr_type(expression)) {
+		case ExprType::assign: {
+			Expr_Assign* expr = ast_get<Expr_Assign>(ast, expression);
+			this->expression(&expr->rhs, nesting);
+			write(expr->local, nesting);
+		} break;
+
+		case ExprType::binary: {
+			Expr_Binary* expr = ast_get<Expr_Binary>(ast, expression);
+			this->expression(&expr->left, nesting);
+			this->expression(&expr->right, nesting);
+		} break;
+
+		case ExprType::call: {
+			Expr_Call* expr = ast_get<Expr_Call>(ast, expression);
+			if (expr_type(expr->callee) != ExprType::variable) this->expression(&expr->callee, nesting);
+			for (ParseCallInfo& argument : expr->arguments) {
+				this->expression(&argument.expr, nesting);
+			}
+		} break;
+
+		case ExprType::cast: this->expression(&ast_get<Expr_Cast>(ast, expression)->right, nesting); break;
+		case ExprType::get: this->expression(&ast_get<Expr_Get>(ast, expression)->object, nesting); break;
+		case ExprType::grouping: this->expression(&ast_get<Expr_Grouping>(ast, expression)->expression, nesting); break;
+		case ExprType::increment: write(ast_get<Expr_Increment>(ast, expression)->local, nesting); break;
+
+		// The right operand and the branches may not run.
+		case ExprType::logical: {
+			Expr_Logical* expr = ast_get<Expr_Logical>(ast, expression);
+			this->expression(&expr->left, nesting);
+			is_first_to_run = false;
+			this->expression(&expr->right, nesting);
+		} break;
+
+		case ExprType::set: {
+			Expr_Set* expr = ast_get<Expr_Set>(ast, expression);
+			this->expression(&ast_get<Expr_Get>(ast, expr->lhs)->object, nesting);
+			this->expression(&expr->value, nesting);
+		} break;
+
+		case ExprType::ternary: {
+			Expr_Ternary* expr = ast_get<Expr_Ternary>(ast, expression);
+			this->expression(&expr->condition, nesting);
+			is_first_to_run = false;
+			this->expression(&expr->then, nesting);
+			this->expression(&expr->otherwise, nesting);
+		} break;
+
+		case ExprType::unary: this->expression(&ast_get<Expr_Unary>(ast, expression)->right, nesting); break;
+
+		default: break;
+	}
+
+	// The operands ran first, then the expression itself. Reading a local can't fail, whatever it holds.
+	if (!is_safe && expr_type(expression) != ExprType::variable) is_first_to_run = false;
+}
+
+void LoopInvariants::statement(StmtId statement, uint16_t nesting) {
+	if (statement == STMT_NONE) return;
+	Ast* ast = optimizer->ast;
+
+	switch (stmt_type(statement)) {
+		case StmtType::Block: {
+			for (StmtId inner : ast_get<Stmt_Block>(ast, statement)->statements) {
+				this->statement(inner, nesting + 1);
+			}
+		} break;
+
+		// Nothing in a class is hoisted, the loop is left as it is.
+		case StmtType::Class: has_class = true; break;
+
+		case StmtType::Expression: expression(&ast_get<Stmt_Expression>(ast, statement)->expression, nesting); break;
+
+		case StmtType::If: {
+			Stmt_If* stmt = ast_get<Stmt_If>(ast, statement);
+			expression(&stmt->condition, nesting);
+			this->statement(stmt->then_branch, nesting);
+			for (Else_If& else_if : stmt->else_ifs) {
+				expression(&else_if.condition, nesting);
+				this->statement(else_if.then_branch, nesting);
+			}
+			this->statement(stmt->else_branch, nesting);
+		} break;
+
+		case StmtType::Print: expression(&ast_get<Stmt_Print>(ast, statement)->expression, nesting); break;
+		case StmtType::Return: expression(&ast_get<Stmt_Return>(ast, statement)->value, nesting); break;
+
+		case StmtType::Var: {
+			Stmt_Var* stmt = ast_get<Stmt_Var>(ast, statement);
+			for (size_t i = 0; i < stmt->names.size(); i++) {
+				expression(&stmt->initializers[i], nesting);
+				if (stmt->names[i].slot != LOCAL_SLOT_NONE) write(LocalRef{ 0, stmt->names[i].slot }, nesting);
+			}
+		} break;
+
+		case StmtType::While: {
+			Stmt_While* stmt = ast_get<Stmt_While>(ast, statement);
+			is_first_to_run = is_hoisting && statement == loop;
+			expression(&stmt->condition, nesting);
+			is_first_to_run = false;
+			this->statement(stmt->body, nesting);
+		} break;
+
+		default: break;
+	}
+}
+
+// The condition and the body of a loop in a list of a block or function lose the pure expressions
+// that read no local the loop assigns. Each one is computed once, into a final hidden local
+// declared right before the loop (see Optimizer::preheader).
+void Optimizer::hoist_invariants(StmtId loop) {
+	LoopInvariants invariants = { this, loop };
+	invariants.statement(loop, 0);
+	if (invariants.has_class) return;
+
+	invariants.is_hoisting = true;
+	invariants.statement(loop, 0);
+}
+
+// Skipped bodies are only parsed ahead of their first call when their source could fit the budget.
+#define INLINE_SOURCE_BYTES_PER_NODE 16
+
+Stmt_Function* Optimizer::callee_declaration(ExprId callee) {
+	if (expr_type(callee) == ExprType::get) {
+		// Static methods are defined with their class, a method of the same name can't be added later.
+		Expr_Get* get = ast_get<Expr_Get>(ast, callee);
+		const ClassConstants* constants = class_constants(get->object);
+		if (constants == nullptr) return nullptr;
+		for (StmtId method : constants->declaration->methods) {
+			Stmt_Function* declaration = ast_get<Stmt_Function>(ast, method);
+			if (declaration->name == get->name) return declaration->is_static ? declaration : nullptr;
+		}
+		return nullptr;
+	}
+	if (expr_type(callee) != ExprType::variable) return nullptr;
+
+	Expr_Variable* variable = ast_get<Expr_Variable>(ast, callee);
+	if (variable->local.depth != LOCAL_DEPTH_NONE) return nullptr;
+
+	auto declared = functions.find(variable->name);
+	if (declared != functions.end()) return declared->second;
+
+	// Declared in an earlier run, a previous line of the REPL or the program around a lazy body.
+	auto defined = interpreter->globals->values.find(variable->name);
+	if (defined == interpreter->globals->values.end() || defined->second.object.type != JavaType::Function) return nullptr;
+	JavaCallable* callable = (JavaCallable*)defined->second.object.value.function;
+	if (callable->get_type() != CallableType::UserDefined) return nullptr;
+	JavaFunction* function = callable_cast<JavaFunction>(callable);
+	return function->closure == interpreter->globals ? function->declaration : nullptr;
+}
+
+// Parses a skipped body like its first call would, without reporting anything. A body with syntax
+// errors is left skipped, so they're still reported if it's ever called.
+bool Optimizer::parse_body(Stmt_Function* function) {
+	if (!can_parse_bodies || function->body_source.size() > (size_t)interpreter->inline_budget * INLINE_SOURCE_BYTES_PER_NODE) return false;
+
+	bool had_error = JavaError::had_error;
+	JavaError::is_silenced = true;
+	bool is_parsed = parse_skipped_function_body(ast, function, interpreter->class_names);
+	JavaError::is_silenced = false;
+	JavaError::had_error = had_error;
+
+	if (!is_parsed) {
+		function->body = {};
+		function->is_body_parsed = false;
+		return false;
+	}
+	resolve_function(ast, function);
+	optimize_function(interpreter, function);
+	return true;
+}
+
+// Type of the value of an expression when it's known before it runs, JavaType::none otherwise.
+JavaType Optimizer::static_type(ExprId expression) {
+	PureKey key = {};
+	if (pure_key(expression, 0, &key)) return key.type;
+
+	switch (expr_type(expression)) {
+		case ExprType::grouping: return static_type(ast_get<Expr_Grouping>(ast, expression)->expression);
+		case ExprType::logical: return JavaType::_boolean;
+
+		case ExprType::call: {
+			// A body that can be inlined always gets to its return, whose value is cast to the return type.
+			Stmt_Function* function = callee_declaration(ast_get<Expr_Call>(ast, expression)->callee);
+			if (function != nullptr && function->return_type != JavaType::_void && inline_body(function) != nullptr) {
+				return function->return_type;
+			}
+		} break;
+
+		case ExprType::ternary: {
+			Expr_Ternary* expr = ast_get<Expr_Ternary>(ast, expression);
+			JavaType type = static_type(expr->then);
+			if (type == static_type(expr->otherwise)) return type;
+		} break;
+
+		default: break;
+	}
+	return JavaType::none;
+}
+
+// Copies the body of a function into the scope of a call to it, where each local of the function
+// gets a slot of its own. With is_checking set it only finds out whether the body can be copied.
+struct InlineCopy {
+	Optimizer* optimizer;
+	const Stmt_Function* function;
+	bool is_checking = false;
+	bool is_copyable = true;
+	uint32_t calls = 0;
+	std::vector<uint16_t> slots = {};
+	std::vector<bool> is_written = {};
+
+	LocalRef local(LocalRef local, bool is_write);
+	ExprId expression(ExprId expression);
+	StmtId statement(StmtId statement);
+};
+
+// The body has no blocks, so its locals are all in the scope of the function.
+LocalRef InlineCopy::local(LocalRef local, bool is_write) {
+	if (local.depth == LOCAL_DEPTH_NONE) return local;
+	if (local.depth != 0 || local.slot >= function->slot_count) {
+		is_copyable = false;
+		return local;
+	}
+	if (is_checking) return local;
+
+	if (is_write) is_written[local.slot] = true;
+	return LocalRef{ 0, slots[local.slot] };
+}
+
+ExprId InlineCopy::expression(ExprId expression) {
+	if (expression == EXPR_NONE) return expression;
+	Ast* ast = optimizer->ast;
+	ExprId copy = expression;
+
+	switch (expr_type(expression)) {
+		case ExprType::assign: {
+			Expr_Assign* expr = ast_get<Expr_Assign>(ast, expression);
+			ExprId lhs = this->expression(expr->lhs);
+			ExprId rhs = this->expression(expr->rhs);
+			LocalRef local = this->local(expr->local, true);
+			if (is_checking) break;
+			copy = ast_new<Expr_Assign>(ast, lhs, expr->lhs_name, expr->span, rhs);
+			ast_get<Expr_Assign>(ast, copy)->local = local;
+		} break;
+
+		case ExprType::binary: {
+			Expr_Binary* expr = ast_get<Expr_Binary>(ast, expression);
+			ExprId left = this->expression(expr->left);
+			ExprId right = this->expression(expr->right);
+			if (is_checking) break;
+			copy = ast_new<Expr_Binary>(ast, left, expr->_operator, expr->span, right);
+			Expr_Binary* binary = ast_get<Expr_Binary>(ast, copy);
+			binary->left_type = expr->left_type;
+			binary->right_type = expr->right_type;
+			binary->kernel = expr->kernel;
+		} break;
+
+		case ExprType::call: {
+			Expr_Call* expr = ast_get<Expr_Call>(ast, expression);
+			if (optimizer->callee_declaration(expr->callee) == function) is_copyable = false;
+			calls++;
+
+			ExprId callee = this->expression(expr->callee);
+			std::vector<ParseCallInfo> arguments = {};
+			for (const ParseCallInfo& argument : expr->arguments) {
+				arguments.push_back(ParseCallInfo{ this->expression(argument.expr), argument.span });
+			}
+			if (is_checking) break;
+			copy = ast_new<Expr_Call>(ast, callee, expr->paren, arena_push_array(&ast->arena, arguments));
+		} break;
+
+		case ExprType::cast: {
+			Expr_Cast* expr = ast_get<Expr_Cast>(ast, expression);
+			ExprId right = this->expression(expr->right);
+			if (!is_checking) copy = ast_new<Expr_Cast>(ast, expr->type, expr->span, right);
+		} break;
+
+		case ExprType::get: {
+			Expr_Get* expr = ast_get<Expr_Get>(ast, expression);
+			ExprId object = this->expression(expr->object);
+			if (!is_checking) copy = ast_new<Expr_Get>(ast, object, expr->name, expr->span);
+		} break;
+
+		case ExprType::grouping: {
+			ExprId inner = this->expression(ast_get<Expr_Grouping>(ast, expression)->expression);
+			if (!is_checking) copy = ast_new<Expr_Grouping>(ast, inner);
+		} break;
+
+		case ExprType::increment: {
+			Expr_Increment* expr = ast_get<Expr_Increment>(ast, expression);
+			LocalRef local = this->local(expr->local, true);
+			if (is_checking) break;
+			copy = ast_new<Expr_Increment>(ast, expr->name, expr->span, expr->is_positive);
+			ast_get<Expr_Increment>(ast, copy)->local = local;
+		} break;
+
+		case ExprType::literal: {
+			if (!is_checking) copy = ast_new<Expr_Literal>(ast, ast_get<Expr_Literal>(ast, expression)->literal);
+		} break;
+
+		case ExprType::logical: {
+			Expr_Logical* expr = ast_get<Expr_Logical>(ast, expression);
+			ExprId left = this->expression(expr->left);
+			ExprId right = this->expression(expr->right);
+			if (!is_checking) copy = ast_new<Expr_Logical>(ast, left, expr->_operator, expr->span, right);
+		} break;
+
+		case ExprType::set: {
+			Expr_Set* expr = ast_get<Expr_Set>(ast, expression);
+			ExprId lhs = this->expression(expr->lhs);
+			ExprId value = this->expression(expr->value);
+			if (!is_checking) copy = ast_new<Expr_Set>(ast, lhs, expr->rhs_name, expr->span, value);
+		} break;
+
+		case ExprType::ternary: {
+			Expr_Ternary* expr = ast_get<Expr_Ternary>(ast, expression);
+			ExprId condition = this->expression(expr->condition);
+			ExprId then = this->expression(expr->then);
+			ExprId otherwise = this->expression(expr->otherwise);
+			if (!is_checking) copy = ast_new<Expr_Ternary>(ast, condition, then, otherwise, expr->question_mark);
+		} break;
+
+		// Only methods of instances have a `this`.
+		case ExprType::self: is_copyable = false; break;
+
+		case ExprType::unary: {
+			Expr_Unary* expr = ast_get<Expr_Unary>(ast, expression);
+			ExprId right = this->expression(expr->right);
+			if (!is_checking) copy = ast_new<Expr_Unary>(ast, expr->_operator, expr->span, right);
+		} break;
+
+		case ExprType::variable: {
+			Expr_Variable* expr = ast_get<Expr_Variable>(ast, expression);
+			LocalRef local = this->local(expr->local, false);
+			if (is_checking) break;
+			copy = ast_new<Expr_Variable>(ast, expr->name, expr->span, expr->is_function);
+			ast_get<Expr_Variable>(ast, copy)->local = local;
+		} break;
+	}
+	return copy;
+}
+
+// The return at the end is only checked, the returned expression is copied on its own.
+StmtId InlineCopy::statement(StmtId statement) {
+	Ast* ast = optimizer->ast;
+
+	switch (stmt_type(statement)) {
+		case StmtType::Expression: {
+			ExprId expression = this->expression(ast_get<Stmt_Expression>(ast, statement)->expression);
+			if (!is_checking) return ast_new<Stmt_Expression>(ast, expression);
+		} break;
+
+		case StmtType::Print: {
+			Stmt_Print* stmt = ast_get<Stmt_Print>(ast, statement);
+			ExprId expression = this->expression(stmt->expression);
+			if (!is_checking) return ast_new<Stmt_Print>(ast, stmt->span, expression, stmt->has_newline);
+		} break;
+
+		case StmtType::Return: this->expression(ast_get<Stmt_Return>(ast, statement)->value); break;
+
+		case StmtType::Var: {
+			Stmt_Var* stmt = ast_get<Stmt_Var>(ast, statement);
+			std::vector<VarName> names = {};
+			std::vector<ExprId> initializers = {};
+			for (size_t i = 0; i < stmt->names.size(); i++) {
+				initializers.push_back(this->expression(stmt->initializers[i]));
+				VarName name = stmt->names[i];
+				if (name.slot >= function->slot_count) is_copyable = false;
+				else if (!is_checking) name.slot = slots[name.slot];
+				names.push_back(name);
+			}
+			if (is_checking) break;
+			return ast_new<Stmt_Var>(ast, stmt->type, stmt->type_name, stmt->type_span,
+				arena_push_array(&ast->arena, names), arena_push_array(&ast->arena, initializers),
+				stmt->visibility, stmt->is_static, stmt->is_final);
+		} break;
+
+		default: is_copyable = false; break;
+	}
+	return statement;
+}
+
+// A function can be inlined when its parameters and result are numbers or booleans, and its body
+// fits the budget and runs straight through: declarations, expressions and prints, then a return.
+const InlineBody* Optimizer::inline_body(Stmt_Function* function) {
+	if (!function->is_inlinable || interpreter->inline_budget == 0) return nullptr;
+	const auto& optimizing = interpreter->optimizing_functions;
+	if (std::find(optimizing.begin(), optimizing.end(), function) != optimizing.end()) return nullptr;
+
+	auto found = inline_bodies.find(function);
+	if (found != inline_bodies.end()) return found->second.is_inlinable ? &found->second : nullptr;
+	InlineBody& body = inline_bodies[function];
+	body = InlineBody{ false, JavaType::none };
+
+	if (!function->is_body_parsed && !parse_body(function)) return nullptr;
+	for (const Parameter& param : function->params) {
+		if (!is_constant_type(param.first.type)) return nullptr;
+	}
+	bool is_void = function->return_type == JavaType::_void;
+	if (!is_void && !is_constant_type(function->return_type)) return nullptr;
+
+	TreeWalk walk = { ast };
+	InlineCopy check = { this, function, true };
+	const StmtList& statements = function->body;
+	for (uint32_t i = 0; i < statements.count; i++) {
+		if (stmt_type(statements.items[i]) == StmtType::Return && i != statements.count - 1) return nullptr;
+		walk.statement(statements.items[i]);
+		check.statement(statements.items[i]);
+	}
+	if (!check.is_copyable || walk.nodes > interpreter->inline_budget) return nullptr;
+
+	StmtId last = statements.empty() ? STMT_NONE : statements.back();
+	ExprId result = (last != STMT_NONE && stmt_type(last) == StmtType::Return) ? ast_get<Stmt_Return>(ast, last)->value : EXPR_NONE;
+	if (is_void != (result == EXPR_NONE)) return nullptr;
+
+	if (!is_void) {
+		// Typed in the scope of the function, where the locals have their declared types.
+		push_scope(&function->slot_count);
+		for (size_t i = 0; i < function->params.size(); i++) {
+			scopes.back().types.at(i) = function->params[i].first.type;
+		}
+		for (StmtId statement : statements) {
+			if (stmt_type(statement) == StmtType::Var) declare_types(ast_get<Stmt_Var>(ast, statement));
+		}
+		body.result_type = static_type(result);
+		scopes.pop_back();
+
+		bool is_cast = is_java_type_number(body.result_type) && is_java_type_number(function->return_type);
+		if (body.result_type != function->return_type && !is_cast) return nullptr;
+	}
+	body.is_inlinable = true;
+	return &body;
+}
+
+// The call that runs first in the expression, or right after expressions that are pure and can't
+// fail. Those don't change when the statements of the call run before them.
+ExprId* Optimizer::call_site(ExprId* location) {
+	switch (expr_type(*location)) {
+		case ExprType::assign: return call_site(&ast_get<Expr_Assign>(ast, *location)->rhs);
+
+		case ExprType::binary: {
+			Expr_Binary* expr = ast_get<Expr_Binary>(ast, *location);
+			ExprId* site = call_site(&expr->left);
+			if (site != nullptr) return site;
+
+			PureKey key = {};
+			if (!pure_key(expr->left, 0, &key) || key.can_fail) return nullptr;
+			site = call_site(&expr->right);
+			if (site == nullptr) return nullptr;
+
+			// The arguments run before the left operand too, so they can't assign the locals it reads.
+			for (const ParseCallInfo& argument : ast_get<Expr_Call>(ast, *site)->arguments) {
+				PureKey argument_key = {};
+				if (!pure_key(argument.expr, 0, &argument_key)) return nullptr;
+			}
+			return site;
+		} break;
+
+		case ExprType::call: return location;
+		case ExprType::cast: return call_site(&ast_get<Expr_Cast>(ast, *location)->right);
+		case ExprType::grouping: return call_site(&ast_get<Expr_Grouping>(ast, *location)->expression);
+		case ExprType::logical: return call_site(&ast_get<Expr_Logical>(ast, *location)->left);
+		case ExprType::ternary: return call_site(&ast_get<Expr_Ternary>(ast, *location)->condition);
+		case ExprType::unary: return call_site(&ast_get<Expr_Unary>(ast, *location)->right);
+		default: return nullptr;
+	}
+}
+
+// Inlined statements are optimized again in the scope of the call, so arguments that are literals
+// get folded into the body, and the calls in them can be inlined too. Every read of a local they
+// declare goes through the optimizer after its declaration, so a final local that ends up constant
+// is never read and isn't defined.
+void Optimizer::emit(StmtId statement, std::vector<StmtId>* out) {
+	statement = this->statement(statement, true);
+	if (statement != STMT_NONE) statement = inline_calls(statement, out);
+	if (statement == STMT_NONE) return;
+
+	if (stmt_type(statement) == StmtType::Var) {
+		bool is_constant = true;
+		for (const VarName& name : ast_get<Stmt_Var>(ast, statement)->names) {
+			is_constant = is_constant && name.slot != LOCAL_SLOT_NONE && scopes.back().constants.at(name.slot).type != JavaType::none;
+		}
+		if (is_constant) return;
+	}
+	out->push_back(statement);
+}
+
+// The arguments are declared as locals named like the parameters, in the order they're evaluated,
+// and the statements of the body follow. The returned expression takes the place of the call, or
+// goes in a local first when it calls something that could be inlined into it.
+bool Optimizer::inline_call(ExprId* site, bool is_discarded, std::vector<StmtId>* out) {
+	Expr_Call* call = ast_get<Expr_Call>(ast, *site);
+	Stmt_Function* function = callee_declaration(call->callee);
+	if (function == nullptr || std::find(inlining.begin(), inlining.end(), function) != inlining.end()) return false;
+	const InlineBody* body = inline_body(function);
+	if (body == nullptr) return false;
+
+	if (call->arguments.size() != function->params.size()) return false;
+	if (function->return_type == JavaType::_void && !is_discarded) return false;
+	for (size_t i = 0; i < function->params.size(); i++) {
+		if (static_type(call->arguments[i].expr) != function->params[i].first.type) return false;
+	}
+	if (*scopes.back().slot_count + function->slot_count + 1 >= LOCAL_SLOT_NONE - 1) return false;
+
+	InlineCopy copy = { this, function };
+	copy.is_written.resize(function->slot_count, false);
+	for (uint16_t slot = 0; slot < function->slot_count; slot++) {
+		copy.slots.push_back(new_slot(slot < function->params.size() ? function->params[slot].first.type : JavaType::none));
+	}
+	std::vector<StmtId> statements = {};
+	ExprId result = EXPR_NONE;
+	for (StmtId statement : function->body) {
+		if (stmt_type(statement) == StmtType::Return) result = copy.expression(ast_get<Stmt_Return>(ast, statement)->value);
+		else statements.push_back(copy.statement(statement));
+	}
+	bool has_calls = copy.calls > 0;
+
+	for (size_t i = 0; i < function->params.size(); i++) {
+		const ParseCallInfo& argument = call->arguments[i];
+		const Parameter& param = function->params[i];
+		const VarName names[] = { VarName{ param.second, argument.span, copy.slots[i] } };
+		const ExprId initializers[] = { argument.expr };
+		emit(ast_new<Stmt_Var>(ast, java_type_to_token_type(param.first.type), SYMBOL_NONE, argument.span,
+			arena_push_array(&ast->arena, names, 1), arena_push_array(&ast->arena, initializers, 1),
+			Visibility::Local, false, !copy.is_written[i]), out);
+	}
+
+	inlining.push_back(function);
+	for (StmtId statement : statements) {
+		emit(statement, out);
+	}
+	*site = EXPR_NONE;
+	if (result != EXPR_NONE) {
+		if (body->result_type != function->return_type) {
+			result = ast_new<Expr_Cast>(ast, function->return_type, function->span, result);
+		}
+		if (is_discarded) {
+			// A result that can't fail and changes nothing isn't computed.
+			PureKey key = {};
+			if (!pure_key(result, 0, &key) || key.can_fail) emit(ast_new<Stmt_Expression>(ast, result), out);
+		}
+		else if (has_calls) {
+			uint16_t slot = 0;
+			Symbol name = temporary(function->return_type, &slot);
+			emit(temporary_declaration(name, function->span, slot, function->return_type, result, true), out);
+			*site = ast_new<Expr_Variable>(ast, name, function->span, false);
+			ast_get<Expr_Variable>(ast, *site)->local = LocalRef{ 0, slot };
+		}
+		else {
+			*site = expression(result);
+		}
+	}
+	inlining.pop_back();
+
+	interpreter->inlined_calls++;
+	return true;
+}
+
+StmtId Optimizer::inline_calls(StmtId statement, std::vector<StmtId>* out) {
+	ExprId* root = nullptr;
+	switch (stmt_type(statement)) {
+		case StmtType::Expression: root = &ast_get<Stmt_Expression>(ast, statement)->expression; break;
+		case StmtType::If: root = &ast_get<Stmt_If>(ast, statement)->condition; break;
+		case StmtType::Print: root = &ast_get<Stmt_Print>(ast, statement)->expression; break;
+		case StmtType::Return: root = &ast_get<Stmt_Return>(ast, statement)->value; break;
+
+		case StmtType::Var: {
+			// The names after the first are defined before the later initializers run.
+			Stmt_Var* stmt = ast_get<Stmt_Var>(ast, statement);
+			if (!stmt->initializers.empty()) root = &stmt->initializers[0];
+		} break;
+
+		default: break;
+	}
+	if (root == nullptr) return statement;
+
+	bool is_inlined = false;
+	while (*root != EXPR_NONE) {
+		ExprId* site = call_site(root);
+		bool is_discarded = site == root && stmt_type(statement) == StmtType::Expression;
+		if (site == nullptr || !inline_call(site, is_discarded, out)) break;
+		if (*site == EXPR_NONE) return STMT_NONE;
+		is_inlined = true;
+	}
+
+	// The results may fold with the operands around them.
+	if (is_inlined) {
+		*root = expression(*root);
+		if (stmt_type(statement) == StmtType::Var) declare_constants(ast_get<Stmt_Var>(ast, statement));
+	}
+	return statement;
+}
+
+// Roots are the statements of the program that aren't function declarations, a function is used
+// when its name is in a root or in a used function. A name declared more than once at the top level
+// is kept, defining it again is an error the program has to report.
+void Optimizer::remove_unused_functions(StmtList& statements) {
+	std::unordered_map<Symbol, uint32_t> declarations;
+	std::unordered_multimap<Symbol, StmtId> functions;
+	std::unordered_set<Symbol> names;
+	TreeWalk walk = { ast, 0, &names };
+
+	for (StmtId statement : statements) {
+		switch (stmt_type(statement)) {
+			case StmtType::Function: {
+				Symbol name = ast_get<Stmt_Function>(ast, statement)->name;
+				declarations[name]++;
+				functions.insert({ name, statement });
+				continue;
+			}
+			case StmtType::Class: declarations[ast_get<Stmt_Class>(ast, statement)->name]++; break;
+			case StmtType::Var: {
+				for (const VarName& name : ast_get<Stmt_Var>(ast, statement)->names) declarations[name.symbol]++;
+			} break;
+			default: break;
+		}
+		walk.statement(statement);
+	}
+
+	while (!walk.new_names.empty()) {
+		Symbol name = walk.new_names.back();
+		walk.new_names.pop_back();
+		auto range = functions.equal_range(name);
+		for (auto it = range.first; it != range.second; it++) {
+			walk.statement(it->second);
+		}
+	}
+
+	uint32_t count = 0;
+	for (StmtId statement : statements) {
+		if (stmt_type(statement) == StmtType::Function) {
+			Symbol name = ast_get<Stmt_Function>(ast, statement)->name;
+			if (!names.contains(name) && declarations[name] == 1) {
+				removed_statement(statement);
+				continue;
+			}
+		}
+		statements.items[count++] = statement;
+	}
+	statements.count = count;
+}
+
+ExprId Optimizer::expression(ExprId expression) {
+	if (expression == EXPR_NONE) return expression;
+
+	switch (expr_type(expression)) {
+		case ExprType::assign: {
+			Expr_Assign* expr = ast_get<Expr_Assign>(ast, expression);
+			expr->rhs = this->expression(expr->rhs);
+		} break;
+
+		case ExprType::binary: {
+			Expr_Binary* expr = ast_get<Expr_Binary>(ast, expression);
+			expr->left = this->expression(expr->left);
+			expr->right = this->expression(expr->right);
+			if (is_literal(expr->left) && is_literal(expr->right)) return fold(expression);
+
+			// Operands folded from fields or from inlined calls have types the resolver didn't know.
+			if (expr->kernel == BINARY_KERNEL_NONE) {
+				JavaType left = static_type(expr->left);
+				JavaType right = static_type(expr->right);
+				JavaType result = JavaType::none;
+				expr->kernel = pick_binary_kernel(expr->_operator, left, right, &result);
+				if (expr->kernel != BINARY_KERNEL_NONE) {
+					expr->left_type = left;
+					expr->right_type = right;
+				}
+			}
+		} break;
+
+		case ExprType::call: {
+			// A callee that's a get stays one, only its object is optimized.
+			Expr_Call* expr = ast_get<Expr_Call>(ast, expression);
+			if (expr_type(expr->callee) == ExprType::get) {
+				Expr_Get* callee = ast_get<Expr_Get>(ast, expr->callee);
+				callee->object = this->expression(callee->object);
+			}
+			else if (expr_type(expr->callee) != ExprType::variable) {
+				expr->callee = this->expression(expr->callee);
+			}
+			for (ParseCallInfo& argument : expr->arguments) {
+				argument.expr = this->expression(argument.expr);
+			}
+			return fold_call(expression);
+		} break;
+
+		case ExprType::cast: {
+			Expr_Cast* expr = ast_get<Expr_Cast>(ast, expression);
+			expr->right = this->expression(expr->right);
+			if (is_literal(expr->right)) return fold(expression);
+		} break;
+
+		case ExprType::get: {
+			Expr_Get* expr = ast_get<Expr_Get>(ast, expression);
+			expr->object = this->expression(expr->object);
+			return fold_get(expression);
+		} break;
+
+		case ExprType::grouping: {
+			Expr_Grouping* expr = ast_get<Expr_Grouping>(ast, expression);
+			expr->expression = this->expression(expr->expression);
+			if (is_literal(expr->expression)) return expr->expression;
+		} break;
+
+		case ExprType::increment:
+		case ExprType::literal:
+		case ExprType::self:
+			break;
+
+		case ExprType::logical: {
+			Expr_Logical* expr = ast_get<Expr_Logical>(ast, expression);
+			expr->left = this->expression(expr->left);
+			expr->right = this->expression(expr->right);
+			if (is_literal(expr->left) && is_literal(expr->right)) return fold(expression);
+		} break;
+
+		case ExprType::set: {
+			// The left hand side stays a get, the interpreter reads its object.
+			Expr_Set* expr = ast_get<Expr_Set>(ast, expression);
+			Expr_Get* lhs = ast_get<Expr_Get>(ast, expr->lhs);
+			lhs->object = this->expression(lhs->object);
+			expr->value = this->expression(expr->value);
+		} break;
+
+		case ExprType::ternary: {
+			Expr_Ternary* expr = ast_get<Expr_Ternary>(ast, expression);
+			expr->condition = this->expression(expr->condition);
+			expr->then = this->expression(expr->then);
+			expr->otherwise = this->expression(expr->otherwise);
+			if (is_literal(expr->condition)) {
+				const JavaObject& condition = ast_get<Expr_Literal>(ast, expr->condition)->literal;
+				if (condition.type == JavaType::_boolean) {
+					ExprId taken = condition.value._boolean ? expr->then : expr->otherwise;
+					removed_expression(expr->condition);
+					removed_expression(condition.value._boolean ? expr->otherwise : expr->then);
+					interpreter->removed_nodes++;
+					return taken;
+				}
+			}
+		} break;
+
+		case ExprType::unary: {
+			Expr_Unary* expr = ast_get<Expr_Unary>(ast, expression);
+			expr->right = this->expression(expr->right);
+			if (is_literal(expr->right)) return fold(expression);
+		} break;
+
+		case ExprType::variable: {
+			Expr_Variable* expr = ast_get<Expr_Variable>(ast, expression);
+			if (expr->is_function || expr->local.depth == LOCAL_DEPTH_NONE || expr->local.depth >= scopes.size()) break;
+
+			const JavaObject& value = scopes[scopes.size() - 1 - expr->local.depth].constants.at(expr->local.slot);
+			if (value.type != JavaType::none) return literal(value);
+		} break;
+	}
+	return expression;
+}
+
+void optimize_statements(Interpreter* interpreter, StmtList& statements) {
+	Optimizer optimizer = { interpreter, interpreter->ast };
+	optimizer.statements(statements);
+}
+
+void optimize_program(Interpreter* interpreter, StmtList& statements) {
+	Optimizer optimizer = { interpreter, interpreter->ast };
+	optimizer.statements(statements);
+	optimizer.remove_unused_functions(statements);
+}
+
+StmtId optimize_statement(Interpreter* interpreter, StmtId statement) {
+	Optimizer optimizer = { interpreter, interpreter->ast };
+	optimizer.can_parse_bodies = false;
+	return optimizer.statement(statement, true);
+}
+
+void optimize_function(Interpreter* interpreter, Stmt_Function* function) {
+	Optimizer optimizer = { interpreter, interpreter->ast };
+	optimizer.function(function);
+}
+
+void analyze_classes(Interpreter* interpreter, StmtList statements) {
+	Optimizer optimizer = { interpreter, interpreter->ast };
+	for (StmtId statement : statements) {
+		if (stmt_type(statement) == StmtType::Class) {
+			optimizer.analyze_class(ast_get<Stmt_Class>(interpreter->ast, statement));
+		}
+	}
+}
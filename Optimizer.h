@@ -0,0 +1,64 @@
+#pragma once
+
+// Rewrites the syntax tree of a resolved program before it runs (see Resolver.h).
+//
+// Arithmetic, comparisons, casts and logical operators whose operands are literals are folded
+// into a literal, by running them once through the interpreter so they have the exact semantics
+// they would have at runtime. Operations that would fail are left alone, and fail when they run.
+// Reads of final locals initialized with a constant become that constant, and calls to pure
+// natives (see JavaNativeFunction::is_pure) with constant arguments become their result.
+//
+// Static final fields of top level classes initialized with a constant go in a table of their
+// class when the optimizer gets to the Stmt_Class, and reads like `Math.PI` that come after it
+// become the constant.
+//
+// Dead code is taken out of the tree: statements after a return, break or continue, arms of ifs
+// whose condition is a false literal, the arms after one whose condition is a true literal, loops
+// that never run and empty blocks. A whole program also loses the top level functions it never
+// names (see remove_unused_functions).
+//
+// In the bodies of blocks and functions, a pure expression computed again in the same basic block
+// (arithmetic with a typed kernel, casts, unary operators and calls to pure natives whose result
+// type is known, over locals and literals) is computed once into a hidden local named `$t<slot>`.
+// Its first evaluation assigns the local and the repeats read it, until a local it reads is assigned.
+//
+// Pure expressions in the condition and the body of a while loop that read no local the loop assigns
+// are computed once into a final `$t<slot>` declared right before the loop, and the loop reads that
+// local instead. The ones that may fail, a division or an operation on a parameter (arguments aren't
+// converted to the types of the parameters), are only hoisted from the condition, and only when
+// nothing before them in it may fail or have an effect, since they run anyway when the condition is
+// first tested. That is the case of the `(int)sqrt(n)` of `d <= (int)sqrt(n)`.
+//
+// Calls to top level functions and static methods whose body runs straight through (declarations,
+// expressions and prints, then a return) and has at most --inline-budget nodes, 32 by default, are
+// replaced by the body. The arguments go in locals named like the parameters, so a literal argument
+// folds into the body. Only the call a statement evaluates first is inlined, and only when its
+// arguments have the types of the parameters, so nothing changes order and no conversion is lost.
+// Functions annotated with @NoInline are never inlined.
+//
+// Folded expressions are replaced by new literal nodes, the old ones stay in the Ast unused.
+
+#include "Ast.h"
+
+#include <unordered_map>
+
+// Most nodes the body of a function can have to be inlined, see --inline-budget.
+#define INLINE_DEFAULT_BUDGET 32
+
+class Interpreter;
+
+struct ClassConstants {
+	const Stmt_Class* declaration;
+	std::unordered_map<Symbol, JavaObject> fields = {};
+};
+
+// Lists are compacted in place when statements are removed.
+void optimize_statements(Interpreter* interpreter, StmtList& statements);
+// Also removes the unused functions, for a program that is known as a whole before it runs.
+void optimize_program(Interpreter* interpreter, StmtList& statements);
+// Returns the statement to run instead, STMT_NONE when there's nothing left of it.
+StmtId optimize_statement(Interpreter* interpreter, StmtId statement);
+// Bodies skipped by the parser are optimized once they are parsed and resolved.
+void optimize_function(Interpreter* interpreter, Stmt_Function* function);
+// Only fills the tables of the classes, for programs loaded already optimized from the cache.
+void analyze_classes(Interpreter* interpreter, StmtList statements);
@@ -2,64 +2,99 @@
 #include "Error.h"
 #include "AstPrinter.h"
 
+#include <array>
 #include <string>
 #include <unordered_map>
 #include <stdarg.h>
+#include <assert.h>
 
 #if defined(_DEBUG) && (defined(_WIN32) || defined(_WIN64))
 	#include <stdlib.h>
 	#include <crtdbg.h>
-	#define DBG_new new (_NORMAL_BLOCK, __FILE__, __LINE__)
-#else
-	#define DBG_new new
 #endif
 
 
-Parser::Parser(std::vector<Token>& _tokens):
-	tokens(_tokens)
+Parser::Parser(Lexer& _lexer):
+	lexer(_lexer),
+	owned_ast(ast_make()),
+	ast(&owned_ast)
+{
+}
+
+Parser::Parser(Lexer& _lexer, Ast* _ast):
+	lexer(_lexer),
+	ast(_ast)
 {
 }
 
 Parser::~Parser() {
+	if (ast == &owned_ast) ast_free(&owned_ast);
 }
 
-Expr *Parser::parse_expression() {
+ExprId Parser::parse_expression() {
 	try {
 		return expression();
 	}
 	catch (Error error) {
 		(void)error;
-		return nullptr;
+		return EXPR_NONE;
 	}
 }
 
-std::vector<Stmt*>* Parser::parse_statements() {
-	std::vector<Stmt*>* statements = DBG_new std::vector<Stmt*>();
+StmtList Parser::parse_statements() {
+	std::vector<StmtId> statements;
 
 	while (!is_at_end()) {
 		try {
-			statements->emplace_back(declaration());
+			statements.emplace_back(declaration());
 		}
 		catch (Error error) {
 			(void)error;
-			delete statements;
 			synchronize();
-			return nullptr;
+			return {};
 		}
 	}
 
-	return statements;
+	return arena_push_array(&ast->arena, statements);
+}
+
+StmtId Parser::parse_statement() {
+	if (is_at_end()) return STMT_NONE;
+
+	try {
+		return declaration();
+	}
+	catch (Error error) {
+		(void)error;
+		synchronize();
+		return STMT_NONE;
+	}
 }
 
-void Parser::statements_free(std::vector<Stmt*>* statements) {
-	if (statements == nullptr) return;
-	for (int i = 0; i < statements->size(); i++) {
-		stmt_free(statements->at(i));
+bool Parser::parse_function_body(Stmt_Function* function) {
+	this->func_level = 1;
+	this->class_level = function->is_method ? 1 : 0;
+
+	try {
+		function->body = block_statement();
+	}
+	catch (Error error) {
+		(void)error;
+		return false;
 	}
-	delete statements;
+	function->is_body_parsed = true;
+	return !JavaError::had_error;
 }
 
-Stmt* Parser::declaration() {
+bool parse_skipped_function_body(Ast* ast, Stmt_Function* function, const std::set<Symbol>& class_names) {
+	assert(!function->is_body_parsed);
+	Lexer lexer(function->body_source.data(), function->body_source.size(), function->body_line, function->body_column, &ast->arena);
+	Parser parser(lexer, ast);
+	parser.class_names = class_names;
+	return parser.parse_function_body(function);
+}
+
+StmtId Parser::declaration() {
 	if (match(TokenType::_abstract)) return class_declaration(true);
 	if (match(TokenType::_class)) return class_declaration(false);
 	if (match_constructor()) return fun_declaration(TokenType::type_void, make__init__token(peek()), Visibility::Public, false);
@@ -68,12 +103,28 @@ Stmt* Parser::declaration() {
 		return var_declaration(previous(), Visibility::Package, false, false);
 	}
 	if (match_any_modifier()) return complex_var_declaration(previous().type);
+	if (match(TokenType::at)) return annotated_declaration();
 
 	return statement();
 }
 
+// The only annotation is @NoInline, it keeps the optimizer from copying the body of a function
+// into the places that call it.
+StmtId Parser::annotated_declaration() {
+	Token name = consume(TokenType::identifier, "Expected annotation name after '@'.");
+	if (name.lexeme != "NoInline") {
+		throw error(name, "Unknown annotation.");
+	}
+	StmtId id = declaration();
+	if (stmt_type(id) != StmtType::Function) {
+		throw error(name, "Only functions can be annotated.");
+	}
+	ast_get<Stmt_Function>(ast, id)->is_inlinable = false;
+	return id;
+}
+
 
-Stmt* Parser::class_declaration(bool is_abstract) {
+StmtId Parser::class_declaration(bool is_abstract) {
 	if (is_abstract) {
 		consume(TokenType::_class, "Expected 'class' after keyword 'abstract'.");
 	}
@@ -81,28 +132,28 @@ Stmt* Parser::class_declaration(bool is_abstract) {
 	if (class_level != 0) {
 		throw error(name, "Can't have nested classes.");
 	}
-	if (class_names.contains(name.lexeme)) {
+	if (class_names.contains(name.symbol)) {
 		throw error(name, "Class is already defined.");
 	}
-	class_names.insert(name.lexeme);
+	class_names.insert(name.symbol);
 
 	consume(TokenType::curly_left, "Expected '{' after class name.");
-	Stmt_Class* c = DBG_new Stmt_Class{name, is_abstract};
+	StmtId id = ast_new<Stmt_Class>(ast, name.symbol, ast_new_span(ast, name), is_abstract);
+	std::vector<StmtId> attributes;
+	std::vector<StmtId> methods;
 
 	this->class_level++;
 
 	while (!check(TokenType::curly_right) && !is_at_end()) {
-		Stmt* stmt = declaration();
+		StmtId stmt = declaration();
 
-		switch (stmt->get_type()) {
+		switch (stmt_type(stmt)) {
 			case StmtType::Var: {
-				Stmt_Var* attribute = dynamic_cast<Stmt_Var*>(stmt);
-				c->attributes.push_back(attribute);
+				attributes.push_back(stmt);
 			} break;
 
 			case StmtType::Function: {
-				Stmt_Function* method = dynamic_cast<Stmt_Function*>(stmt);
-				c->methods.push_back(method);
+				methods.push_back(stmt);
 			} break;
 
 			default: throw error(previous(), "Expected only variable and method declarations inside class body.");
@@ -111,10 +162,13 @@ Stmt* Parser::class_declaration(bool is_abstract) {
 
 	consume(TokenType::curly_right, "Expected '}' after class body.");
 	this->class_level--;
-	return c;
+	Stmt_Class* c = ast_get<Stmt_Class>(ast, id);
+	c->attributes = arena_push_array(&ast->arena, attributes);
+	c->methods = arena_push_array(&ast->arena, methods);
+	return id;
 }
 
-Stmt* Parser::complex_var_declaration(TokenType first_modifier) {
+StmtId Parser::complex_var_declaration(TokenType first_modifier) {
 	enum { STATIC = 0, VISIBILITY, FINAL, COUNT };
 	size_t counts[COUNT] = {0};
 
@@ -131,6 +185,7 @@ Stmt* Parser::complex_var_declaration(TokenType first_modifier) {
 			case TokenType::_private:   // falltrough
 			case TokenType::_protected: return VISIBILITY;
 			case TokenType::_final:     return FINAL;
+			default: break;
 		}
 		throw error(previous(), "Expected a valid entry in the counts array.");
 	};
@@ -165,7 +220,7 @@ Stmt* Parser::complex_var_declaration(TokenType first_modifier) {
 	return var_declaration(type, visibility, counts[STATIC] == 1, counts[FINAL] == 1);
 }
 
-Stmt* Parser::fun_declaration(TokenType return_type_token_type, Token name, Visibility visibility, bool is_static) {
+StmtId Parser::fun_declaration(TokenType return_type_token_type, Token name, Visibility visibility, bool is_static) {
 	if (this->func_level != 0) {
 		throw error(previous(), "Can't have nested functions.");
 	}
@@ -173,28 +228,25 @@ Stmt* Parser::fun_declaration(TokenType return_type_token_type, Token name, Visi
 
 	const JavaType return_type = token_type_to_java_type(return_type_token_type);
 	if (return_type == JavaType::none) {
-		throw error(tokens[current - 2], "Invalid java type.");
+		throw error(token_at(current - 2), "Invalid java type.");
 	}
 
-	auto parameters = DBG_new std::vector<std::pair<JavaTypeInfo, std::string>>();
+	std::vector<Parameter> parameters;
 	if (!check(TokenType::paren_right)) {
 		do {
-			if (parameters->size() >= 255) {
-				delete parameters;
+			if (parameters.size() >= 255) {
 				throw error(peek(), "Can't have more than 255 parameters.");
 			}
-			if (!check_java_type()) { delete parameters; }
 			Token type = consume_java_type("Expected parameter type.");
-			if (!check(TokenType::identifier)) { delete parameters; }
 			Token parameter = consume(TokenType::identifier, "Expected parameter name.");
-			parameters->emplace_back(JavaTypeInfo{token_type_to_java_type(type.type), type.lexeme}, parameter.lexeme);
+			parameters.emplace_back(JavaTypeInfo{token_type_to_java_type(type.type), type.lexeme}, parameter.symbol);
 		} while (match(TokenType::comma));
 	}
 	consume(TokenType::paren_right, "Expected ')' in function declaration.");
 
-	std::unordered_map<std::string, int> counts = {};
-	for (int i = 0; i < parameters->size(); i++) {
-		const std::string &name = parameters->at(i).second;
+	std::unordered_map<Symbol, int> counts = {};
+	for (int i = 0; i < parameters.size(); i++) {
+		Symbol name = parameters.at(i).second;
 		if (counts.contains(name)) {
 			counts[name] += 1;
 		}
@@ -205,24 +257,28 @@ Stmt* Parser::fun_declaration(TokenType return_type_token_type, Token name, Visi
 
 	for (auto const& [key, value] : counts) {
 		if (value != 1) {
-			delete parameters;
 			throw this->error(previous(), "Function argument names can't repeat!");
 		}
 	}
 
 	consume(TokenType::curly_left, "Expected '{' in function declaration.");
-	std::vector<Stmt*>* body = heap_block_statement();
+	if (skip_function_bodies) {
+		StmtId id = ast_new<Stmt_Function>(ast, return_type, name.symbol, ast_new_span(ast, name), visibility, is_static, this->class_level == 1, arena_push_array(&ast->arena, parameters), StmtList{});
+		skip_block(ast_get<Stmt_Function>(ast, id));
+		this->func_level--;
+		return id;
+	}
+	StmtList body = block_statement();
 
 	this->func_level--;
-	return DBG_new Stmt_Function{ return_type, name, visibility, is_static, this->class_level == 1, parameters, body };
+	return ast_new<Stmt_Function>(ast, return_type, name.symbol, ast_new_span(ast, name), visibility, is_static, this->class_level == 1, arena_push_array(&ast->arena, parameters), body);
 }
 
-Stmt* Parser::var_declaration(Token type, Visibility visibility, bool is_static, bool is_final) {
-	std::vector<Token> names = {};
-	std::vector<Expr*> initializers = {};
+StmtId Parser::var_declaration(Token type, Visibility visibility, bool is_static, bool is_final) {
+	std::vector<VarName> names = {};
+	std::vector<ExprId> initializers = {};
 
 	Token first_name = consume(TokenType::identifier, "Expected variable name in variable declaration.");
-	names.push_back(first_name);
 
 	if (match(TokenType::paren_left)) {
 		if (is_final) {
@@ -232,33 +288,32 @@ Stmt* Parser::var_declaration(Token type, Visibility visibility, bool is_static,
 	}
 
 	// Now it's certain that it's a variable and not a function.
+	names.emplace_back(first_name.symbol, ast_new_span(ast, first_name));
 
 	if (type.type == TokenType::type_void) {
 		throw error(type, "Type can't be void in variable definition.");
 	}
 	
-	Expr* first_initializer = nullptr;
+	ExprId first_initializer = EXPR_NONE;
 	if (match(TokenType::equal)) {
 		// Always call one level of precedence above the comma operator.
-		first_initializer = ternary_conditional();
-		expr_freelist.push_back(first_initializer);
+		first_initializer = binary_expression(Precedence::ternary);
 	}
-	if (first_initializer == nullptr && is_final) {
+	if (first_initializer == EXPR_NONE && is_final) {
 		throw error(previous(), "Constant must have an initializer.");
 	}
 	initializers.push_back(first_initializer);
 
 	while (match(TokenType::comma)) {
 		Token name = consume_no_reset(TokenType::identifier, "Expected variable name in variable declaration.");
-		names.push_back(name);
+		names.emplace_back(name.symbol, ast_new_span(ast, name));
 
-		Expr* initializer = nullptr;
+		ExprId initializer = EXPR_NONE;
 		if (match(TokenType::equal)) {
 			// Always call one level of precedence above the comma operator.
-			initializer = ternary_conditional();
-			expr_freelist.push_back(initializer);
+			initializer = binary_expression(Precedence::ternary);
 		}
-		if (initializer == nullptr && is_final) {
+		if (initializer == EXPR_NONE && is_final) {
 			throw error(previous(), "Constant must have an initializer.");
 		}
 		initializers.push_back(initializer);
@@ -269,14 +324,15 @@ Stmt* Parser::var_declaration(Token type, Visibility visibility, bool is_static,
 	}
 	advance();
 
-	return DBG_new Stmt_Var{type, names, initializers, visibility, is_static, is_final};
+	Symbol type_name = (type.type == TokenType::type_user_defined) ? type.symbol : SYMBOL_NONE;
+	return ast_new<Stmt_Var>(ast, type.type, type_name, ast_new_span(ast, type), arena_push_array(&ast->arena, names), arena_push_array(&ast->arena, initializers), visibility, is_static, is_final);
 }
 
-Stmt* Parser::statement() {
+StmtId Parser::statement() {
 	if (match(TokenType::sout)) return print_statement(false);
 	if (match(TokenType::soutln)) return print_statement(true);
 	if (match(TokenType::_return)) return return_statement();
-	if (match(TokenType::curly_left)) return DBG_new Stmt_Block{ block_statement() };
+	if (match(TokenType::curly_left)) return ast_new<Stmt_Block>(ast, block_statement());
 	if (match(TokenType::_if)) return if_statement();
 	if (match(TokenType::_while)) return while_statement();
 	if (match(TokenType::_for)) return for_statement();
@@ -286,26 +342,26 @@ Stmt* Parser::statement() {
 	return expression_statement();
 }
 
-Stmt* Parser::continue_statement() {
+StmtId Parser::continue_statement() {
 	if (loop_level == 0) throw error(previous(), "Can't use continue statement outside a loop");
 	consume(TokenType::semicolon, "Expected ';' after continue statement.");
-	return DBG_new Stmt_Continue{};
+	return ast_new<Stmt_Continue>(ast);
 }
 
-Stmt* Parser::break_statement() {
+StmtId Parser::break_statement() {
 	if (loop_level == 0) throw error(previous(), "Can't use break statement outside a loop");
 	consume(TokenType::semicolon, "Expected ';' after break statement.");
-	return DBG_new Stmt_Break{};
+	return ast_new<Stmt_Break>(ast);
 }
 
-Stmt* Parser::for_statement() {
+StmtId Parser::for_statement() {
 	this->loop_level++;
 	Token token = previous();
 	consume(TokenType::paren_left, "Expect '(' before 'for' initializer.");
 
-	Stmt* initializer;
+	StmtId initializer;
 	if (match(TokenType::semicolon)) {
-		initializer = nullptr;
+		initializer = STMT_NONE;
 	}
 	else if (match_java_type()) {
 		initializer = var_declaration(previous(), Visibility::Local, false, false);
@@ -314,86 +370,76 @@ Stmt* Parser::for_statement() {
 		initializer = expression_statement();
 	}
 
-	Expr* condition = nullptr;
+	ExprId condition = EXPR_NONE;
 	if (!check(TokenType::semicolon)) {
 		condition = parse_expression();
 	}
 	if (!match(TokenType::semicolon)) {
-		stmt_free(initializer);
-		expr_free(condition);
 		throw JAVA_RUNTIME_ERROR(previous(), "Expected ';' after 'for' condition.");
 	}
 
-	Expr* increment = nullptr;
+	ExprId increment = EXPR_NONE;
 	if (!check(TokenType::paren_right)) {
 		increment = parse_expression();
 	}
 	if (!match(TokenType::paren_right)) {
-		stmt_free(initializer);
-		expr_free(condition);
-		expr_free(increment);
 		throw JAVA_RUNTIME_ERROR(previous(), "Expected ')' after 'for' increment.");
 	}
 
-	Stmt* body = statement();
+	StmtId body = statement();
 	this->loop_level--;
 
-	if (increment != nullptr) {
-		Stmt_Expression* increment_statement = DBG_new Stmt_Expression{increment};
-		if (body->get_type() == StmtType::Block) {
-			Stmt_Block* block = dynamic_cast<Stmt_Block*>(body);
-			block->statements.push_back(increment_statement);
+	if (increment != EXPR_NONE) {
+		StmtId increment_statement = ast_new<Stmt_Expression>(ast, increment);
+		if (stmt_type(body) == StmtType::Block) {
+			Stmt_Block* block = ast_get<Stmt_Block>(ast, body);
+			std::vector<StmtId> statements(block->statements.begin(), block->statements.end());
+			statements.emplace_back(increment_statement);
+			block->statements = arena_push_array(&ast->arena, statements);
 		}
 		else {
-			std::vector<Stmt*> statements;
-			statements.emplace_back(body);
-			statements.emplace_back((Stmt*)increment_statement);
-			body = DBG_new Stmt_Block{ statements };
+			StmtId statements[] = { body, increment_statement };
+			body = ast_new<Stmt_Block>(ast, arena_push_array(&ast->arena, statements, 2));
 		}
 	}
 
-	if (condition == nullptr) {
+	if (condition == EXPR_NONE) {
 		JavaObject literal = { JavaType::_boolean, JavaValue{} };
 		literal.value._boolean = true;
-		condition = DBG_new Expr_Literal{literal};
+		condition = ast_new<Expr_Literal>(ast, literal);
 	}
-	body = DBG_new Stmt_While{token, condition, body, increment != nullptr};
+	body = ast_new<Stmt_While>(ast, ast_new_span(ast, token), condition, body, token.type, increment != EXPR_NONE);
 
-	if (initializer != nullptr) {
-		std::vector<Stmt*> statements;
-		statements.emplace_back(initializer);
-		statements.emplace_back(body);
-		body = DBG_new Stmt_Block{ statements };
+	if (initializer != STMT_NONE) {
+		StmtId statements[] = { initializer, body };
+		body = ast_new<Stmt_Block>(ast, arena_push_array(&ast->arena, statements, 2));
 	}
 
 	return body;
 }
 
-Stmt* Parser::while_statement() {
+StmtId Parser::while_statement() {
 	this->loop_level++;
 	Token token = previous();
 	consume(TokenType::paren_left, "Expect '(' before 'while' condition.");
-	Expr* condition = parse_expression();
-	expr_freelist.push_back(condition);
+	ExprId condition = parse_expression();
 	consume(TokenType::paren_right, "Expect ')' after 'while' condition.");
-	Stmt* body = statement();
+	StmtId body = statement();
 	this->loop_level--;
 
-	return DBG_new Stmt_While{token, condition, body, false};
+	return ast_new<Stmt_While>(ast, ast_new_span(ast, token), condition, body, token.type, false);
 }
 
-Stmt* Parser::if_statement() {
+StmtId Parser::if_statement() {
 	Token token = previous();
 
 	consume(TokenType::paren_left, "Expect '(' after 'if'.");
-	Expr* condition = parse_expression();
-	expr_freelist.push_back(condition);
+	ExprId condition = parse_expression();
 	consume(TokenType::paren_right, "Expect ')' after condition in 'if'.");
 	if (is_at_end()) {
-		expr_free(condition);
 		throw error(peek(), "Expect statement after ')' in 'if'.");
 	}
-	Stmt* then_branch = statement();
+	StmtId then_branch = statement();
 
 	std::vector<Else_If> else_ifs = {};
 	while (check(TokenType::_else)) {
@@ -401,307 +447,247 @@ Stmt* Parser::if_statement() {
 			advance(); // consume else
 			Token else_if_token = advance(); // consume if
 			if (!match(TokenType::paren_left)) {
-				expr_free(condition);
-				stmt_free(then_branch);
-				for (Else_If else_if : else_ifs) {
-					if (else_if.condition != nullptr) expr_free((Expr*)else_if.condition);
-					if (else_if.then_branch != nullptr) stmt_free((Stmt*)else_if.then_branch);
-				}
 				throw error(peek(), "Expected '(' after 'else if'.");
 			}
-			Expr* else_if_condition = parse_expression();
+			ExprId else_if_condition = parse_expression();
 			if (!match(TokenType::paren_right)) {
-				expr_free(condition);
-				stmt_free(then_branch);
-				expr_free(else_if_condition);
-				for (Else_If else_if : else_ifs) {
-					if (else_if.condition != nullptr) expr_free((Expr*)else_if.condition);
-					if (else_if.then_branch != nullptr) stmt_free((Stmt*)else_if.then_branch);
-				}
 				throw error(peek(), "Expected ')' after condition in 'else if'.");
 			}
 			if (is_at_end()) {
-				expr_free(condition);
-				stmt_free(then_branch);
-				expr_free(else_if_condition);
-				for (Else_If else_if : else_ifs) {
-					if (else_if.condition != nullptr) expr_free((Expr*)else_if.condition);
-					if (else_if.then_branch != nullptr) stmt_free((Stmt*)else_if.then_branch);
-				}
 				throw error(peek(), "Expected statement after ')' in 'else if'.");
 			}
-			Stmt* else_if_then_branch = statement();
-			else_ifs.emplace_back(else_if_token, else_if_condition, else_if_then_branch);
+			StmtId else_if_then_branch = statement();
+			else_ifs.emplace_back(ast_new_span(ast, else_if_token), else_if_condition, else_if_then_branch);
 		}
 		else {
 			break;
 		}
 	}
 
-	Stmt* else_branch = nullptr;
+	StmtId else_branch = STMT_NONE;
 	if (match(TokenType::_else)) {
 		else_branch = statement();
 	}
 
-	return DBG_new Stmt_If{token, condition, then_branch, else_ifs, else_branch};
+	return ast_new<Stmt_If>(ast, ast_new_span(ast, token), condition, then_branch, arena_push_array(&ast->arena, else_ifs), else_branch);
 }
 
-Stmt* Parser::print_statement(const bool has_newline) {
+StmtId Parser::print_statement(const bool has_newline) {
 	const Token token = previous();
 	consume(TokenType::paren_left, "Expected '(' before expression in print statement.");
-	Expr* value = parse_expression();
-	expr_freelist.push_back(value);
+	ExprId value = parse_expression();
 	consume(TokenType::paren_right, "Expected ')' after expression in print statement.");
 	consume(TokenType::semicolon, "Expected ';' after ')' in print statement.");
-	return DBG_new Stmt_Print(token, value, has_newline);
+	return ast_new<Stmt_Print>(ast, ast_new_span(ast, token), value, has_newline);
 }
 
-Stmt* Parser::return_statement() {
+StmtId Parser::return_statement() {
 	if (this->func_level != 1) {
 		throw error(previous(), "Expected return statement in a function body.");
 	}
 	Token name = previous();
 
-	Expr* value = nullptr;
+	ExprId value = EXPR_NONE;
 	if (!check(TokenType::semicolon)) {
 		value = parse_expression();
-		expr_freelist.push_back(value);
 	}
 	consume(TokenType::semicolon, "Expected ';' in return statement.");
 
-	return DBG_new Stmt_Return{name.lexeme, name.line, name.column, value};
+	return ast_new<Stmt_Return>(ast, ast_new_span(ast, name), value);
 }
 
-Stmt* Parser::expression_statement() {
-	Expr* value = parse_expression();
-	expr_freelist.push_back(value);
+StmtId Parser::expression_statement() {
+	ExprId value = parse_expression();
 	consume(TokenType::semicolon, "Expected ';' after value in expression statement.");
-	return DBG_new Stmt_Expression(value);
+	return ast_new<Stmt_Expression>(ast, value);
 }
 
-std::vector<Stmt*>* Parser::heap_block_statement() {
-	auto statements = DBG_new std::vector<Stmt*>();
+StmtList Parser::block_statement() {
+	std::vector<StmtId> statements = {};
 	while (!check(TokenType::curly_right) && !is_at_end()) {
-		Stmt* stmt = declaration();
-		statements->emplace_back(stmt);
-		stmt_freelist.push_back(stmt);
+		statements.emplace_back(declaration());
 	}
-	if (!check(TokenType::curly_right)) { delete statements; }
 	consume(TokenType::curly_right, "Expect '}' at the end of the block.");
-	return statements;
+	return arena_push_array(&ast->arena, statements);
 }
 
-std::vector<Stmt*> Parser::block_statement() {
-	std::vector<Stmt*> statements = {};
-	while (!check(TokenType::curly_right) && !is_at_end()) {
-		Stmt* stmt = declaration();
-		statements.emplace_back(stmt);
-		stmt_freelist.push_back(stmt);
-	}
-	consume(TokenType::curly_right, "Expect '}' at the end of the block.");
-	return statements;
-}
-
-Expr* Parser::expression() {
-	return comma_operator();
-}
-
-Expr* Parser::comma_operator() {
-	Expr* expr = ternary_conditional();
-
-	while (match(TokenType::comma)) {
-		expr_free(expr);
-		expr = ternary_conditional();
-	}
-
-	return expr;
-}
-
-Expr* Parser::ternary_conditional() {
-	Expr *expr = assignment();
-
-	if (match(TokenType::question)) {
-		Token question_mark = previous();
-		expr_freelist.push_back(expr);
+// Steps over the tokens of a block up to its matching '}', after the '{' was consumed.
+void Parser::skip_block(Stmt_Function* function) {
+	const Token& curly_left = previous();
+	const char* start = curly_left.lexeme.data() + curly_left.lexeme.size();
+	function->body_line = curly_left.line;
+	function->body_column = curly_left.column + 1;
 
+	uint32_t depth = 1;
+	while (depth > 0) {
 		if (is_at_end()) {
-			throw error(question_mark, "Expected then branch after '?' in ternary.");
+			throw error(peek(), "Expect '}' at the end of the block.");
 		}
+		TokenType type = advance().type;
+		if (type == TokenType::curly_left) depth++;
+		else if (type == TokenType::curly_right) depth--;
+	}
+
+	const Token& curly_right = previous();
+	function->body_source = std::string_view(start, curly_right.lexeme.data() + curly_right.lexeme.size() - start);
+	function->is_body_parsed = false;
+}
+
+// Precedence of each token when it comes right after an operand, none if it isn't an infix operator.
+static constexpr auto infix_precedences = []() {
+	std::array<Precedence, (size_t)TokenType::count> table = {};
+	table[(size_t)TokenType::comma]         = Precedence::comma;
+	table[(size_t)TokenType::question]      = Precedence::ternary;
+	table[(size_t)TokenType::equal]         = Precedence::assignment;
+	table[(size_t)TokenType::_or]           = Precedence::logical_or;
+	table[(size_t)TokenType::_and]          = Precedence::logical_and;
+	table[(size_t)TokenType::not_equal]     = Precedence::equality;
+	table[(size_t)TokenType::equal_equal]   = Precedence::equality;
+	table[(size_t)TokenType::greater]       = Precedence::comparison;
+	table[(size_t)TokenType::greater_equal] = Precedence::comparison;
+	table[(size_t)TokenType::less]          = Precedence::comparison;
+	table[(size_t)TokenType::less_equal]    = Precedence::comparison;
+	table[(size_t)TokenType::bitwise_or]    = Precedence::bitwise_or;
+	table[(size_t)TokenType::bitwise_xor]   = Precedence::bitwise_xor;
+	table[(size_t)TokenType::bitwise_and]   = Precedence::bitwise_and;
+	table[(size_t)TokenType::left_shift]    = Precedence::bitwise_shift;
+	table[(size_t)TokenType::right_shift]   = Precedence::bitwise_shift;
+	table[(size_t)TokenType::minus]         = Precedence::term;
+	table[(size_t)TokenType::plus]          = Precedence::term;
+	table[(size_t)TokenType::slash]         = Precedence::factor;
+	table[(size_t)TokenType::star]          = Precedence::factor;
+	table[(size_t)TokenType::percent_sign]  = Precedence::factor;
+	return table;
+}();
+
+static inline Precedence next_precedence(Precedence precedence) {
+	return (Precedence)((uint8_t)precedence + 1);
+}
+
+ExprId Parser::expression() {
+	return binary_expression(Precedence::comma);
+}
+
+// Keeps the nesting depth of the operands up to date, even when a parse error unwinds the stack.
+struct NestingGuard {
+	uint32_t& depth;
+
+	NestingGuard(uint32_t& p_depth): depth(p_depth) { depth++; }
+	~NestingGuard() { depth--; }
+};
+
+// Precedence climbing over the infix operators. Everything binds to the left except assignment
+// and the ternary, which parse their right hand side at their own precedence.
+ExprId Parser::binary_expression(Precedence min_precedence) {
+	// Every nested expression goes through here, whether it's in parentheses, in the arguments of
+	// a call or on the right of an operator, assignments and ternaries included.
+	NestingGuard guard(nesting_depth);
+	if (nesting_depth > PARSER_MAX_NESTING_DEPTH) {
+		throw error(peek(), "Expression is nested too deeply.");
+	}
+	ExprId expr = unary();
 
-		Expr *then = expression();
-		expr_freelist.push_back(then);
-		consume(TokenType::colon, "Expected ':' after then branch in ternary operator.");
-		Expr *otherwise = ternary_conditional();
-		expr = DBG_new Expr_Ternary{ expr, then, otherwise, question_mark };
-	}
+	while (true) {
+		Precedence precedence = infix_precedences[(size_t)peek().type];
+		if (precedence == Precedence::none || precedence < min_precedence) break;
+		Token _operator = advance();
+
+		switch (precedence) {
+			case Precedence::comma: {
+				// Only the value on the right is kept.
+				expr = binary_expression(Precedence::ternary);
+			} break;
 
-	return expr;
-}
+			case Precedence::ternary: {
+				if (is_at_end()) {
+					throw error(_operator, "Expected then branch after '?' in ternary.");
+				}
+				ExprId then = expression();
+				consume(TokenType::colon, "Expected ':' after then branch in ternary operator.");
+				ExprId otherwise = binary_expression(Precedence::ternary);
+				expr = ast_new<Expr_Ternary>(ast, expr, then, otherwise, ast_new_span(ast, _operator));
+			} break;
 
-Expr* Parser::assignment() {
-	Expr* expr = logical_or();
+			case Precedence::assignment: {
+				ExprId rhs = binary_expression(Precedence::assignment);
+				expr = assignment(expr, _operator, rhs);
+			} break;
 
-	if (match(TokenType::equal)) {
-		Token equals = previous();
-		Expr* rhs = assignment();
+			case Precedence::logical_or:
+			case Precedence::logical_and: {
+				ExprId right = binary_expression(next_precedence(precedence));
+				expr = ast_new<Expr_Logical>(ast, expr, _operator.type, ast_new_span(ast, _operator), right);
+			} break;
 
-		switch (expr->get_type()) {
-			case ExprType::variable: {
-				Expr_Variable* variable = dynamic_cast<Expr_Variable*>(expr);
-				return DBG_new Expr_Assign{variable, variable->name, variable->line, variable->column, rhs};
-			}
-			case ExprType::get: {
-				Expr_Get* get = dynamic_cast<Expr_Get*>(expr);
-				return DBG_new Expr_Set{get, get->name, get->line, get->column, rhs};
-			}
+			default: {
+				ExprId right = binary_expression(next_precedence(precedence));
+				expr = ast_new<Expr_Binary>(ast, expr, _operator.type, ast_new_span(ast, _operator), right);
+			} break;
 		}
-
-		expr_free(expr);
-		expr_free(rhs);
-		throw error(equals, "Invalid assignment target.");
-	}
-
-	return expr;
-}
-
-Expr* Parser::logical_or() {
-	Expr* expr = logical_and();
-
-	while (match(TokenType::_or)) {
-		Token _operator = previous();
-		Expr *right = logical_and();
-		expr = DBG_new Expr_Logical{expr, _operator, right};
-	}
-
-	return expr;
-}
-
-Expr* Parser::logical_and() {
-	Expr* expr = equality();
-
-	while (match(TokenType::_and)) {
-		Token _operator = previous();
-		Expr *right = equality();
-		expr = DBG_new Expr_Logical{expr, _operator, right};
 	}
 
 	return expr;
 }
 
-Expr *Parser::equality() {
-	Expr *expr = comparison();
-
-	while (match(2, TokenType::not_equal, TokenType::equal_equal)) {
-		Token _operator = previous();
-		Expr *right = comparison();
-		expr = DBG_new Expr_Binary{expr, _operator, right};
-	}
-	return expr;
-}
-
-Expr *Parser::comparison() {
-	Expr* expr = bitwise_or();
-	
-	while (match(4, TokenType::greater, TokenType::greater_equal, TokenType::less, TokenType::less_equal)) {
-		Token _operator = previous();
-		Expr* right = bitwise_or();
-		expr = DBG_new Expr_Binary{expr, _operator, right};
-	}
-
-	return expr;
-}
-
-Expr* Parser::bitwise_or() {
-	Expr* expr = bitwise_xor();
-
-	while (match(TokenType::bitwise_or)) {
-		Token _operator = previous();
-		Expr* right = bitwise_xor();
-		expr = DBG_new Expr_Binary{expr, _operator, right};
-	}
-
-	return expr;
-}
-
-Expr* Parser::bitwise_xor() {
-	Expr* expr = bitwise_and();
-
-	while (match(TokenType::bitwise_xor)) {
-		Token _operator = previous();
-		Expr* right = bitwise_and();
-		expr = DBG_new Expr_Binary{expr, _operator, right};
-	}
-
-	return expr;
-}
-
-Expr* Parser::bitwise_and() {
-	Expr* expr = bitwise_shift();
-
-	while (match(TokenType::bitwise_and)) {
-		Token _operator = previous();
-		Expr* right = bitwise_shift();
-		expr = DBG_new Expr_Binary{expr, _operator, right};
-	}
-
-	return expr;
-}
-
-Expr* Parser::bitwise_shift() {
-	Expr* expr = term();
-
-	while (match(2, TokenType::left_shift, TokenType::right_shift)) {
-		Token _operator = previous();
-		Expr* right = term();
-		expr = DBG_new Expr_Binary{expr, _operator, right};
+ExprId Parser::assignment(ExprId target, const Token& equals, ExprId rhs) {
+	switch (expr_type(target)) {
+		case ExprType::variable: {
+			Expr_Variable* variable = ast_get<Expr_Variable>(ast, target);
+			return ast_new<Expr_Assign>(ast, target, variable->name, variable->span, rhs);
+		}
+		case ExprType::get: {
+			Expr_Get* get = ast_get<Expr_Get>(ast, target);
+			return ast_new<Expr_Set>(ast, target, get->name, get->span, rhs);
+		}
+		default: break;
 	}
 
-	return expr;
+	throw error(equals, "Invalid assignment target.");
 }
 
-Expr *Parser::term() {
-	Expr* expr = factor();
-
-	while (match(2, TokenType::minus, TokenType::plus)) {
-		Token _operator = previous();
-		Expr* right = factor();
-		expr = DBG_new Expr_Binary{expr, _operator, right};
+// Decimal literals one past the maximum of their type, like 2147483648. They're only valid after
+// a minus, and the lexer gives them the minimum value of their type.
+static bool is_minimum_magnitude(const Token& token) {
+	if (token.type != TokenType::number || token.lexeme.empty() || token.lexeme[0] < '1' || token.lexeme[0] > '9') return false;
+	switch (token.literal.type) {
+		case JavaType::_int: return token.literal.value._int == INT32_MIN;
+		case JavaType::_long: return token.literal.value._long == INT64_MIN;
+		default: return false;
 	}
-
-	return expr;
 }
 
-Expr *Parser::factor() {
-	Expr* expr = unary();
-
-	while (match(3, TokenType::slash, TokenType::star, TokenType::percent_sign)) {
-		Token _operator = previous();
-		Expr* right = unary();
-		expr = DBG_new Expr_Binary{expr, _operator, right};
+// Operands of prefix operators and casts nest without going through binary_expression.
+ExprId Parser::nested_unary() {
+	NestingGuard guard(nesting_depth);
+	if (nesting_depth > PARSER_MAX_NESTING_DEPTH) {
+		throw error(peek(), "Expression is nested too deeply.");
 	}
-
-	return expr;
+	return unary();
 }
 
-Expr *Parser::unary() {
+ExprId Parser::unary() {
 	if (match(3, TokenType::_not, TokenType::minus, TokenType::bitwise_not)) {
 		Token _operator = previous();
-		Expr* right = unary();
-		return DBG_new Expr_Unary{_operator, right};
+		// Negating the minimum value gives it back, so the literal is used as it is.
+		if (_operator.type == TokenType::minus && check(TokenType::number) && is_minimum_magnitude(peek())) {
+			return ast_new<Expr_Literal>(ast, advance().literal);
+		}
+		ExprId right = nested_unary();
+		return ast_new<Expr_Unary>(ast, _operator.type, ast_new_span(ast, _operator), right);
 	}
 
 	// Prefix -- ++
 	if (match(2, TokenType::plus_plus, TokenType::minus_minus)) {
 		bool is_positive = previous().type == TokenType::plus_plus;
-		Token name = consume(TokenType::identifier, "Expected identifier after prefix '%s'.", previous().lexeme);
-		return DBG_new Expr_Increment{ name, is_positive };
+		Token name = consume(TokenType::identifier, "Expected identifier after prefix '%.*s'.", (int)previous().lexeme.size(), previous().lexeme.data());
+		return ast_new<Expr_Increment>(ast, name.symbol, ast_new_span(ast, name), is_positive);
 	}
 
 	// Postfix -- ++
 	if (check(TokenType::identifier) && (check_next(TokenType::plus_plus) || check_next(TokenType::minus_minus))) {
 		Token name = advance();
 		bool is_positive = advance().type == TokenType::plus_plus;
-		return DBG_new Expr_Increment{ name, is_positive };
+		return ast_new<Expr_Increment>(ast, name.symbol, ast_new_span(ast, name), is_positive);
 	}
 
 	if (match(TokenType::paren_left)) {
@@ -715,12 +701,12 @@ Expr *Parser::unary() {
 			case TokenType::type_double: {
 				Token type_token = advance();
 				consume(TokenType::paren_right, "Expected ')' after type in cast");
-				Expr* right = unary();
+				ExprId right = nested_unary();
 				JavaType type = token_type_to_java_type(type_token.type);
 				if (type == JavaType::_void || type == JavaType::_null || type == JavaType::none || type == JavaType::UserDefined) {
 					throw error(type_token, "Invalid cast.");
 				}
-				return DBG_new Expr_Cast{type, type_token.line, type_token.column, right};
+				return ast_new<Expr_Cast>(ast, type, ast_new_span(ast, type_token), right);
 			} break;
 
 			default: {
@@ -732,33 +718,28 @@ Expr *Parser::unary() {
 	return call();
 }
 
-Expr* Parser::call() {
-	Expr* expr = primary();
+ExprId Parser::call() {
+	ExprId expr = primary();
 
 	while (true) {
 		if (match(TokenType::paren_left)) {
-			expr_freelist.push_back(expr);
-			auto arguments = DBG_new std::vector<ParseCallInfo>;
+			std::vector<ParseCallInfo> arguments;
 			if (!check(TokenType::paren_right)) {
 				do {
-					if (arguments->size() >= 255) {
-						delete arguments;
+					if (arguments.size() >= 255) {
 						throw error(peek(), "Can't have more than 255 arguments.");
 					}
 					// Always call 1 level of precedence above the comma operator.
-					Expr* argument_expr = ternary_conditional();
-					expr_freelist.push_back(argument_expr);
-					arguments->emplace_back(argument_expr, peek().line, peek().column);
+					ExprId argument_expr = binary_expression(Precedence::ternary);
+					arguments.emplace_back(argument_expr, ast_new_span(ast, peek()));
 				} while (match(TokenType::comma));
 			}
-			if (!check(TokenType::paren_right)) { delete arguments; }
 			Token paren = consume(TokenType::paren_right, "Expected ')' after function call.");
-			expr = DBG_new Expr_Call{expr, paren, arguments};
+			expr = ast_new<Expr_Call>(ast, expr, ast_new_span(ast, paren), arena_push_array(&ast->arena, arguments));
 		}
 		else if (match(TokenType::dot)) {
-			expr_freelist.push_back(expr);
 			Token name = consume(TokenType::identifier, "Expected property name after '.'.");
-			expr = DBG_new Expr_Get{expr, name};
+			expr = ast_new<Expr_Get>(ast, expr, name.symbol, ast_new_span(ast, name));
 		}
 		else {
 			break;
@@ -768,52 +749,52 @@ Expr* Parser::call() {
 	return expr;
 }
 
-Expr *Parser::primary() {
+ExprId Parser::primary() {
 	if (match(TokenType::_false)) {
 		JavaValue value = {};
 		value._boolean = false;
-		return DBG_new Expr_Literal{ JavaObject{JavaType::_boolean, value} };
+		return ast_new<Expr_Literal>(ast, JavaObject{JavaType::_boolean, value});
 	}
 	if (match(TokenType::_true)) {
 		JavaValue value = {};
 		value._boolean = true;
-		return DBG_new Expr_Literal{ JavaObject{JavaType::_boolean, value} };
+		return ast_new<Expr_Literal>(ast, JavaObject{JavaType::_boolean, value});
 	}
 	if (match(TokenType::_null)) {
-		return DBG_new Expr_Literal{ JavaObject{JavaType::_null, JavaValue{}} };
+		return ast_new<Expr_Literal>(ast, JavaObject{JavaType::_null, JavaValue{}});
 	}
 
 	if (match(3, TokenType::number, TokenType::string, TokenType::character)) {
-		return DBG_new Expr_Literal{ previous().literal };
+		if (is_minimum_magnitude(previous())) {
+			JavaType type = previous().literal.type;
+			throw error(previous(), "The number literal '%.*s' is out of range for type '%s'.", (int)previous().lexeme.size(), previous().lexeme.data(), java_type_cstring(type));
+		}
+		return ast_new<Expr_Literal>(ast, previous().literal);
 	}
 
 	if (match(TokenType::_this)) {
 		if (this->class_level == 0) {
 			throw error(previous(), "Can't use 'this' outside a class.");
 		}
-		return DBG_new Expr_This{ previous().lexeme, previous().line, previous().column };
+		return ast_new<Expr_This>(ast, previous().symbol, ast_new_span(ast, previous()));
 	}
 
 	if (match(2, TokenType::identifier, TokenType::type_user_defined)) {
 		bool is_function = (peek().type == TokenType::paren_left);
 		Token name = previous();
-		return DBG_new Expr_Variable{name.lexeme, name.line, name.column, is_function};
+		return ast_new<Expr_Variable>(ast, name.symbol, ast_new_span(ast, name), is_function);
 	}
 
 	if (match(TokenType::paren_left)) {
-		Expr* expr = expression();
+		ExprId expr = expression();
 		consume(TokenType::paren_right, "Expected closing ')'.");
-		return DBG_new Expr_Grouping{ expr };
+		return ast_new<Expr_Grouping>(ast, expr);
 	}
 
 	throw error(peek(), "Expected expression.");
 }
 
 Parser::Error Parser::error(Token token, const char *fmt, ...) {
-	for (Expr* expr: expr_freelist) { expr_free(expr); }
-	for (Stmt* stmt: stmt_freelist) { stmt_free(stmt); }
-	expr_freelist.clear();
-	stmt_freelist.clear();
 
 	va_list args;
 	va_start(args, fmt);
@@ -823,10 +804,6 @@ Parser::Error Parser::error(Token token, const char *fmt, ...) {
 }
 
 Parser::Error Parser::error(Token token, const char *fmt, va_list args) {
-	for (Expr* expr : expr_freelist) { expr_free(expr); }
-	for (Stmt* stmt : stmt_freelist) { stmt_free(stmt); }
-	expr_freelist.clear();
-	stmt_freelist.clear();
 
 	JavaError::error(token, fmt, args);
 	return {};
@@ -858,6 +835,7 @@ void Parser::synchronize() {
 		case TokenType::_break:
 		case TokenType::_continue:
 			return;
+		default: break;
 		}
 
 		advance();
@@ -865,13 +843,11 @@ void Parser::synchronize() {
 }
 
 Token Parser::consume_java_type(const char* fmt, ...) {
-	bool is_type_user_defined = class_names.contains(peek().lexeme);
+	bool is_type_user_defined = class_names.contains(peek().symbol);
 	if (is_token_type_java_type(peek().type) || is_type_user_defined) {
 		if (is_type_user_defined) {
-			this->tokens.at(this->current).type = TokenType::type_user_defined;
+			token_at(this->current).type = TokenType::type_user_defined;
 		}
-		expr_freelist.clear();
-		stmt_freelist.clear();
 		return advance();
 	}
 
@@ -894,8 +870,6 @@ Token Parser::consume_no_reset(TokenType type, const char* fmt, ...) {
 
 Token Parser::consume(TokenType type, const char* fmt, ...) {
 	if (check(type)) {
-		expr_freelist.clear();
-		stmt_freelist.clear();
 		return advance();
 	}
 
@@ -964,8 +938,8 @@ bool Parser::match(size_t n, ...) {
 bool Parser::check_java_type() {
 	if (is_at_end()) return false;
 
-	if (class_names.contains(peek().lexeme)) {
-		this->tokens.at(this->current).type = TokenType::type_user_defined;
+	if (class_names.contains(peek().symbol)) {
+		token_at(this->current).type = TokenType::type_user_defined;
 		return true;
 	}
 	return is_token_type_java_type(peek().type);
@@ -981,7 +955,7 @@ bool Parser::check_next(TokenType type) {
 	return peek_next().type == type;
 }
 
-Token Parser::advance() {
+const Token& Parser::advance() {
 	if (!is_at_end()) current++;
 	return previous();
 }
@@ -990,14 +964,24 @@ inline bool Parser::is_at_end() {
 	return peek().type == TokenType::eof;
 }
 
-inline Token Parser::peek() {
-	return tokens[current];
+inline const Token& Parser::peek() {
+	return token_at(current);
 }
 
-inline Token Parser::peek_next() {
-	return tokens[current + 1];
+inline const Token& Parser::peek_next() {
+	return token_at(current + 1);
 }
 
-inline Token Parser::previous() {
-	return tokens[current - 1];
+inline const Token& Parser::previous() {
+	return token_at(current - 1);
+}
+
+// Pulls tokens from the lexer until the one at index is available.
+inline Token& Parser::token_at(uint32_t index) {
+	while (index >= scanned) {
+		window[scanned % PARSER_TOKEN_WINDOW] = lexer.next();
+		scanned++;
+	}
+	assert(index + PARSER_TOKEN_WINDOW > scanned && "Token already left the parser window.");
+	return window[index % PARSER_TOKEN_WINDOW];
 }
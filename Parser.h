@@ -3,55 +3,80 @@
 #include <vector>
 #include <set>
 
-#include "Arena.h"
+#include "Ast.h"
 #include "Token.h"
+#include "Lexer.h"
 #include "Expr.h"
 #include "Stmt.h"
 #include "Visibility.h"
 
+// Tokens are pulled from the lexer on demand and only the last few are kept.
+// The grammar looks at most two tokens behind and one ahead of the current one.
+#define PARSER_TOKEN_WINDOW 8
+
+// Deeper expressions are reported as an error instead of running out of stack.
+#define PARSER_MAX_NESTING_DEPTH 256
+
+// Binding power of the infix operators, from the loosest to the tightest.
+enum class Precedence : uint8_t {
+	none,
+	comma,
+	ternary,
+	assignment,
+	logical_or,
+	logical_and,
+	equality,
+	comparison,
+	bitwise_or,
+	bitwise_xor,
+	bitwise_and,
+	bitwise_shift,
+	term,
+	factor,
+};
+
 class Parser {
 public:
-	Parser(std::vector<Token>& _tokens);
+	// The nodes are freed all at once when the parser is destroyed.
+	Parser(Lexer& _lexer);
+	// The nodes are added to the given Ast instead, so they can outlive the parser.
+	Parser(Lexer& _lexer, Ast* _ast);
 	~Parser();
-	Expr* parse_expression();
-	std::vector<Stmt*>* parse_statements();
-	void statements_free(std::vector<Stmt*>* statements);
+	ExprId parse_expression();
+	StmtList parse_statements();
+	// Parses the next top level declaration or statement. Returns STMT_NONE at the end of the
+	// source, or after a syntax error.
+	StmtId parse_statement();
+	// Parses a body that was skipped by skip_function_bodies and keeps it in the function.
+	// The lexer has to be over the body_source of the function.
+	bool parse_function_body(Stmt_Function* function);
 
 private:
-	Stmt* declaration();
-	Stmt* statement();
-	Stmt* if_statement();
-	Stmt* while_statement();
-	Stmt* for_statement();
-	Stmt* break_statement();
-	Stmt* continue_statement();
-	Stmt* print_statement(const bool has_newline);
-	Stmt* return_statement();
-	Stmt* expression_statement();
-	std::vector<Stmt*> block_statement();
-	std::vector<Stmt*>* heap_block_statement();
-	Stmt* complex_var_declaration(TokenType first_modifier);
-	Stmt* class_declaration(bool is_abstract);
-	Stmt* var_declaration(Token type, Visibility visibility, bool is_static, bool is_final);
-	Stmt* fun_declaration(TokenType return_type, Token name, Visibility visibility, bool is_static);
+	StmtId declaration();
+	StmtId statement();
+	StmtId if_statement();
+	StmtId while_statement();
+	StmtId for_statement();
+	StmtId break_statement();
+	StmtId continue_statement();
+	StmtId print_statement(const bool has_newline);
+	StmtId return_statement();
+	StmtId expression_statement();
+	StmtList block_statement();
+	void skip_block(Stmt_Function* function);
+	StmtId complex_var_declaration(TokenType first_modifier);
+	StmtId annotated_declaration();
+	StmtId class_declaration(bool is_abstract);
+	StmtId var_declaration(Token type, Visibility visibility, bool is_static, bool is_final);
+	StmtId fun_declaration(TokenType return_type, Token name, Visibility visibility, bool is_static);
 
-	Expr* expression();
-	Expr* comma_operator();
-	Expr* ternary_conditional();
-	Expr* assignment();
-	Expr* logical_or();
-	Expr* logical_and();
-	Expr* equality();
-	Expr* comparison();
-	Expr* bitwise_or();
-	Expr* bitwise_xor();
-	Expr* bitwise_and();
-	Expr* bitwise_shift();
-	Expr* term();
-	Expr* factor();
-	Expr* unary();
-	Expr* call();
-	Expr* primary();
+	ExprId expression();
+	ExprId binary_expression(Precedence min_precedence);
+	ExprId assignment(ExprId target, const Token& equals, ExprId rhs);
+	ExprId unary();
+	ExprId nested_unary();
+	ExprId call();
+	ExprId primary();
 
 	class Error {};
 	Error error(Token name, const char *fmt, ...);
@@ -69,20 +94,31 @@ private:
 	bool check_java_type();
 	bool check(TokenType type);
 	bool check_next(TokenType type);
-	Token advance();
+	const Token& advance();
 	inline bool is_at_end();
-	inline Token peek();
-	inline Token peek_next();
-	inline Token previous();
+	inline const Token& peek();
+	inline const Token& peek_next();
+	inline const Token& previous();
+	inline Token& token_at(uint32_t index);
 
 private:
-	std::vector<Token> &tokens;
+	Lexer &lexer;
+	Token window[PARSER_TOKEN_WINDOW];
+	uint32_t scanned = 0;
 	uint32_t current = 0;
 	uint32_t loop_level = 0;
 	uint32_t func_level = 0;
 	uint32_t class_level = 0;
-	std::vector<Expr*> expr_freelist;
-	std::vector<Stmt*> stmt_freelist;
+	uint32_t nesting_depth = 0;
+	Ast owned_ast = {};
 public:
-	std::set<std::string> class_names;
+	Ast* ast;
+	std::set<Symbol> class_names;
+	// Function bodies are only matched by braces, and are parsed the first time they're called.
+	// Syntax errors in them aren't reported until then.
+	bool skip_function_bodies = false;
 };
+
+// Parses the body of a function skipped by a parser with skip_function_bodies set, the string
+// literals in it and its nodes go into the Ast. Returns false if it has syntax errors.
+bool parse_skipped_function_body(Ast* ast, Stmt_Function* function, const std::set<Symbol>& class_names);
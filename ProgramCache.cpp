@@ -0,0 +1,734 @@
+#if defined(_WIN32) || defined(_WIN64)
+	#include <windows.h>
+	#include <process.h>
+	#ifdef _DEBUG
+		#include <stdlib.h>
+		#include <crtdbg.h>
+	#endif
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <assert.h>
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+#include "ProgramCache.h"
+
+#define PROGRAM_CACHE_MAGIC "JCCACHE"
+#define PROGRAM_CACHE_ALIGNMENT 16
+
+// Relocations are positions of pointer sized fields, so the lowest bit is free to mark the string views.
+#define PROGRAM_CACHE_RELOCATION_VIEW 1
+
+// Every kind of node, in the order of ExprType and StmtType.
+#define PROGRAM_CACHE_EXPRS(X) \
+	X(Expr_Assign) X(Expr_Binary) X(Expr_Call) X(Expr_Cast) X(Expr_Get) X(Expr_Grouping) X(Expr_Increment) \
+	X(Expr_Literal) X(Expr_Logical) X(Expr_Set) X(Expr_Ternary) X(Expr_This) X(Expr_Unary) X(Expr_Variable)
+#define PROGRAM_CACHE_STMTS(X) \
+	X(Stmt_Break) X(Stmt_Block) X(Stmt_Class) X(Stmt_Continue) X(Stmt_Expression) X(Stmt_Function) X(Stmt_If) \
+	X(Stmt_Print) X(Stmt_Return) X(Stmt_Var) X(Stmt_While)
+
+#define NODE_SIZE(T) sizeof(T),
+static const size_t expr_node_sizes[] = { PROGRAM_CACHE_EXPRS(NODE_SIZE) };
+static const size_t stmt_node_sizes[] = { PROGRAM_CACHE_STMTS(NODE_SIZE) };
+#undef NODE_SIZE
+static_assert(sizeof(expr_node_sizes) / sizeof(size_t) == EXPR_TYPE_COUNT, "Every kind of expression has to be cached.");
+static_assert(sizeof(stmt_node_sizes) / sizeof(size_t) == STMT_TYPE_COUNT, "Every kind of statement has to be cached.");
+
+struct CacheSection {
+	uint64_t offset;
+	uint64_t count;
+};
+
+// The file starts with the header, then come the names of the symbols, a copy of the source,
+// the pools of nodes and spans, the arrays and strings they point to, and the relocations.
+struct CacheHeader {
+	char magic[8];
+	uint32_t format_version;
+	uint32_t pointer_size;
+	char build[32];
+	uint64_t layout_hash;
+	uint64_t source_hash;
+	uint64_t source_len;
+	uint64_t file_len;
+	uint64_t content_hash; // Of the whole file, with this field left as zero.
+	Symbol first_symbol;
+	uint32_t symbol_count;
+	uint64_t symbols_offset;
+	ArenaArray<Symbol> class_names;
+	StmtList statements;
+	CacheSection exprs[EXPR_TYPE_COUNT];
+	CacheSection stmts[STMT_TYPE_COUNT];
+	CacheSection spans;
+	CacheSection relocations;
+};
+
+// FNV-1a over 8 bytes at a time, it only has to tell sources apart, not resist attacks.
+static uint64_t hash_bytes(const void* data, uint64_t len, uint64_t hash = 14695981039346656037ull) {
+	const uint8_t* bytes = (const uint8_t*)data;
+	uint64_t i = 0;
+	for (; i + 8 <= len; i += 8) {
+		uint64_t word;
+		memcpy(&word, bytes + i, sizeof(word));
+		hash = (hash ^ word) * 1099511628211ull;
+	}
+	for (; i < len; i++) {
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+// Hash of the file as it was written, before the relocations are applied.
+static uint64_t content_hash(const uint8_t* bytes, uint64_t len) {
+	const uint64_t field = offsetof(CacheHeader, content_hash);
+	uint64_t hash = hash_bytes(bytes, field);
+	return hash_bytes(bytes + field + sizeof(uint64_t), len - field - sizeof(uint64_t), hash);
+}
+
+// Identifies the build of the interpreter, a cache written by another build is ignored. The
+// executable changes size or modification time whenever any translation unit is rebuilt, the
+// date of the build is only a fallback for when it can't be found.
+static void build_id(char* id, size_t size) {
+	uint64_t file_size = 0, modified = 0;
+#if defined(_WIN32) || defined(_WIN64)
+	char path[MAX_PATH];
+	WIN32_FILE_ATTRIBUTE_DATA info = {};
+	DWORD len = GetModuleFileNameA(NULL, path, MAX_PATH);
+	if (len > 0 && len < MAX_PATH && GetFileAttributesExA(path, GetFileExInfoStandard, &info)) {
+		file_size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+		modified = ((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+	}
+#else
+	struct stat info = {};
+	if (stat("/proc/self/exe", &info) == 0) {
+		file_size = (uint64_t)info.st_size;
+		modified = (uint64_t)info.st_mtime;
+	}
+#endif
+	memset(id, 0, size);
+	if (file_size == 0) strncpy(id, __DATE__ " " __TIME__, size - 1);
+	else snprintf(id, size, "%llx-%llx", (unsigned long long)file_size, (unsigned long long)modified);
+}
+
+// Changes whenever a node, or something stored in one, changes size.
+static uint64_t layout_hash() {
+	const size_t sizes[] = {
+		sizeof(JavaObject), sizeof(std::string_view), sizeof(ParseCallInfo),
+		sizeof(Parameter), sizeof(Else_If), sizeof(VarName), sizeof(SourceSpan), sizeof(CacheHeader),
+	};
+	uint64_t hash = hash_bytes(expr_node_sizes, sizeof(expr_node_sizes));
+	hash = hash_bytes(stmt_node_sizes, sizeof(stmt_node_sizes), hash);
+	return hash_bytes(sizes, sizeof(sizes), hash);
+}
+
+ProgramCacheKey program_cache_key(const SourceFile& source) {
+	ProgramCacheKey key = {};
+	key.source_hash = hash_bytes(source.bytes, source.len);
+	key.source_len = source.len;
+	key.first_symbol = (Symbol)symbol_table.size();
+	return key;
+}
+
+std::string program_cache_path(const char* source_name) {
+	return std::string(source_name) + PROGRAM_CACHE_EXTENSION;
+}
+
+// -----------------------------------------------------------------------------------------------
+// Saving.
+// -----------------------------------------------------------------------------------------------
+
+// Pointers are written as offsets from the start of the file, and their positions are added to
+// the relocations. Fields are always written by position, because the buffer moves as it grows.
+struct CacheWriter {
+	std::vector<uint8_t> bytes;
+	std::vector<uint64_t> relocations;
+	const char* source;
+	uint64_t source_len;
+	uint64_t source_offset;
+};
+
+static uint64_t writer_align(CacheWriter* writer, size_t align) {
+	uint64_t at = (writer->bytes.size() + align - 1) & ~(uint64_t)(align - 1);
+	writer->bytes.resize(at);
+	return at;
+}
+
+static uint64_t writer_append(CacheWriter* writer, const void* data, size_t len, size_t align) {
+	uint64_t at = writer_align(writer, align);
+	writer->bytes.resize(at + len);
+	if (len > 0) memcpy(&writer->bytes[at], data, len);
+	return at;
+}
+
+static void writer_pointer(CacheWriter* writer, uint64_t at, uint64_t target) {
+	void* pointer = (void*)(uintptr_t)target;
+	memcpy(&writer->bytes[at], &pointer, sizeof(pointer));
+	writer->relocations.push_back(at);
+}
+
+// Views into the source point into the copy of it, anything else is copied after the nodes.
+static void writer_view(CacheWriter* writer, uint64_t at, std::string_view view) {
+	std::string_view stored = {};
+	if (!view.empty()) {
+		uintptr_t data = (uintptr_t)view.data();
+		uintptr_t source = (uintptr_t)writer->source;
+		uint64_t target = (data >= source && data + view.size() <= source + writer->source_len)
+			? writer->source_offset + (data - source)
+			: writer_append(writer, view.data(), view.size(), 1);
+		stored = std::string_view((const char*)(uintptr_t)target, view.size());
+		writer->relocations.push_back(at | PROGRAM_CACHE_RELOCATION_VIEW);
+	}
+	memcpy(&writer->bytes[at], &stored, sizeof(stored));
+}
+
+// Position in the cache of a field of an object that was copied to `at`.
+template<typename T, typename F>
+static uint64_t field_at(uint64_t at, const T& object, const F& field) {
+	return at + (uint64_t)((const uint8_t*)&field - (const uint8_t*)&object);
+}
+
+// Fixes the fields that point outside of an object already copied to `at`. Most nodes don't have any.
+template<typename T>
+static void write_fields(CacheWriter*, uint64_t, const T&) {}
+
+static void write_fields(CacheWriter* writer, uint64_t at, const JavaObject& object) {
+	if (object.type == JavaType::String && object.value.String != NULL) {
+		uint64_t target = writer_append(writer, object.value.String, strlen(object.value.String) + 1, 1);
+		writer_pointer(writer, field_at(at, object, object.value.String), target);
+	}
+}
+
+static void write_fields(CacheWriter* writer, uint64_t at, const Parameter& param) {
+	writer_view(writer, field_at(at, param, param.first.name), param.first.name);
+}
+
+template<typename T>
+static void write_fields(CacheWriter* writer, uint64_t at, const ArenaArray<T>& array) {
+	memcpy(&writer->bytes[at], &array, sizeof(array));
+	if (array.empty()) return;
+
+	uint64_t items = writer_append(writer, array.items, array.count * sizeof(T), std::max(alignof(T), alignof(void*)));
+	for (uint32_t i = 0; i < array.count; i++) {
+		write_fields(writer, items + i * sizeof(T), array.items[i]);
+	}
+	writer_pointer(writer, field_at(at, array, array.items), items);
+}
+
+static void write_fields(CacheWriter* writer, uint64_t at, const Expr_Call& expr) {
+	write_fields(writer, field_at(at, expr, expr.arguments), expr.arguments);
+}
+
+static void write_fields(CacheWriter* writer, uint64_t at, const Expr_Literal& expr) {
+	write_fields(writer, field_at(at, expr, expr.literal), expr.literal);
+}
+
+static void write_fields(CacheWriter* writer, uint64_t at, const Stmt_Block& stmt) {
+	write_fields(writer, field_at(at, stmt, stmt.statements), stmt.statements);
+}
+
+static void write_fields(CacheWriter* writer, uint64_t at, const Stmt_Class& stmt) {
+	write_fields(writer, field_at(at, stmt, stmt.attributes), stmt.attributes);
+	write_fields(writer, field_at(at, stmt, stmt.methods), stmt.methods);
+}
+
+static void write_fields(CacheWriter* writer, uint64_t at, const Stmt_Function& stmt) {
+	write_fields(writer, field_at(at, stmt, stmt.params), stmt.params);
+	write_fields(writer, field_at(at, stmt, stmt.body), stmt.body);
+	writer_view(writer, field_at(at, stmt, stmt.body_source), stmt.body_source);
+}
+
+static void write_fields(CacheWriter* writer, uint64_t at, const Stmt_If& stmt) {
+	write_fields(writer, field_at(at, stmt, stmt.else_ifs), stmt.else_ifs);
+}
+
+static void write_fields(CacheWriter* writer, uint64_t at, const Stmt_Var& stmt) {
+	write_fields(writer, field_at(at, stmt, stmt.names), stmt.names);
+	write_fields(writer, field_at(at, stmt, stmt.initializers), stmt.initializers);
+}
+
+// The nodes of a pool are written one after the other, in the same layout as its chunks.
+template<typename T>
+static void write_pool(CacheWriter* writer, const AstPool& pool, uint64_t section_at) {
+	uint64_t at = writer_align(writer, PROGRAM_CACHE_ALIGNMENT);
+	writer->bytes.resize(at + (uint64_t)pool.count * sizeof(T));
+
+	for (uint32_t i = 0; i < pool.count; i++) {
+		const T* node = (const T*)pool.chunks[i >> AST_POOL_CHUNK_SHIFT] + (i & AST_POOL_CHUNK_MASK);
+		uint64_t node_at = at + (uint64_t)i * sizeof(T);
+		memcpy(&writer->bytes[node_at], (const void*)node, sizeof(T));
+		write_fields(writer, node_at, *node);
+	}
+
+	CacheSection section = { at, pool.count };
+	memcpy(&writer->bytes[section_at], &section, sizeof(section));
+}
+
+static bool write_file(const char* path, const std::vector<uint8_t>& bytes) {
+	// Written next to the cache and renamed over it, so a run never sees half a file.
+#if defined(_WIN32) || defined(_WIN64)
+	std::string temporary = std::string(path) + ".tmp" + std::to_string(_getpid());
+#else
+	std::string temporary = std::string(path) + ".tmp" + std::to_string(getpid());
+#endif
+
+	FILE* handle = fopen(temporary.c_str(), "wb");
+	if (handle == NULL) return false;
+	bool written = fwrite(bytes.data(), 1, bytes.size(), handle) == bytes.size();
+	written = (fclose(handle) == 0) && written;
+
+#if defined(_WIN32) || defined(_WIN64)
+	written = written && MoveFileExA(temporary.c_str(), path, MOVEFILE_REPLACE_EXISTING);
+#else
+	written = written && rename(temporary.c_str(), path) == 0;
+#endif
+	if (!written) remove(temporary.c_str());
+	return written;
+}
+
+bool program_cache_save(const char* path, const ProgramCacheKey& key, const SourceFile& source, const Ast* ast, StmtList statements, const std::set<Symbol>& class_names) {
+	CacheWriter writer = {};
+	writer.source = source.bytes;
+	writer.source_len = source.len;
+
+	CacheHeader header = {};
+	memcpy(header.magic, PROGRAM_CACHE_MAGIC, sizeof(header.magic));
+	header.format_version = PROGRAM_CACHE_FORMAT_VERSION;
+	header.pointer_size = sizeof(void*);
+	build_id(header.build, sizeof(header.build));
+	header.layout_hash = layout_hash();
+	header.source_hash = key.source_hash;
+	header.source_len = key.source_len;
+	header.first_symbol = key.first_symbol;
+	header.symbol_count = (uint32_t)(symbol_table.size() - key.first_symbol);
+	writer_append(&writer, &header, sizeof(header), PROGRAM_CACHE_ALIGNMENT);
+
+	// The names are interned again in the same order when loading, so they get the same ids.
+	uint64_t symbols_offset = writer_align(&writer, sizeof(uint32_t));
+	memcpy(&writer.bytes[offsetof(CacheHeader, symbols_offset)], &symbols_offset, sizeof(symbols_offset));
+	for (Symbol symbol = key.first_symbol; symbol < symbol_table.size(); symbol++) {
+		const std::string& name = symbol_table.name(symbol);
+		uint32_t len = (uint32_t)name.size();
+		writer_append(&writer, &len, sizeof(len), 1);
+		writer_append(&writer, name.data(), len, 1);
+	}
+
+	writer.source_offset = writer_append(&writer, source.bytes, source.len, 1);
+
+	std::vector<Symbol> names(class_names.begin(), class_names.end());
+	ArenaArray<Symbol> names_array = { names.data(), (uint32_t)names.size() };
+	write_fields(&writer, offsetof(CacheHeader, class_names), names_array);
+	write_fields(&writer, offsetof(CacheHeader, statements), statements);
+
+	#define WRITE_EXPR_POOL(T) write_pool<T>(&writer, ast_pool(ast, T::kind), offsetof(CacheHeader, exprs) + (size_t)T::kind * sizeof(CacheSection));
+	#define WRITE_STMT_POOL(T) write_pool<T>(&writer, ast_pool(ast, T::kind), offsetof(CacheHeader, stmts) + (size_t)T::kind * sizeof(CacheSection));
+	PROGRAM_CACHE_EXPRS(WRITE_EXPR_POOL)
+	PROGRAM_CACHE_STMTS(WRITE_STMT_POOL)
+	#undef WRITE_EXPR_POOL
+	#undef WRITE_STMT_POOL
+	write_pool<SourceSpan>(&writer, ast->spans, offsetof(CacheHeader, spans));
+
+	// Sorted, so loading fixes the pointers from the start of the file to the end.
+	std::sort(writer.relocations.begin(), writer.relocations.end());
+	CacheSection relocations = {};
+	relocations.count = writer.relocations.size();
+	relocations.offset = writer_append(&writer, writer.relocations.data(), relocations.count * sizeof(uint64_t), sizeof(uint64_t));
+	memcpy(&writer.bytes[offsetof(CacheHeader, relocations)], &relocations, sizeof(relocations));
+
+	uint64_t file_len = writer.bytes.size();
+	memcpy(&writer.bytes[offsetof(CacheHeader, file_len)], &file_len, sizeof(file_len));
+	uint64_t hash = content_hash(writer.bytes.data(), file_len);
+	memcpy(&writer.bytes[offsetof(CacheHeader, content_hash)], &hash, sizeof(hash));
+
+	return write_file(path, writer.bytes);
+}
+
+// -----------------------------------------------------------------------------------------------
+// Loading.
+// -----------------------------------------------------------------------------------------------
+
+// Fallback for small files, or when the file can't be mapped.
+static bool program_cache_read(ProgramCache* cache, const char* path) {
+	FILE* handle = fopen(path, "rb");
+	if (handle == NULL) return false;
+
+	fseek(handle, 0, SEEK_END);
+	uint64_t len = ftell(handle);
+	fseek(handle, 0, SEEK_SET);
+
+	uint8_t* buffer = (uint8_t*)malloc(len > 0 ? len : 1);
+	assert(buffer != NULL);
+	size_t read = fread(buffer, 1, len, handle);
+	fclose(handle);
+
+	cache->bytes = buffer;
+	cache->len = read;
+	cache->is_mapped = false;
+	return true;
+}
+
+// The pages are mapped copy on write, the relocations are written to private copies of the
+// pages they touch, and the rest stay shared with the page cache.
+#if defined(_WIN32) || defined(_WIN64)
+static bool program_cache_open(ProgramCache* cache, const char* path) {
+	HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (handle == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER size = {};
+	if (GetFileSizeEx(handle, &size) && size.QuadPart >= PROGRAM_CACHE_MMAP_THRESHOLD) {
+		HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		if (mapping != NULL) {
+			void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+			CloseHandle(mapping);
+			if (view != NULL) {
+				CloseHandle(handle);
+				cache->bytes = (uint8_t*)view;
+				cache->len = (uint64_t)size.QuadPart;
+				cache->is_mapped = true;
+				return true;
+			}
+		}
+	}
+	CloseHandle(handle);
+	return program_cache_read(cache, path);
+}
+
+void program_cache_close(ProgramCache* cache) {
+	if (cache->bytes == NULL) return;
+	if (cache->is_mapped) {
+		UnmapViewOfFile(cache->bytes);
+	}
+	else {
+		free(cache->bytes);
+	}
+	cache->bytes = NULL;
+	cache->len = 0;
+}
+#else
+static bool program_cache_open(ProgramCache* cache, const char* path) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat info = {};
+	if (fstat(fd, &info) == 0 && info.st_size >= PROGRAM_CACHE_MMAP_THRESHOLD) {
+		void* view = mmap(NULL, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if (view != MAP_FAILED) {
+			close(fd);
+			cache->bytes = (uint8_t*)view;
+			cache->len = (uint64_t)info.st_size;
+			cache->is_mapped = true;
+			return true;
+		}
+	}
+	close(fd);
+	return program_cache_read(cache, path);
+}
+
+void program_cache_close(ProgramCache* cache) {
+	if (cache->bytes == NULL) return;
+	if (cache->is_mapped) {
+		munmap(cache->bytes, (size_t)cache->len);
+	}
+	else {
+		free(cache->bytes);
+	}
+	cache->bytes = NULL;
+	cache->len = 0;
+}
+#endif
+
+static bool section_fits(const ProgramCache* cache, const CacheSection& section, size_t item_size) {
+	return section.offset <= cache->len && section.count <= (cache->len - section.offset) / item_size;
+}
+
+// Full chunks are used in place. The last one is copied to the arena, so that nodes added
+// later don't write past the end of the pool in the file.
+template<typename T>
+static void load_pool(ProgramCache* cache, const CacheSection& section, Ast* ast, AstPool& pool) {
+	assert(pool.count == 0 && "The nodes of a cache can only be loaded into an empty Ast.");
+	uint8_t* nodes = cache->bytes + section.offset;
+
+	uint64_t full_chunks = section.count >> AST_POOL_CHUNK_SHIFT;
+	for (uint64_t i = 0; i < full_chunks; i++) {
+		pool.chunks.push_back(nodes + i * AST_POOL_CHUNK_SIZE * sizeof(T));
+	}
+	uint64_t rest = section.count & AST_POOL_CHUNK_MASK;
+	if (rest > 0) {
+		void* chunk = arena_alloc_align(&ast->arena, sizeof(T) * AST_POOL_CHUNK_SIZE, alignof(T));
+		memcpy(chunk, nodes + full_chunks * AST_POOL_CHUNK_SIZE * sizeof(T), rest * sizeof(T));
+		pool.chunks.push_back((uint8_t*)chunk);
+	}
+	pool.count = (uint32_t)section.count;
+}
+
+// -----------------------------------------------------------------------------------------------
+// Checks of the nodes, once the pointers are fixed. The hash already rejects damaged files, these
+// make sure that no node refers to something outside of the file, the pools or the symbol table.
+// -----------------------------------------------------------------------------------------------
+
+struct CacheBounds {
+	const ProgramCache* cache;
+	const CacheHeader* header;
+};
+
+static bool valid_expr(const CacheBounds& bounds, ExprId id) {
+	if (id == EXPR_NONE) return true;
+	uint32_t kind = id >> AST_KIND_SHIFT;
+	return kind < EXPR_TYPE_COUNT && (id & AST_INDEX_MASK) < bounds.header->exprs[kind].count;
+}
+
+static bool valid_stmt(const CacheBounds& bounds, StmtId id) {
+	if (id == STMT_NONE) return true;
+	uint32_t kind = id >> AST_KIND_SHIFT;
+	return kind < STMT_TYPE_COUNT && (id & AST_INDEX_MASK) < bounds.header->stmts[kind].count;
+}
+
+static bool valid_span(const CacheBounds& bounds, SpanId id) {
+	return id == SPAN_NONE || id < bounds.header->spans.count;
+}
+
+static bool valid_symbol(Symbol symbol) {
+	return symbol == SYMBOL_NONE || symbol < symbol_table.size();
+}
+
+// The items have to be in the file, each one is checked with is_valid.
+template<typename T, typename F>
+static bool valid_array(const CacheBounds& bounds, const ArenaArray<T>& array, F is_valid) {
+	if (array.count == 0) return true;
+	uintptr_t start = (uintptr_t)bounds.cache->bytes;
+	uintptr_t items = (uintptr_t)array.items;
+	if (items < start || items - start > bounds.cache->len || items % alignof(T) != 0) return false;
+	if (array.count > (bounds.cache->len - (items - start)) / sizeof(T)) return false;
+
+	for (const T& item : array) {
+		if (!is_valid(item)) return false;
+	}
+	return true;
+}
+
+static bool valid_node(const CacheBounds& bounds, const Expr_Assign& expr) {
+	return valid_expr(bounds, expr.lhs) && valid_symbol(expr.lhs_name) && valid_span(bounds, expr.span) && valid_expr(bounds, expr.rhs);
+}
+
+static bool valid_node(const CacheBounds& bounds, const Expr_Binary& expr) {
+	return valid_expr(bounds, expr.left) && valid_expr(bounds, expr.right) && valid_span(bounds, expr.span);
+}
+
+static bool valid_node(const CacheBounds& bounds, const Expr_Call& expr) {
+	return valid_expr(bounds, expr.callee) && valid_span(bounds, expr.paren) &&
+		valid_array(bounds, expr.arguments, [&](const ParseCallInfo& argument) { return valid_expr(bounds, argument.expr) && valid_span(bounds, argument.span); });
+}
+
+static bool valid_node(const CacheBounds& bounds, const Expr_Cast& expr) {
+	return valid_span(bounds, expr.span) && valid_expr(bounds, expr.right);
+}
+
+static bool valid_node(const CacheBounds& bounds, const Expr_Get& expr) {
+	return valid_expr(bounds, expr.object) && valid_symbol(expr.name) && valid_span(bounds, expr.span);
+}
+
+static bool valid_node(const CacheBounds& bounds, const Expr_Grouping& expr) {
+	return valid_expr(bounds, expr.expression);
+}
+
+static bool valid_node(const CacheBounds& bounds, const Expr_Increment& expr) {
+	return valid_symbol(expr.name) && valid_span(bounds, expr.span);
+}
+
+// String literals point into the file and end there.
+static bool valid_node(const CacheBounds& bounds, const Expr_Literal& expr) {
+	if (expr.literal.type != JavaType::String || expr.literal.value.String == NULL) return true;
+	uintptr_t start = (uintptr_t)bounds.cache->bytes;
+	uintptr_t string = (uintptr_t)expr.literal.value.String;
+	if (string < start || string - start >= bounds.cache->len) return false;
+	return memchr(expr.literal.value.String, 0, bounds.cache->len - (string - start)) != NULL;
+}
+
+static bool valid_node(const CacheBounds& bounds, const Expr_Logical& expr) {
+	return valid_expr(bounds, expr.left) && valid_expr(bounds, expr.right) && valid_span(bounds, expr.span);
+}
+
+static bool valid_node(const CacheBounds& bounds, const Expr_Set& expr) {
+	return valid_expr(bounds, expr.lhs) && valid_symbol(expr.rhs_name) && valid_span(bounds, expr.span) && valid_expr(bounds, expr.value);
+}
+
+static bool valid_node(const CacheBounds& bounds, const Expr_Ternary& expr) {
+	return valid_expr(bounds, expr.condition) && valid_expr(bounds, expr.then) && valid_expr(bounds, expr.otherwise) && valid_span(bounds, expr.question_mark);
+}
+
+static bool valid_node(const CacheBounds& bounds, const Expr_This& expr) {
+	return valid_symbol(expr.name) && valid_span(bounds, expr.span);
+}
+
+static bool valid_node(const CacheBounds& bounds, const Expr_Unary& expr) {
+	return valid_expr(bounds, expr.right) && valid_span(bounds, expr.span);
+}
+
+static bool valid_node(const CacheBounds& bounds, const Expr_Variable& expr) {
+	return valid_symbol(expr.name) && valid_span(bounds, expr.span);
+}
+
+static bool valid_node(const CacheBounds&, const Stmt_Break&) { return true; }
+static bool valid_node(const CacheBounds&, const Stmt_Continue&) { return true; }
+
+static bool valid_node(const CacheBounds& bounds, const Stmt_Block& stmt) {
+	return valid_array(bounds, stmt.statements, [&](StmtId id) { return valid_stmt(bounds, id); });
+}
+
+static bool valid_node(const CacheBounds& bounds, const Stmt_Class& stmt) {
+	return valid_symbol(stmt.name) && valid_span(bounds, stmt.span) &&
+		valid_array(bounds, stmt.attributes, [&](StmtId id) { return valid_stmt(bounds, id); }) &&
+		valid_array(bounds, stmt.methods, [&](StmtId id) { return valid_stmt(bounds, id); });
+}
+
+static bool valid_node(const CacheBounds& bounds, const Stmt_Expression& stmt) {
+	return valid_expr(bounds, stmt.expression);
+}
+
+static bool valid_node(const CacheBounds& bounds, const Stmt_Function& stmt) {
+	return valid_symbol(stmt.name) && valid_span(bounds, stmt.span) &&
+		valid_array(bounds, stmt.params, [](const Parameter& param) { return valid_symbol(param.second); }) &&
+		valid_array(bounds, stmt.body, [&](StmtId id) { return valid_stmt(bounds, id); });
+}
+
+static bool valid_node(const CacheBounds& bounds, const Stmt_If& stmt) {
+	return valid_span(bounds, stmt.span) && valid_expr(bounds, stmt.condition) &&
+		valid_stmt(bounds, stmt.then_branch) && valid_stmt(bounds, stmt.else_branch) &&
+		valid_array(bounds, stmt.else_ifs, [&](const Else_If& arm) {
+			return valid_span(bounds, arm.span) && valid_expr(bounds, arm.condition) && valid_stmt(bounds, arm.then_branch);
+		});
+}
+
+static bool valid_node(const CacheBounds& bounds, const Stmt_Print& stmt) {
+	return valid_span(bounds, stmt.span) && valid_expr(bounds, stmt.expression);
+}
+
+static bool valid_node(const CacheBounds& bounds, const Stmt_Return& stmt) {
+	return valid_span(bounds, stmt.span) && valid_expr(bounds, stmt.value);
+}
+
+static bool valid_node(const CacheBounds& bounds, const Stmt_Var& stmt) {
+	return valid_symbol(stmt.type_name) && valid_span(bounds, stmt.type_span) &&
+		valid_array(bounds, stmt.names, [&](const VarName& name) { return valid_symbol(name.symbol) && valid_span(bounds, name.span); }) &&
+		valid_array(bounds, stmt.initializers, [&](ExprId id) { return valid_expr(bounds, id); });
+}
+
+static bool valid_node(const CacheBounds& bounds, const Stmt_While& stmt) {
+	return valid_span(bounds, stmt.span) && valid_expr(bounds, stmt.condition) && valid_stmt(bounds, stmt.body);
+}
+
+template<typename T>
+static bool valid_pool(const CacheBounds& bounds, const CacheSection& section) {
+	const T* nodes = (const T*)(bounds.cache->bytes + section.offset);
+	for (uint64_t i = 0; i < section.count; i++) {
+		if (!valid_node(bounds, nodes[i])) return false;
+	}
+	return true;
+}
+
+static bool program_cache_apply(ProgramCache* cache, const ProgramCacheKey& key, Ast* ast, StmtList* statements, std::set<Symbol>* class_names) {
+	if (cache->len < sizeof(CacheHeader)) return false;
+	CacheHeader* header = (CacheHeader*)cache->bytes;
+
+	char build[sizeof(header->build)];
+	build_id(build, sizeof(build));
+	if (memcmp(header->magic, PROGRAM_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+		header->format_version != PROGRAM_CACHE_FORMAT_VERSION ||
+		header->pointer_size != sizeof(void*) ||
+		memcmp(header->build, build, sizeof(build)) != 0 ||
+		header->layout_hash != layout_hash() ||
+		header->file_len != cache->len ||
+		header->source_hash != key.source_hash ||
+		header->source_len != key.source_len ||
+		header->first_symbol != key.first_symbol ||
+		key.first_symbol != symbol_table.size() ||
+		header->content_hash != content_hash(cache->bytes, cache->len))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < EXPR_TYPE_COUNT; i++) {
+		if (!section_fits(cache, header->exprs[i], expr_node_sizes[i])) return false;
+	}
+	for (size_t i = 0; i < STMT_TYPE_COUNT; i++) {
+		if (!section_fits(cache, header->stmts[i], stmt_node_sizes[i])) return false;
+	}
+	if (!section_fits(cache, header->spans, sizeof(SourceSpan))) return false;
+	if (!section_fits(cache, header->relocations, sizeof(uint64_t))) return false;
+
+	uint64_t at = header->symbols_offset;
+	for (uint32_t i = 0; i < header->symbol_count; i++) {
+		uint32_t len;
+		if (at + sizeof(len) > cache->len) return false;
+		memcpy(&len, cache->bytes + at, sizeof(len));
+		at += sizeof(len);
+		if (len > cache->len - at) return false;
+
+		std::string_view name((const char*)cache->bytes + at, len);
+		if (symbol_table.intern(name) != header->first_symbol + i) return false;
+		at += len;
+	}
+
+	const uint64_t* relocations = (const uint64_t*)(cache->bytes + header->relocations.offset);
+	for (uint64_t i = 0; i < header->relocations.count; i++) {
+		uint64_t position = relocations[i] & ~(uint64_t)PROGRAM_CACHE_RELOCATION_VIEW;
+		if (position + sizeof(std::string_view) > cache->len) return false;
+		uint8_t* field = cache->bytes + position;
+
+		if (relocations[i] & PROGRAM_CACHE_RELOCATION_VIEW) {
+			std::string_view view;
+			memcpy(&view, field, sizeof(view));
+			uint64_t offset = (uintptr_t)view.data();
+			if (offset > cache->len || view.size() > cache->len - offset) return false;
+			view = std::string_view((const char*)cache->bytes + offset, view.size());
+			memcpy(field, &view, sizeof(view));
+		}
+		else {
+			uintptr_t pointer;
+			memcpy(&pointer, field, sizeof(pointer));
+			if (pointer >= cache->len) return false;
+			pointer += (uintptr_t)cache->bytes;
+			memcpy(field, &pointer, sizeof(pointer));
+		}
+	}
+
+	const CacheBounds bounds = { cache, header };
+	if (!valid_array(bounds, header->statements, [&](StmtId id) { return valid_stmt(bounds, id); })) return false;
+	if (!valid_array(bounds, header->class_names, [](Symbol symbol) { return valid_symbol(symbol); })) return false;
+	#define CHECK_EXPR_POOL(T) if (!valid_pool<T>(bounds, header->exprs[(size_t)T::kind])) return false;
+	#define CHECK_STMT_POOL(T) if (!valid_pool<T>(bounds, header->stmts[(size_t)T::kind])) return false;
+	PROGRAM_CACHE_EXPRS(CHECK_EXPR_POOL)
+	PROGRAM_CACHE_STMTS(CHECK_STMT_POOL)
+	#undef CHECK_EXPR_POOL
+	#undef CHECK_STMT_POOL
+
+	#define LOAD_EXPR_POOL(T) load_pool<T>(cache, header->exprs[(size_t)T::kind], ast, ast_pool(ast, T::kind));
+	#define LOAD_STMT_POOL(T) load_pool<T>(cache, header->stmts[(size_t)T::kind], ast, ast_pool(ast, T::kind));
+	PROGRAM_CACHE_EXPRS(LOAD_EXPR_POOL)
+	PROGRAM_CACHE_STMTS(LOAD_STMT_POOL)
+	#undef LOAD_EXPR_POOL
+	#undef LOAD_STMT_POOL
+	load_pool<SourceSpan>(cache, header->spans, ast, ast->spans);
+
+	*statements = header->statements;
+	class_names->insert(header->class_names.begin(), header->class_names.end());
+	return true;
+}
+
+bool program_cache_load(ProgramCache* cache, const char* path, const ProgramCacheKey& key, Ast* ast, StmtList* statements, std::set<Symbol>* class_names) {
+	*cache = {};
+	if (!program_cache_open(cache, path)) return false;
+	if (!program_cache_apply(cache, key, ast, statements, class_names)) {
+		program_cache_close(cache);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+// Parsed programs are saved next to their source, so running the same file again skips the
+// lexer and the parser. The cache file is an image of the pools of the Ast: on a hit it's mapped
+// copy on write, the pointers in it are fixed up from a table of relocations, and the nodes are
+// used right where they are.
+//
+// A cache file is only used when it was written by the same build, for a source with the same
+// hash, and with the symbol table in the same state, so the symbols in the nodes don't change.
+// A damaged file fails the hash of its contents or the checks of its nodes, and the source is
+// parsed again.
+
+#include <stdint.h>
+#include <set>
+#include <string>
+
+#include "Ast.h"
+#include "SourceFile.h"
+#include "SymbolTable.h"
+
+#define PROGRAM_CACHE_EXTENSION ".jcache"
+
+// Bump it when the layout of the cache file or the fields of a node change.
+#define PROGRAM_CACHE_FORMAT_VERSION 6
+
+// Files at least this big are memory mapped, smaller ones are read into a heap buffer.
+#define PROGRAM_CACHE_MMAP_THRESHOLD SOURCE_FILE_MMAP_THRESHOLD
+
+struct ProgramCacheKey {
+	uint64_t source_hash;
+	uint64_t source_len;
+	Symbol first_symbol; // First symbol the lexer interns, it must be taken before lexing.
+};
+
+struct ProgramCache {
+	uint8_t* bytes;
+	uint64_t len;
+	bool is_mapped;
+};
+
+ProgramCacheKey program_cache_key(const SourceFile& source);
+std::string program_cache_path(const char* source_name);
+
+// Adds the nodes of the cached program to the pools of an empty Ast. Most of them stay inside
+// the cache, so it has to be closed after the Ast is freed. Returns false when there's no usable
+// cache file for the key, the Ast is left empty then.
+bool program_cache_load(ProgramCache* cache, const char* path, const ProgramCacheKey& key, Ast* ast, StmtList* statements, std::set<Symbol>* class_names);
+bool program_cache_save(const char* path, const ProgramCacheKey& key, const SourceFile& source, const Ast* ast, StmtList statements, const std::set<Symbol>& class_names);
+void program_cache_close(ProgramCache* cache);
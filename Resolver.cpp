@@ -0,0 +1,355 @@
+#include "Resolver.h"
+
+#include <utility>
+#include <vector>
+#include <unordered_map>
+
+#if defined(_DEBUG) && (defined(_WIN32) || defined(_WIN64))
+	#include <stdlib.h>
+	#include <crtdbg.h>
+#endif
+
+struct ResolverScope {
+	// Slot of every name declared so far. Names declared after the slots ran out are kept with
+	// LOCAL_SLOT_NONE, they are defined by name and nothing can be bound through them.
+	std::unordered_map<Symbol, uint16_t> slots;
+	// Declared type of every slot, if it's a number or a boolean, see static_type.
+	std::vector<JavaType> types;
+	uint16_t slot_count = 0;
+};
+
+struct Resolver {
+	Ast* ast;
+	std::vector<ResolverScope> scopes; // Empty at the top level, where variables are globals.
+
+	void statements(StmtList statements);
+	void statement(StmtId statement);
+	JavaType expression(ExprId expression);
+	void function(Stmt_Function* function);
+	uint16_t declare(Symbol name, JavaType type);
+	LocalRef lookup(Symbol name);
+	JavaType local_type(LocalRef local);
+};
+
+// Only numbers and booleans are tracked, the kernels have no use for other types.
+static JavaType static_type(JavaType type) {
+	if (is_java_type_number(type) || type == JavaType::_boolean) return type;
+	return JavaType::none;
+}
+
+static BinaryOp binary_op(TokenType type) {
+	switch (type) {
+		case TokenType::plus: return BinaryOp::add;
+		case TokenType::minus: return BinaryOp::subtract;
+		case TokenType::star: return BinaryOp::multiply;
+		case TokenType::slash: return BinaryOp::divide;
+		case TokenType::percent_sign: return BinaryOp::remainder;
+		case TokenType::left_shift: return BinaryOp::left_shift;
+		case TokenType::right_shift: return BinaryOp::right_shift;
+		case TokenType::bitwise_or: return BinaryOp::bitwise_or;
+		case TokenType::bitwise_xor: return BinaryOp::bitwise_xor;
+		case TokenType::bitwise_and: return BinaryOp::bitwise_and;
+		case TokenType::greater: return BinaryOp::greater;
+		case TokenType::less: return BinaryOp::less;
+		case TokenType::greater_equal: return BinaryOp::greater_equal;
+		case TokenType::less_equal: return BinaryOp::less_equal;
+		case TokenType::equal_equal: return BinaryOp::equal;
+		case TokenType::not_equal: return BinaryOp::not_equal;
+		default: return BinaryOp::count;
+	}
+}
+
+BinaryKernel pick_binary_kernel(TokenType _operator, JavaType left, JavaType right, JavaType* result) {
+	*result = JavaType::none;
+	if (!is_java_type_number(left) || !is_java_type_number(right)) return BINARY_KERNEL_NONE;
+
+	BinaryOp op = binary_op(_operator);
+	JavaType bigger = ((uint8_t)left > (uint8_t)right) ? left : right;
+	bool is_valid = false;
+	switch (op) {
+		case BinaryOp::add:
+		case BinaryOp::subtract:
+		case BinaryOp::multiply:
+		case BinaryOp::divide:
+			is_valid = bigger != JavaType::_char;
+			break;
+
+		case BinaryOp::remainder:
+		case BinaryOp::left_shift:
+		case BinaryOp::right_shift:
+		case BinaryOp::bitwise_or:
+		case BinaryOp::bitwise_xor:
+		case BinaryOp::bitwise_and:
+			is_valid = bigger == JavaType::_byte || bigger == JavaType::_int || bigger == JavaType::_long;
+			break;
+
+		case BinaryOp::greater:
+		case BinaryOp::less:
+		case BinaryOp::greater_equal:
+		case BinaryOp::less_equal:
+		case BinaryOp::equal:
+		case BinaryOp::not_equal:
+			is_valid = true;
+			break;
+
+		default: break;
+	}
+	if (!is_valid) return BINARY_KERNEL_NONE;
+
+	*result = (op >= BinaryOp::greater) ? JavaType::_boolean : bigger;
+	return binary_kernel(op, bigger);
+}
+
+uint16_t Resolver::declare(Symbol name, JavaType type) {
+	if (scopes.empty()) return LOCAL_SLOT_NONE;
+	ResolverScope& scope = scopes.back();
+
+	// Declaring a name twice in the same scope is an error at runtime, so the second declaration
+	// gets the same slot and finds it already defined.
+	auto found = scope.slots.find(name);
+	if (found != scope.slots.end()) return found->second;
+
+	uint16_t slot = (scope.slot_count < LOCAL_SLOT_NONE) ? scope.slot_count++ : LOCAL_SLOT_NONE;
+	scope.slots.insert({ name, slot });
+	if (slot != LOCAL_SLOT_NONE) scope.types.push_back(static_type(type));
+	return slot;
+}
+
+LocalRef Resolver::lookup(Symbol name) {
+	for (size_t i = scopes.size(); i-- > 0;) {
+		size_t depth = scopes.size() - 1 - i;
+		if (depth >= LOCAL_DEPTH_NONE) break;
+
+		auto found = scopes[i].slots.find(name);
+		if (found == scopes[i].slots.end()) continue;
+		if (found->second == LOCAL_SLOT_NONE) break;
+
+		LocalRef local = {};
+		local.depth = (uint16_t)depth;
+		local.slot = found->second;
+		return local;
+	}
+	return LocalRef{};
+}
+
+// Assignments cast to the declared type, but arguments are passed as they are, so this is only
+// what the local most likely holds. Kernels check the actual types before they run.
+JavaType Resolver::local_type(LocalRef local) {
+	if (local.depth == LOCAL_DEPTH_NONE) return JavaType::none;
+	return scopes[scopes.size() - 1 - local.depth].types[local.slot];
+}
+
+void Resolver::statements(StmtList statements) {
+	for (StmtId statement : statements) {
+		this->statement(statement);
+	}
+}
+
+void Resolver::function(Stmt_Function* function) {
+	if (!function->is_body_parsed) return;
+
+	// Functions only close over the globals, so nothing around the declaration is visible.
+	std::vector<ResolverScope> enclosing = std::move(scopes);
+	scopes.clear();
+	scopes.emplace_back();
+
+	// The call puts the arguments in the first slots, in order. The parser already rejected
+	// repeated names.
+	ResolverScope& scope = scopes.back();
+	for (const Parameter& param : function->params) {
+		scope.slots[param.second] = scope.slot_count++;
+		scope.types.push_back(static_type(param.first.type));
+	}
+	statements(function->body);
+	function->slot_count = scopes.back().slot_count;
+
+	scopes = std::move(enclosing);
+}
+
+void Resolver::statement(StmtId statement) {
+	switch (stmt_type(statement)) {
+		case StmtType::Break:
+		case StmtType::Continue:
+			break;
+
+		case StmtType::Block: {
+			Stmt_Block* stmt = ast_get<Stmt_Block>(ast, statement);
+			scopes.emplace_back();
+			statements(stmt->statements);
+			stmt->slot_count = scopes.back().slot_count;
+			scopes.pop_back();
+		} break;
+
+		case StmtType::Class: {
+			// The attributes are fields, only the methods have locals.
+			Stmt_Class* stmt = ast_get<Stmt_Class>(ast, statement);
+			for (StmtId method : stmt->methods) {
+				function(ast_get<Stmt_Function>(ast, method));
+			}
+		} break;
+
+		case StmtType::Expression: {
+			expression(ast_get<Stmt_Expression>(ast, statement)->expression);
+		} break;
+
+		case StmtType::Function: {
+			function(ast_get<Stmt_Function>(ast, statement));
+		} break;
+
+		case StmtType::If: {
+			Stmt_If* stmt = ast_get<Stmt_If>(ast, statement);
+			expression(stmt->condition);
+			this->statement(stmt->then_branch);
+			for (const Else_If& else_if : stmt->else_ifs) {
+				expression(else_if.condition);
+				this->statement(else_if.then_branch);
+			}
+			if (stmt->else_branch != STMT_NONE) {
+				this->statement(stmt->else_branch);
+			}
+		} break;
+
+		case StmtType::Print: {
+			expression(ast_get<Stmt_Print>(ast, statement)->expression);
+		} break;
+
+		case StmtType::Return: {
+			expression(ast_get<Stmt_Return>(ast, statement)->value);
+		} break;
+
+		case StmtType::Var: {
+			// The initializer runs before the name is defined, so it still sees the outer one.
+			Stmt_Var* stmt = ast_get<Stmt_Var>(ast, statement);
+			for (size_t i = 0; i < stmt->names.size(); i++) {
+				expression(stmt->initializers.at(i));
+				stmt->names.at(i).slot = declare(stmt->names.at(i).symbol, token_type_to_java_type(stmt->type));
+			}
+		} break;
+
+		case StmtType::While: {
+			Stmt_While* stmt = ast_get<Stmt_While>(ast, statement);
+			expression(stmt->condition);
+			this->statement(stmt->body);
+		} break;
+	}
+}
+
+// Resolves the locals of the expression and returns its type when it's known statically.
+JavaType Resolver::expression(ExprId expression) {
+	if (expression == EXPR_NONE) return JavaType::none;
+
+	switch (expr_type(expression)) {
+		case ExprType::assign: {
+			// The value of an assignment is the right hand side before it's cast.
+			Expr_Assign* expr = ast_get<Expr_Assign>(ast, expression);
+			JavaType type = this->expression(expr->rhs);
+			expr->local = lookup(expr->lhs_name);
+			return type;
+		} break;
+
+		case ExprType::binary: {
+			Expr_Binary* expr = ast_get<Expr_Binary>(ast, expression);
+			JavaType left = this->expression(expr->left);
+			JavaType right = this->expression(expr->right);
+			JavaType result = JavaType::none;
+			expr->kernel = pick_binary_kernel(expr->_operator, left, right, &result);
+			if (expr->kernel != BINARY_KERNEL_NONE) {
+				expr->left_type = left;
+				expr->right_type = right;
+			}
+			return result;
+		} break;
+
+		case ExprType::call: {
+			Expr_Call* expr = ast_get<Expr_Call>(ast, expression);
+			this->expression(expr->callee);
+			for (const ParseCallInfo& argument : expr->arguments) {
+				this->expression(argument.expr);
+			}
+		} break;
+
+		case ExprType::cast: {
+			Expr_Cast* expr = ast_get<Expr_Cast>(ast, expression);
+			this->expression(expr->right);
+			return static_type(expr->type);
+		} break;
+
+		case ExprType::get: {
+			this->expression(ast_get<Expr_Get>(ast, expression)->object);
+		} break;
+
+		case ExprType::grouping: {
+			return this->expression(ast_get<Expr_Grouping>(ast, expression)->expression);
+		} break;
+
+		case ExprType::increment: {
+			Expr_Increment* expr = ast_get<Expr_Increment>(ast, expression);
+			expr->local = lookup(expr->name);
+			return local_type(expr->local);
+		} break;
+
+		case ExprType::literal: {
+			return static_type(ast_get<Expr_Literal>(ast, expression)->literal.type);
+		} break;
+
+		case ExprType::self:
+			break;
+
+		case ExprType::logical: {
+			// Both sides are checked to be booleans at runtime.
+			Expr_Logical* expr = ast_get<Expr_Logical>(ast, expression);
+			this->expression(expr->left);
+			this->expression(expr->right);
+			return JavaType::_boolean;
+		} break;
+
+		case ExprType::set: {
+			Expr_Set* expr = ast_get<Expr_Set>(ast, expression);
+			this->expression(expr->lhs);
+			this->expression(expr->value);
+		} break;
+
+		case ExprType::ternary: {
+			Expr_Ternary* expr = ast_get<Expr_Ternary>(ast, expression);
+			this->expression(expr->condition);
+			JavaType then = this->expression(expr->then);
+			JavaType otherwise = this->expression(expr->otherwise);
+			if (then == otherwise) return then;
+		} break;
+
+		case ExprType::unary: {
+			Expr_Unary* expr = ast_get<Expr_Unary>(ast, expression);
+			JavaType type = this->expression(expr->right);
+			bool is_valid = false;
+			switch (expr->_operator) {
+				case TokenType::minus: is_valid = is_java_type_number(type) && type != JavaType::_char; break;
+				case TokenType::bitwise_not: is_valid = type == JavaType::_byte || type == JavaType::_int || type == JavaType::_long; break;
+				case TokenType::_not: is_valid = type == JavaType::_boolean; break;
+				default: break;
+			}
+			if (is_valid) return type;
+		} break;
+
+		case ExprType::variable: {
+			Expr_Variable* expr = ast_get<Expr_Variable>(ast, expression);
+			expr->local = lookup(expr->name);
+			return local_type(expr->local);
+		} break;
+	}
+	return JavaType::none;
+}
+
+void resolve_statements(Ast* ast, StmtList statements) {
+	Resolver resolver = { ast, {} };
+	resolver.statements(statements);
+}
+
+void resolve_statement(Ast* ast, StmtId statement) {
+	Resolver resolver = { ast, {} };
+	resolver.statement(statement);
+}
+
+void resolve_function(Ast* ast, Stmt_Function* function) {
+	Resolver resolver = { ast, {} };
+	resolver.function(function);
+}
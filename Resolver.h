@@ -0,0 +1,27 @@
+#pragma once
+
+// Binds the local variables of a program before it runs. Every block and function body gets a
+// fixed number of slots, every declaration of a local gets one of them, and every read, assignment
+// and increment of a local gets the (depth, slot) of its declaration. The interpreter then reaches
+// a local by following `enclosing` depth times and indexing the slots, without hashing its name.
+//
+// Scopes line up one to one with the environments the interpreter creates: one per execution of
+// a Stmt_Block and one per call of a function, holding its parameters and the top level of its
+// body. Functions only close over the globals, so names are never bound across a function.
+//
+// Globals, fields, classes and `this` stay in the maps of the environments and are looked up by
+// name, and so is everything in a body that wasn't resolved, like the top level of the REPL.
+//
+// On the way it infers the types of expressions from literals, casts and the declared types of
+// locals, and gives every Expr_Binary whose operand types it knows a typed kernel (see Expr.h).
+
+#include "Ast.h"
+
+void resolve_statements(Ast* ast, StmtList statements);
+void resolve_statement(Ast* ast, StmtId statement);
+// Bodies skipped by the parser are resolved once they are parsed.
+void resolve_function(Ast* ast, Stmt_Function* function);
+// Picks the kernel the interpreter would end up running for these operand types, and gives the
+// type of its result. When the generic path would report an error, there's no kernel and the
+// error is still reported at runtime.
+BinaryKernel pick_binary_kernel(TokenType _operator, JavaType left, JavaType right, JavaType* result);
@@ -0,0 +1,109 @@
+
+#if defined(_WIN32) || defined(_WIN64)
+	#include <windows.h>
+	#ifdef _DEBUG
+		#include <stdlib.h>
+		#include <crtdbg.h>
+	#endif
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "SourceFile.h"
+
+// Fallback for small files, or when the file can't be mapped.
+static bool source_file_read(SourceFile* file, const char* name) {
+	FILE* handle = fopen(name, "rb");
+	if (handle == NULL) return false;
+
+	fseek(handle, 0, SEEK_END);
+	uint64_t len = ftell(handle);
+	fseek(handle, 0, SEEK_SET);
+
+	char* buffer = (char*)malloc((len + 1) * sizeof(char));
+	assert(buffer != NULL);
+	size_t read = fread(buffer, sizeof(char), len, handle);
+	buffer[read] = '\0';
+	fclose(handle);
+
+	file->bytes = buffer;
+	file->len = read;
+	file->is_mapped = false;
+	return true;
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+bool source_file_open(SourceFile* file, const char* name) {
+	HANDLE handle = CreateFileA(name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (handle == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER size = {};
+	if (GetFileSizeEx(handle, &size) && size.QuadPart >= SOURCE_FILE_MMAP_THRESHOLD) {
+		HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping != NULL) {
+			// The view keeps the mapping alive, so both handles can be closed right away.
+			void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping);
+			if (view != NULL) {
+				CloseHandle(handle);
+				file->bytes = (const char*)view;
+				file->len = (uint64_t)size.QuadPart;
+				file->is_mapped = true;
+				return true;
+			}
+		}
+	}
+	CloseHandle(handle);
+	return source_file_read(file, name);
+}
+
+void source_file_close(SourceFile* file) {
+	if (file->is_mapped) {
+		UnmapViewOfFile(file->bytes);
+	}
+	else {
+		free((void*)file->bytes);
+	}
+	file->bytes = NULL;
+	file->len = 0;
+}
+#else
+bool source_file_open(SourceFile* file, const char* name) {
+	int fd = open(name, O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat info = {};
+	if (fstat(fd, &info) == 0 && info.st_size >= SOURCE_FILE_MMAP_THRESHOLD) {
+		void* view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (view != MAP_FAILED) {
+			// The lexer reads the file once from start to end.
+			madvise(view, (size_t)info.st_size, MADV_SEQUENTIAL);
+			close(fd);
+			file->bytes = (const char*)view;
+			file->len = (uint64_t)info.st_size;
+			file->is_mapped = true;
+			return true;
+		}
+	}
+	close(fd);
+	return source_file_read(file, name);
+}
+
+void source_file_close(SourceFile* file) {
+	if (file->is_mapped) {
+		munmap((void*)file->bytes, (size_t)file->len);
+	}
+	else {
+		free((void*)file->bytes);
+	}
+	file->bytes = NULL;
+	file->len = 0;
+}
+#endif
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+
+// Files at least this big are memory mapped, smaller ones are read into a heap buffer.
+#define SOURCE_FILE_MMAP_THRESHOLD (64 * 1024)
+
+struct SourceFile {
+	const char* bytes;
+	uint64_t len;
+	bool is_mapped;
+};
+
+bool source_file_open(SourceFile* file, const char* name);
+void source_file_close(SourceFile* file);
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdint.h>
+
+// Where a node came from in the source. Nodes only keep the id of their span, the spans
+// themselves live in their own pool of the Ast (see Ast.h) and are only looked up when an
+// error has to be reported, so the interpreter never touches them on the way.
+//
+// The text of the error comes from the node: the symbol of a name, or the fixed lexeme of
+// an operator or keyword, see get_token_type_lexeme.
+typedef uint32_t SpanId;
+
+#define SPAN_NONE UINT32_MAX
+
+struct SourceSpan {
+	uint32_t line, column;
+};
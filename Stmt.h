@@ -1,10 +1,11 @@
 #pragma once
 
-#include <string>
+#include <string_view>
+#include "Arena.h"
 #include "Expr.h"
 #include "Visibility.h"
 
-enum class StmtType {
+enum class StmtType : uint8_t {
 	Break,
 	Block,
 	Class,
@@ -18,153 +19,185 @@ enum class StmtType {
 	While,
 };
 
+#define STMT_TYPE_COUNT ((size_t)StmtType::While + 1)
 
-struct Stmt { inline virtual StmtType get_type() = 0; };
+// Statements use the same id scheme as expressions, see Expr.h.
+typedef uint32_t StmtId;
 
-void stmt_free(Stmt* statement);
+#define STMT_NONE UINT32_MAX
 
-struct Stmt_Break : public Stmt {
-	inline StmtType get_type() override { return StmtType::Break; }
+inline StmtType stmt_type(StmtId id) {
+	return (StmtType)(id >> AST_KIND_SHIFT);
+}
+
+typedef ArenaArray<StmtId> StmtList;
+
+struct Stmt_Break {
+	static constexpr StmtType kind = StmtType::Break;
 };
 
-struct Stmt_Block : public Stmt {
-	std::vector<Stmt*> statements;
+struct Stmt_Block {
+	static constexpr StmtType kind = StmtType::Block;
 
-	Stmt_Block(std::vector<Stmt*> p_statements):
-		statements(p_statements) {}
+	StmtList statements;
+	uint16_t slot_count = 0; // Locals declared right in the block, set by the resolver.
 
-	inline StmtType get_type() override { return StmtType::Block; }
+	Stmt_Block(StmtList p_statements):
+		statements(p_statements) {}
 };
 
-struct Stmt_Continue : public Stmt {
-	inline StmtType get_type() override { return StmtType::Continue; }
+struct Stmt_Continue {
+	static constexpr StmtType kind = StmtType::Continue;
 };
 
-struct Stmt_Expression : public Stmt {
-	const Expr* expression;
+struct Stmt_Expression {
+	static constexpr StmtType kind = StmtType::Expression;
 
-	Stmt_Expression(const Expr* p_expression):
-		expression(p_expression) {}
+	ExprId expression;
 
-	inline StmtType get_type() override { return StmtType::Expression; }
+	Stmt_Expression(ExprId p_expression):
+		expression(p_expression) {}
 };
 
 struct JavaTypeInfo {
 	JavaType type;
-	std::string name;
+	std::string_view name;
 };
 
-struct Stmt_Function : public Stmt {
+typedef std::pair<JavaTypeInfo, Symbol> Parameter;
+
+struct Stmt_Function {
+	static constexpr StmtType kind = StmtType::Function;
+
 	const JavaType return_type;
-	const Token name;
+	const Symbol name;
+	const SpanId span;
 	const Visibility visibility;
 	const bool is_static;
 	const bool is_method;
-	const std::vector<std::pair<JavaTypeInfo, std::string>>* params;
-	const std::vector<Stmt*>* body;
+	const ArenaArray<Parameter> params;
+	StmtList body;
+	uint16_t slot_count = 0; // Parameters and locals declared right in the body, set by the resolver.
+	// Bodies skipped by the parser are only parsed the first time the function is called,
+	// from this piece of the source that starts right after the '{'.
+	std::string_view body_source = {};
+	uint32_t body_line = 0, body_column = 0;
+	bool is_body_parsed = true;
+	bool is_inlinable = true; // Cleared by the @NoInline annotation, see Optimizer.h.
 
 	Stmt_Function(const JavaType p_return_type,
-				  const Token p_name,
+				  const Symbol p_name,
+				  const SpanId p_span,
 				  const Visibility p_visibility,
 				  const bool p_is_static,
 				  const bool p_is_method,
-				  const std::vector<std::pair<JavaTypeInfo, std::string>>* p_params,
-				  const std::vector<Stmt*>* p_body):
+				  const ArenaArray<Parameter> p_params,
+				  const StmtList p_body):
 		return_type(p_return_type),
 		name(p_name),
+		span(p_span),
 		visibility(p_visibility),
 		is_static(p_is_static),
 		is_method(p_is_method),
 		params(p_params),
 		body(p_body)
 	{}
-
-	inline StmtType get_type() override { return StmtType::Function; }
 };
 
-struct Stmt_Print : public Stmt {
-	const Token token;
-	const Expr* expression;
-	const bool has_newline;
+struct Stmt_Print {
+	static constexpr StmtType kind = StmtType::Print;
 
-	Stmt_Print(const Token p_token, const Expr* p_expression, const bool p_has_newline):
-		token(p_token), expression(p_expression), has_newline(p_has_newline) {}
+	const SpanId span;
+	ExprId expression;
+	const bool has_newline;
 
-	inline StmtType get_type() override { return StmtType::Print; }
+	Stmt_Print(const SpanId p_span, ExprId p_expression, const bool p_has_newline):
+		span(p_span), expression(p_expression), has_newline(p_has_newline) {}
 };
 
-struct Stmt_Return : public Stmt {
-	const std::string keyword;
-	uint32_t line, column;
-	const Expr* value;
+struct Stmt_Return {
+	static constexpr StmtType kind = StmtType::Return;
 
-	Stmt_Return(const std::string p_keyword, uint32_t p_line, uint32_t p_column, const Expr* p_value):
-		keyword(p_keyword), line(p_line), column(p_column), value(p_value) {}
+	const SpanId span;
+	ExprId value;
 
-	inline StmtType get_type() override { return StmtType::Return; }
+	Stmt_Return(const SpanId p_span, ExprId p_value):
+		span(p_span), value(p_value) {}
 };
 
-struct Stmt_Var : public Stmt {
-	const Token type;
-	const std::vector<Token> names;
-	const std::vector<Expr*> initializers;
+struct VarName {
+	Symbol symbol;
+	SpanId span;
+	uint16_t slot = LOCAL_SLOT_NONE; // Globals and fields are defined by name.
+};
+
+struct Stmt_Var {
+	static constexpr StmtType kind = StmtType::Var;
+
+	const TokenType type;
+	const Symbol type_name; // Only user defined types have one.
+	const SpanId type_span;
+	const ArenaArray<VarName> names;
+	const ArenaArray<ExprId> initializers;
 	const Visibility visibility;
 	const bool is_static;
 	const bool is_final;
 
-	Stmt_Var(const Token p_type, const std::vector<Token> p_names, const std::vector<Expr*> p_initializers, const Visibility p_visibility, const bool p_is_static, const bool p_is_final):
+	Stmt_Var(const TokenType p_type, const Symbol p_type_name, const SpanId p_type_span, const ArenaArray<VarName> p_names, const ArenaArray<ExprId> p_initializers, const Visibility p_visibility, const bool p_is_static, const bool p_is_final):
 		type(p_type),
+		type_name(p_type_name),
+		type_span(p_type_span),
 		names(p_names),
 		initializers(p_initializers),
 		visibility(p_visibility),
 		is_static(p_is_static),
 		is_final(p_is_final)
 	{}
-
-	inline StmtType get_type() override { return StmtType::Var; }
 };
 
-struct Stmt_Class : public Stmt {
-	const Token name;
-	const bool is_abstract;
-	std::vector<Stmt_Var*> attributes = {};
-	std::vector<Stmt_Function*> methods = {};
+struct Stmt_Class {
+	static constexpr StmtType kind = StmtType::Class;
 
-	Stmt_Class(const Token p_name, const bool p_is_abstract): name(p_name), is_abstract(p_is_abstract) {}
+	const Symbol name;
+	const SpanId span;
+	const bool is_abstract;
+	ArenaArray<StmtId> attributes = {};
+	ArenaArray<StmtId> methods = {};
 
-	inline StmtType get_type() override { return StmtType::Class; }
+	Stmt_Class(const Symbol p_name, const SpanId p_span, const bool p_is_abstract): name(p_name), span(p_span), is_abstract(p_is_abstract) {}
 };
 
 
 struct Else_If {
-	const Token token;
-	const Expr* condition;
-	const Stmt* then_branch;
+	const SpanId span;
+	ExprId condition;
+	StmtId then_branch;
 };
 
-struct Stmt_If : public Stmt {
-	const Token token;
-	const Expr* condition;
-	const Stmt* then_branch;
-	const std::vector<Else_If> else_ifs;
-	const Stmt* else_branch;
+struct Stmt_If {
+	static constexpr StmtType kind = StmtType::If;
 
-	Stmt_If(const Token p_token, const Expr* p_condition, const Stmt* p_then_branch, const std::vector<Else_If> p_else_ifs, const Stmt* p_else_branch) :
-		token(p_token), condition(p_condition), then_branch(p_then_branch), else_ifs(p_else_ifs), else_branch(p_else_branch)
-	{}
+	const SpanId span;
+	ExprId condition;
+	StmtId then_branch;
+	const ArenaArray<Else_If> else_ifs;
+	StmtId else_branch;
 
-	inline StmtType get_type() override { return StmtType::If; }
+	Stmt_If(const SpanId p_span, ExprId p_condition, StmtId p_then_branch, const ArenaArray<Else_If> p_else_ifs, StmtId p_else_branch) :
+		span(p_span), condition(p_condition), then_branch(p_then_branch), else_ifs(p_else_ifs), else_branch(p_else_branch)
+	{}
 };
 
-struct Stmt_While : public Stmt {
-	const Token token;
-	const Expr* condition;
-	const Stmt* body;
+struct Stmt_While {
+	static constexpr StmtType kind = StmtType::While;
+
+	const SpanId span;
+	ExprId condition;
+	StmtId body;
+	const TokenType keyword; // A for loop is also parsed into a while.
 	const bool has_increment;
 
-	Stmt_While(const Token p_token, const Expr* p_condition, const Stmt* p_body, const bool p_has_increment):
-		token(p_token), condition(p_condition), body(p_body), has_increment(p_has_increment)
+	Stmt_While(const SpanId p_span, ExprId p_condition, StmtId p_body, const TokenType p_keyword, const bool p_has_increment):
+		span(p_span), condition(p_condition), body(p_body), keyword(p_keyword), has_increment(p_has_increment)
 	{}
-
-	inline StmtType get_type() override { return StmtType::While; }
 };
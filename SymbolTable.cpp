@@ -0,0 +1,39 @@
+#include "SymbolTable.h"
+
+#include <assert.h>
+
+#if defined(_DEBUG) && (defined(_WIN32) || defined(_WIN64))
+	#include <stdlib.h>
+	#include <crtdbg.h>
+#endif
+
+SymbolTable symbol_table;
+
+SymbolTable::SymbolTable() {
+	Symbol this_symbol = intern("this");
+	Symbol init_symbol = intern("__init__");
+	assert(this_symbol == SYMBOL_THIS && init_symbol == SYMBOL_INIT);
+	(void)this_symbol;
+	(void)init_symbol;
+}
+
+Symbol SymbolTable::intern(std::string_view name) {
+	auto found = ids.find(name);
+	if (found != ids.end()) return found->second;
+
+	assert(names.size() < SYMBOL_NONE);
+	Symbol symbol = (Symbol)names.size();
+	const std::string& stored = names.emplace_back(name);
+	ids.emplace(std::string_view(stored), symbol);
+	return symbol;
+}
+
+Symbol SymbolTable::find(std::string_view name) const {
+	auto found = ids.find(name);
+	return found != ids.end() ? found->second : SYMBOL_NONE;
+}
+
+const std::string& SymbolTable::name(Symbol symbol) const {
+	assert(symbol < names.size());
+	return names[symbol];
+}
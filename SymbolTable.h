@@ -0,0 +1,35 @@
+#pragma once
+
+// Interned names. The Lexer interns every identifier as it's scanned, so the parser,
+// the environments and the class fields hash and compare 32-bit ids instead of strings.
+// The table lives for the whole program and is global, natives can use it to look up
+// names by id, or ids by name.
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+typedef uint32_t Symbol;
+
+#define SYMBOL_NONE UINT32_MAX
+
+// Names that the interpreter looks up by itself, they are interned first so their ids are fixed.
+#define SYMBOL_THIS 0
+#define SYMBOL_INIT 1
+
+struct SymbolTable {
+	SymbolTable();
+
+	Symbol intern(std::string_view name);
+	Symbol find(std::string_view name) const; // Returns SYMBOL_NONE if the name was never interned.
+	const std::string& name(Symbol symbol) const;
+	size_t size() const { return names.size(); }
+
+private:
+	std::deque<std::string> names; // A deque never moves its elements, so the views used as keys stay valid.
+	std::unordered_map<std::string_view, Symbol> ids;
+};
+
+extern SymbolTable symbol_table;
@@ -1,4 +1,5 @@
 #include "Token.h"
+#include "Keywords.h"
 
 #include <unordered_map>
 #include <assert.h>
@@ -83,47 +84,84 @@ const char* get_token_type_name(TokenType type) {
 		case TokenType::comma: return "COMMA";
 		case TokenType::dot: return "DOT";
 		case TokenType::semicolon: return "SEMICOLON";
+		case TokenType::at: return "AT";
 		case TokenType::eof: return "EOF";
 		default: assert(false && "Not implemented");
 	}
 	return nullptr;
 }
 
+const char* get_token_type_lexeme(TokenType type) {
+	switch (type) {
+		case TokenType::paren_left: return "(";
+		case TokenType::paren_right: return ")";
+		case TokenType::curly_left: return "{";
+		case TokenType::curly_right: return "}";
+		case TokenType::square_left: return "[";
+		case TokenType::square_right: return "]";
+		case TokenType::plus: return "+";
+		case TokenType::minus: return "-";
+		case TokenType::slash: return "/";
+		case TokenType::star: return "*";
+		case TokenType::equal: return "=";
+		case TokenType::plus_plus: return "++";
+		case TokenType::minus_minus: return "--";
+		case TokenType::percent_sign: return "%";
+		case TokenType::greater: return ">";
+		case TokenType::less: return "<";
+		case TokenType::greater_equal: return ">=";
+		case TokenType::less_equal: return "<=";
+		case TokenType::equal_equal: return "==";
+		case TokenType::not_equal: return "!=";
+		case TokenType::colon: return ":";
+		case TokenType::question: return "?";
+		case TokenType::bitwise_not: return "~";
+		case TokenType::bitwise_and: return "&";
+		case TokenType::bitwise_xor: return "^";
+		case TokenType::bitwise_or: return "|";
+		case TokenType::left_shift: return "<<";
+		case TokenType::right_shift: return ">>";
+		case TokenType::_or: return "||";
+		case TokenType::_and: return "&&";
+		case TokenType::_not: return "!";
+		case TokenType::comma: return ",";
+		case TokenType::dot: return ".";
+		case TokenType::semicolon: return ";";
+		case TokenType::at: return "@";
+		default: break;
+	}
+	for (const Keyword& keyword : keywords) {
+		if (keyword.type == type) return keyword.name.data();
+	}
+	return get_token_type_name(type);
+}
+
 Token make__init__token(Token peeked) {
 	Token result = Token();
 	result.type = TokenType::identifier;
-	result.lexeme = (char*)"__init__";
+	result.lexeme = "__init__";
 	result.line = peeked.line;
 	result.column = peeked.column;
-	result.is__init__ = true;
+	result.symbol = SYMBOL_INIT;
 	return result;
 }
 
 Token::Token() :
 	type((TokenType)0),
-	lexeme(NULL),
+	lexeme(),
 	line(1),
 	column(1)
 {
 	literal = {};
 }
 
-Token::Token(TokenType _type, char *_lexeme, size_t lexeme_len, uint32_t _line, uint32_t _column, JavaObject _literal):
+Token::Token(TokenType _type, std::string_view _lexeme, uint32_t _line, uint32_t _column, JavaObject _literal):
 	type(_type),
-	lexeme(NULL),
+	lexeme(_lexeme),
 	line(_line),
 	column(_column),
 	literal(_literal)
 {
-	if (lexeme_len == 0) { return; }
-	lexeme = (char*)malloc((lexeme_len + 1) * sizeof(char));
-	assert(lexeme != NULL);
-	memset(lexeme, 0, lexeme_len + 1);
-	strncpy(lexeme, _lexeme, lexeme_len);
-
-	if (type == TokenType::string) {
-		literal.value.String = lexeme;
-	}
 }
 
 void Token::assign(Token *a, const Token& other) {
@@ -131,5 +169,6 @@ void Token::assign(Token *a, const Token& other) {
 	a->line = other.line;
 	a->column = other.column;
 	a->literal = other.literal;
+	a->symbol = other.symbol;
 }
 
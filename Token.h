@@ -1,21 +1,24 @@
 #pragma once
 
 #include <stdint.h>
+#include <string_view>
 #include "JavaObject.h"
 #include "TokenType.h"
+#include "SymbolTable.h"
 
 struct Token {
 	TokenType type;
-	char *lexeme;
+	std::string_view lexeme; // View into the source buffer, it's not null terminated.
 	uint32_t line, column;
 	JavaObject literal;
-
-	bool is__init__ = false;
+	Symbol symbol = SYMBOL_NONE; // Only identifiers, this and __init__ have one.
 
 	Token();
-	Token(TokenType _type, char* _lexeme, size_t lexeme_len, uint32_t _line, uint32_t _column, JavaObject _literal);
+	Token(TokenType _type, std::string_view _lexeme, uint32_t _line, uint32_t _column, JavaObject _literal);
 	static void assign(Token* a, const Token& other);
 };
 
 const char* get_token_type_name(TokenType type);
+// Text of the tokens that are always spelled the same, like operators and keywords.
+const char* get_token_type_lexeme(TokenType type);
 Token make__init__token(Token peeked);
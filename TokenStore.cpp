@@ -0,0 +1,52 @@
+#include "TokenStore.h"
+
+#include <algorithm>
+#include <assert.h>
+
+#if defined(_DEBUG) && (defined(_WIN32) || defined(_WIN64))
+	#include <stdlib.h>
+	#include <crtdbg.h>
+#endif
+
+void TokenStore::push(const Token& token) {
+	assert(source != nullptr && token.lexeme.data() >= source);
+	uint64_t offset = token.lexeme.data() - source;
+	assert(offset <= UINT32_MAX && token.lexeme.size() <= UINT32_MAX);
+
+	uint32_t line = token.line < TOKEN_MAX_LINE ? token.line : TOKEN_MAX_LINE;
+	uint32_t column = token.column < TOKEN_MAX_COLUMN ? token.column : TOKEN_MAX_COLUMN;
+
+	if (token.literal.type != JavaType::none) {
+		literal_owners.push_back((uint32_t)types.size());
+		literals.push_back(token.literal);
+	}
+	types.push_back(token.type);
+	offsets.push_back((uint32_t)offset);
+	lengths.push_back((uint32_t)token.lexeme.size());
+	positions.push_back(line << TOKEN_COLUMN_BITS | column);
+}
+
+void TokenStore::clear() {
+	types.clear();
+	offsets.clear();
+	lengths.clear();
+	positions.clear();
+	literal_owners.clear();
+	literals.clear();
+}
+
+JavaObject TokenStore::literal(uint32_t index) const {
+	auto it = std::lower_bound(literal_owners.begin(), literal_owners.end(), index);
+	if (it == literal_owners.end() || *it != index) {
+		return JavaObject{ JavaType::none, JavaValue{0} };
+	}
+	return literals[it - literal_owners.begin()];
+}
+
+Token TokenStore::get(uint32_t index) const {
+	Token token{ type(index), lexeme(index), line(index), column(index), literal(index) };
+	if (token.type == TokenType::identifier || token.type == TokenType::_this || token.type == TokenType::constructor) {
+		token.symbol = symbol_table.find(token.lexeme);
+	}
+	return token;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <string_view>
+
+#include "Token.h"
+
+// Line and column share 32 bits, both saturate when they don't fit.
+#define TOKEN_COLUMN_BITS 10
+#define TOKEN_LINE_BITS (32 - TOKEN_COLUMN_BITS)
+#define TOKEN_MAX_COLUMN ((1u << TOKEN_COLUMN_BITS) - 1)
+#define TOKEN_MAX_LINE ((1u << TOKEN_LINE_BITS) - 1)
+
+// Compact storage for a whole token stream, kept as parallel arrays.
+// A token takes 13 bytes instead of sizeof(Token), and literal values are
+// only stored for the tokens that have one.
+struct TokenStore {
+	const char* source = nullptr;
+	std::vector<TokenType> types;
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> lengths;
+	std::vector<uint32_t> positions;
+	std::vector<uint32_t> literal_owners; // Index of the token of each literal, always ascending.
+	std::vector<JavaObject> literals;
+
+	void push(const Token& token);
+	void clear();
+	size_t size() const { return types.size(); }
+
+	TokenType type(uint32_t index) const { return types[index]; }
+	std::string_view lexeme(uint32_t index) const { return std::string_view(source + offsets[index], lengths[index]); }
+	uint32_t line(uint32_t index) const { return positions[index] >> TOKEN_COLUMN_BITS; }
+	uint32_t column(uint32_t index) const { return positions[index] & TOKEN_MAX_COLUMN; }
+	JavaObject literal(uint32_t index) const;
+	Token get(uint32_t index) const;
+};
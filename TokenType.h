@@ -99,6 +99,7 @@ enum class TokenType : uint8_t {
 	comma,     // ,
 	dot,       // .
 	semicolon, // ;
+	at,        // @
 	eof,       // EOF
 
 	count,
@@ -14,6 +14,7 @@ Visibility visibility_from_token_type(TokenType type) {
 		case TokenType::_private: return Visibility::Private;
 		case TokenType::_protected: return Visibility::Protected;
 		case TokenType::_public: return Visibility::Public;
+		default: break;
 	}
 	return Visibility::None;
 }
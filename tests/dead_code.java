@@ -0,0 +1,42 @@
+// Code after a return or a break never runs, and branches on constants keep only the taken arm.
+int first_even(int n) {
+    for (int i = 1; i <= n; i++) {
+        if (i % 2 == 0) {
+            return i;
+            soutln("after return");
+        }
+    }
+    return -1;
+    soutln("after the last return");
+}
+
+int count_until(int stop) {
+    int count = 0;
+    while (true) {
+        if (count == stop) {
+            break;
+            soutln("after break");
+        }
+        count++;
+    }
+    return count;
+}
+
+void branches() {
+    final boolean debug = false;
+    if (debug) {
+        soutln("debug");
+    } else if (1 > 2) {
+        soutln("never");
+    } else {
+        soutln("taken");
+    }
+    while (false) {
+        soutln("never loops");
+    }
+}
+
+soutln(first_even(5));
+soutln(first_even(1));
+soutln(count_until(4));
+branches();
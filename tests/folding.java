@@ -0,0 +1,28 @@
+// Constant folding and final locals. The folds that would fail only fail when they run.
+void fold(int n) {
+    final int k = 3;
+    final double d = 2;
+    final long big = 1 << 20;
+    final boolean flag = 1 < 2;
+    final byte b = 200;
+    soutln(k * d + sqrt(16) + pow(2, 3) + (int)3.7 + (flag ? 1 : 0));
+    soutln(big + k);
+    soutln(-k);
+    soutln(d / k);
+    soutln(!flag);
+    soutln(b + 1);
+    soutln((char)65 > (char)64);
+    if (n > 0) {
+        soutln(k / 0);
+        soutln(sqrt(true));
+    }
+}
+
+fold(0);
+soutln(1 + 2 * 3);
+soutln(10 / 4);
+soutln(10.0 / 4);
+soutln(7 % 3);
+soutln(true && false);
+soutln(1 < 2 ? 5 : 6);
+fold(1);
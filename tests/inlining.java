@@ -0,0 +1,41 @@
+// Small functions are inlined at their call sites. Prints the same with --inline-budget=0.
+int x = 100;
+
+int square(int x) {
+    return x * x;
+}
+
+int add(int a, int b) {
+    int x = a + b;
+    return x;
+}
+
+@NoInline
+int twice(int x) {
+    return x + x;
+}
+
+void shadow(int x) {
+    int y = square(x + 1);
+    soutln(y);
+    soutln(x);
+}
+
+abstract class Util {
+    static int clamp(int v, int lo, int hi) {
+        return v < lo ? lo : v > hi ? hi : v;
+    }
+}
+
+void run() {
+    soutln(square(7));
+    soutln(add(2, 3));
+    soutln(twice(21));
+    shadow(4);
+    soutln(x);
+    soutln(Util.clamp(15, 0, 10));
+    soutln(Util.clamp(-5, 0, 10));
+    soutln(square(add(1, 2)));
+}
+
+run();
@@ -0,0 +1,48 @@
+// Invariant expressions move out of loops. A loop that never runs doesn't fail on them, the
+// ones in the condition are hoisted even when they may fail, since the condition runs first.
+void zero_trip_native(int n, boolean b) {
+    int i = 0;
+    while (i < n) {
+        soutln(sqrt(b));
+        i++;
+    }
+    soutln("done");
+}
+
+void zero_trip_parameter(int n, int x) {
+    int i = 0;
+    while (i < n) {
+        soutln(x * x + 7);
+        i++;
+    }
+    soutln("done");
+}
+
+void hoisted(int n) {
+    int x = n + 1;
+    double sum = 0;
+    for (int i = 0; i < n; i++) {
+        sum = sum + sqrt(x * x + 7);
+    }
+    soutln(sum);
+}
+
+boolean is_prime(int n) {
+    boolean result = true;
+    for (int d = 2; d <= (int)sqrt(n); d++) {
+        if (n % d == 0) {
+            result = false;
+            break;
+        }
+    }
+    return result;
+}
+
+zero_trip_native(0, true);
+zero_trip_parameter(0, "str");
+zero_trip_parameter(2, 3);
+hoisted(3);
+hoisted(0);
+soutln(is_prime(2));
+soutln(is_prime(91));
+soutln(is_prime(97));
@@ -0,0 +1,21 @@
+// Static final constants are inlined at their uses, also when the class is declared after them.
+abstract class First {
+    static double area(double r) {
+        return Second.PI * r * r;
+    }
+
+    static int limit() {
+        return Second.LIMIT + First.OFFSET;
+    }
+
+    static final int OFFSET = 2;
+}
+
+abstract class Second {
+    static final double PI = 3.14159;
+    static final int LIMIT = 40;
+}
+
+soutln(First.area(2));
+soutln(First.limit());
+soutln(Second.LIMIT * 2);
@@ -0,0 +1,17 @@
+// A repeated expression is computed once, until a local it reads is assigned.
+void shared(int a, int b) {
+    int x = a;
+    int y = b;
+    soutln(x * y + 1);
+    soutln(x * y + 1);
+    x = x + 10;
+    soutln(x * y + 1);
+    y++;
+    soutln(x * y + 1);
+    double root = sqrt(x * x + y * y);
+    x = 0;
+    soutln(root);
+    soutln(sqrt(x * x + y * y));
+}
+
+shared(3, 4);